@@ -0,0 +1,601 @@
+/**
+ * \file bench.c
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Suíte de microbenchmarks dos kernels da pontu sobre nuvens geradas
+ */
+
+#include <time.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "../pontu_core.h"
+#include "../pontu_features.h"
+#include "../pontu_sampling.h"
+#include "../pontu_registration.h"
+
+#define BENCH_SHAPE		"sphere"
+#define BENCH_SIZES		"1000,10000,100000"
+#define BENCH_MAXSIZES	16
+#define BENCH_REPS		5
+#define BENCH_WARMUP	1
+#define BENCH_SEED		42
+#define BENCH_QUERIES	10000
+#define BENCH_K			10
+#define BENCH_RADIUS	0.05
+#define BENCH_LEAF		0.05
+#define BENCH_FPS		2048
+#define BENCH_POISSON	0.02
+#define BENCH_SIGMA		1.0
+#define BENCH_MINPTS	3
+#define BENCH_PLANES	3
+#define BENCH_PLANE_MINPTS	0.1
+#define BENCH_ICP_T		1e-9
+#define BENCH_ICP_K		20
+#define BENCH_ANGLE		0.05
+#define BENCH_SHIFT		0.02
+#define BENCH_PCT		0.9
+#define BENCH_MAXPATH	256
+
+typedef struct dataframe *(*moment_func)(struct cloud *);
+typedef struct dataframe *(*cut_func)(struct cloud *, moment_func);
+
+/**
+ * \brief Dados compartilhados pelos casos de um mesmo tamanho de nuvem
+ */
+struct bench_data {
+	struct cloud *cloud;
+	struct cloud *moved;
+	struct cloud *planes;
+	struct icp *icp;
+	real *queries;
+	uint numqueries;
+	uint *ids;
+	real *dist;
+	char xyzfile[BENCH_MAXPATH];
+	char plyfile[BENCH_MAXPATH];
+};
+
+struct bench_case;
+
+typedef void (*bench_func)(struct bench_data *, const struct bench_case *);
+
+/**
+ * \brief Caso da suíte: o nome, a função cronometrada e, para os momentos e
+ * cortes, o momento e o corte usados
+ */
+struct bench_case {
+	const char *name;
+	bench_func func;
+	moment_func moment;
+	cut_func cut;
+};
+
+/**
+ * \brief Lê o relógio monotônico
+ * \return Tempo em segundos
+ */
+static real bench_seconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench_load_xyz(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct cloud *cloud = cloud_load_xyz(data->xyzfile);
+	cloud_free(&cloud);
+}
+
+static void bench_load_ply(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct cloud *cloud = cloud_load_ply(data->plyfile);
+	cloud_free(&cloud);
+}
+
+static void bench_copy(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct cloud *cloud = cloud_copy(data->cloud);
+	cloud_free(&cloud);
+}
+
+static void bench_pack(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	cloud_invalidate(data->cloud);
+	cloud_pack(data->cloud);
+}
+
+static void bench_kdindex(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	cloud_pack(data->cloud);
+	kdindex_free(&data->cloud->index);
+	cloud_index(data->cloud);
+}
+
+static void bench_kdtree(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct kdtree *kdt = kdtree_new(data->cloud->points,
+	                                data->cloud->numpts,
+	                                0);
+	kdtree_partitionate(kdt);
+	kdtree_free(&kdt);
+}
+
+static void bench_octree(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	octree_free(&data->cloud->tree);
+	cloud_partitionate(data->cloud);
+}
+
+static void bench_nearest(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct kdindex *index = cloud_index(data->cloud);
+
+	for (uint i = 0; i < data->numqueries; i++)
+		kdindex_nearest(index, &data->queries[3 * i], NULL);
+}
+
+static void bench_knn(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct kdindex *index = cloud_index(data->cloud);
+
+	for (uint i = 0; i < data->numqueries; i++)
+		kdindex_knn(index,
+		            &data->queries[3 * i],
+		            BENCH_K,
+		            data->ids,
+		            data->dist);
+}
+
+static void bench_radius(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct kdindex *index = cloud_index(data->cloud);
+
+	for (uint i = 0; i < data->numqueries; i++)
+		kdindex_radius(index,
+		               &data->queries[3 * i],
+		               BENCH_RADIUS,
+		               data->ids,
+		               NULL,
+		               BENCH_K);
+}
+
+static void bench_voxelgrid(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct cloud *sub = voxelgrid_sampling(data->cloud, BENCH_LEAF);
+	cloud_free(&sub);
+}
+
+static void bench_fps(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct cloud *sub = fps_sampling(data->cloud, BENCH_FPS);
+	cloud_free(&sub);
+}
+
+static void bench_fps_approx(struct bench_data *data,
+                             const struct bench_case *c)
+{
+	(void)c;
+	struct cloud *sub = fps_sampling_approx(data->cloud, BENCH_FPS);
+	cloud_free(&sub);
+}
+
+static void bench_random(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct cloudview *view = subsample_random(data->cloud, BENCH_FPS, 1);
+	cloudview_free(&view);
+}
+
+static void bench_poisson(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct cloudview *view = subsample_poisson(data->cloud, BENCH_POISSON, 1);
+	cloudview_free(&view);
+}
+
+static void bench_sor(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct cloudview *view = outlier_statistical(data->cloud,
+	                                             BENCH_K,
+	                                             BENCH_SIGMA);
+	cloudview_free(&view);
+}
+
+static void bench_ror(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct cloudview *view = outlier_radius(data->cloud,
+	                                        BENCH_RADIUS,
+	                                        BENCH_MINPTS);
+	cloudview_free(&view);
+}
+
+static void bench_cluster(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	struct cluster *clusters = cluster_euclidean(data->cloud,
+	                                             BENCH_RADIUS,
+	                                             1,
+	                                             0);
+	cluster_free(&clusters);
+}
+
+static void bench_planeseg(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	uint minpts = (uint)(BENCH_PLANE_MINPTS * data->planes->numpts);
+	struct planeseg *seg = planeseg_extract(data->planes,
+	                                        BENCH_SHIFT,
+	                                        minpts > 3 ? minpts : 3,
+	                                        BENCH_PLANES,
+	                                        1);
+	planeseg_free(&seg);
+}
+
+static void bench_normals(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	cloud_estimate_normals(data->cloud, BENCH_K, 0.0);
+}
+
+static void bench_moment(struct bench_data *data, const struct bench_case *c)
+{
+	struct dataframe *df = NULL;
+
+	if (c->cut != NULL)
+		df = (*c->cut)(data->cloud, c->moment);
+	else
+		df = (*c->moment)(data->cloud);
+
+	dataframe_free(&df);
+}
+
+static void bench_icp(struct bench_data *data, const struct bench_case *c)
+{
+	(void)c;
+	data->icp->rt = rigid3_identity();
+	icp_run(data->icp, data->moved, data->cloud, BENCH_ICP_T, BENCH_ICP_K);
+}
+
+static const struct bench_case bench_cases[] = {
+	{"load_xyz", &bench_load_xyz, NULL, NULL},
+	{"load_ply", &bench_load_ply, NULL, NULL},
+	{"copy", &bench_copy, NULL, NULL},
+	{"pack", &bench_pack, NULL, NULL},
+	{"kdindex", &bench_kdindex, NULL, NULL},
+	{"kdtree", &bench_kdtree, NULL, NULL},
+	{"octree", &bench_octree, NULL, NULL},
+	{"nearest", &bench_nearest, NULL, NULL},
+	{"knn", &bench_knn, NULL, NULL},
+	{"radius", &bench_radius, NULL, NULL},
+	{"voxelgrid", &bench_voxelgrid, NULL, NULL},
+	{"fps", &bench_fps, NULL, NULL},
+	{"fps_approx", &bench_fps_approx, NULL, NULL},
+	{"random", &bench_random, NULL, NULL},
+	{"poisson", &bench_poisson, NULL, NULL},
+	{"sor", &bench_sor, NULL, NULL},
+	{"ror", &bench_ror, NULL, NULL},
+	{"cluster", &bench_cluster, NULL, NULL},
+	{"planeseg", &bench_planeseg, NULL, NULL},
+	{"normals", &bench_normals, NULL, NULL},
+	{"hututu", &bench_moment, &hu_cloud_moments_hututu, NULL},
+	{"hu1980", &bench_moment, &hu_cloud_moments_hu1980, NULL},
+	{"legendre", &bench_moment, &legendre_cloud_moments, NULL},
+	{"chebyshev", &bench_moment, &chebyshev_cloud_moments, NULL},
+	{"zernike", &bench_moment, &zernike_cloud_moments_full, NULL},
+	{"harmonics", &bench_moment, &harmonics_cloud_moments_full, NULL},
+	{"spheric", &bench_moment, &spheric_cloud_moments, NULL},
+	{"cut_s", &bench_moment, &hu_cloud_moments_hu1980, &extraction_sagittal},
+	{"cut_t", &bench_moment, &hu_cloud_moments_hu1980, &extraction_transversal},
+	{"cut_f", &bench_moment, &hu_cloud_moments_hu1980, &extraction_frontal},
+	{"cut_r", &bench_moment, &hu_cloud_moments_hu1980, &extraction_radial},
+	{"cut_u", &bench_moment, &hu_cloud_moments_hu1980, &extraction_upper},
+	{"cut_l", &bench_moment, &hu_cloud_moments_hu1980, &extraction_lower},
+	{"cut_7", &bench_moment, &hu_cloud_moments_hu1980, &extraction_7},
+	{"cut_6", &bench_moment, &hu_cloud_moments_hu1980, &extraction_6},
+	{"cut_4", &bench_moment, &hu_cloud_moments_hu1980, &extraction_4},
+	{"cut_m", &bench_moment, &hu_cloud_moments_hu1980, &extraction_manhattan},
+	{"cut_v", &bench_moment, &hu_cloud_moments_hu1980, &extraction_vshape},
+	{"cut_vf", &bench_moment, &hu_cloud_moments_hu1980, &extraction_vshape_f},
+	{"cut_vs", &bench_moment, &hu_cloud_moments_hu1980, &extraction_vshape_s},
+	{"cut_vt", &bench_moment, &hu_cloud_moments_hu1980, &extraction_vshape_t},
+	{"icp", &bench_icp, NULL, NULL},
+};
+
+/**
+ * \brief Prepara os dados de um tamanho: nuvem, cópia movida para o ICP,
+ * consultas e arquivos temporários para os loaders
+ * \param data Dados a preencher
+ * \param shape Forma da nuvem gerada (SYNTH_*)
+ * \param numpts Número de pontos
+ * \return 1 se deu certo, ou 0 se falhar
+ */
+static int bench_setup(struct bench_data *data, int shape, uint numpts)
+{
+	uint64_t state = BENCH_SEED + 1;
+	real w[3] = {BENCH_ANGLE, -BENCH_ANGLE, BENCH_ANGLE};
+	struct rigid3 rt = {mat3_rotation(w), {BENCH_SHIFT, 0.0, -BENCH_SHIFT}};
+
+	memset(data, 0, sizeof(struct bench_data));
+	snprintf(data->xyzfile, BENCH_MAXPATH, "/tmp/pontu_bench_%d.xyz", getpid());
+	snprintf(data->plyfile, BENCH_MAXPATH, "/tmp/pontu_bench_%d.ply", getpid());
+
+	data->cloud = synth_generate(shape, numpts, BENCH_SEED);
+	if (data->cloud == NULL)
+		return 0;
+
+	struct cloud *plane = synth_generate(SYNTH_PLANE, numpts / 2, BENCH_SEED);
+	struct cloud *cube = synth_generate(SYNTH_CUBE,
+	                                    numpts - numpts / 2,
+	                                    BENCH_SEED);
+
+	if (plane != NULL && cube != NULL)
+		data->planes = cloud_concat(plane, cube);
+
+	cloud_free(&plane);
+	cloud_free(&cube);
+
+	data->moved = cloud_copy(data->cloud);
+	data->icp = icp_new(numpts, ICP_PLANE);
+	data->numqueries = BENCH_QUERIES;
+	data->queries = malloc(3 * data->numqueries * sizeof(real));
+	data->ids = malloc(BENCH_K * sizeof(uint));
+	data->dist = malloc(BENCH_K * sizeof(real));
+
+	if (data->planes == NULL || data->moved == NULL || data->icp == NULL ||
+	    data->queries == NULL || data->ids == NULL || data->dist == NULL ||
+	    !cloud_transform_rigid(data->moved, &rt) ||
+	    !cloud_save_xyz(data->cloud, data->xyzfile) ||
+	    !cloud_save_ply(data->cloud, data->plyfile))
+		return 0;
+
+	for (uint i = 0; i < 3 * data->numqueries; i++)
+		data->queries[i] = 2.4 * calc_randu(&state) - 1.2;
+
+	return 1;
+}
+
+/**
+ * \brief Libera os dados de um tamanho e apaga seus arquivos temporários
+ * \param data Dados a liberar
+ */
+static void bench_teardown(struct bench_data *data)
+{
+	remove(data->xyzfile);
+	remove(data->plyfile);
+	cloud_free(&data->cloud);
+	cloud_free(&data->moved);
+	cloud_free(&data->planes);
+	icp_free(&data->icp);
+	free(data->queries);
+	free(data->ids);
+	free(data->dist);
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+	real x = *(const real *)a;
+	real y = *(const real *)b;
+
+	return (x > y) - (x < y);
+}
+
+/**
+ * \brief Executa um caso com aquecimento e repetições e reporta os tempos
+ * (mínimo, mediana, percentil BENCH_PCT, máximo e média, em segundos)
+ * \param data Dados do tamanho atual
+ * \param c Caso a executar
+ * \param numpts Número de pontos
+ * \param warmup Número de execuções descartadas
+ * \param reps Número de execuções medidas
+ * \param times Vetor auxiliar com espaço para reps tempos
+ * \param csv Arquivo da saída CSV (NULL para nenhum)
+ */
+static void bench_run(struct bench_data *data,
+                      const struct bench_case *c,
+                      uint numpts,
+                      uint warmup,
+                      uint reps,
+                      real *times,
+                      FILE *csv)
+{
+	for (uint i = 0; i < warmup; i++)
+		(*c->func)(data, c);
+
+	real sum = 0.0;
+	for (uint i = 0; i < reps; i++) {
+		real start = bench_seconds();
+		(*c->func)(data, c);
+		times[i] = bench_seconds() - start;
+		sum += times[i];
+	}
+
+	qsort(times, reps, sizeof(real), &bench_compare);
+
+	uint pct = (uint)ceil(BENCH_PCT * reps);
+	real median = (reps % 2) ? times[reps / 2] :
+	                           0.5 * (times[reps / 2 - 1] + times[reps / 2]);
+
+	printf("%-10s %9u %12.6f %12.6f %12.6f %12.6f %12.6f\n",
+	       c->name,
+	       numpts,
+	       times[0],
+	       median,
+	       times[pct > 0 ? pct - 1 : 0],
+	       times[reps - 1],
+	       sum / reps);
+	fflush(stdout);
+
+	if (csv != NULL)
+		fprintf(csv,
+		        "%s,%u,%u,%le,%le,%le,%le,%le\n",
+		        c->name,
+		        numpts,
+		        reps,
+		        times[0],
+		        median,
+		        times[pct > 0 ? pct - 1 : 0],
+		        times[reps - 1],
+		        sum / reps);
+}
+
+/**
+ * \brief Exibe mensagem ao usuário informando como usar a suíte
+ */
+void bench_help()
+{
+	printf("bench: microbenchmarks da libpontu\n");
+	printf(" -g: forma das nuvens geradas (padrao: %s)\n", BENCH_SHAPE);
+	printf("     > cube, sphere, clusters, plane, face ou duplicates\n");
+	printf(" -n: tamanhos das nuvens geradas, separados por virgula\n");
+	printf("     > padrao: %s (1000 a 10000000 pontos)\n", BENCH_SIZES);
+	printf(" -r: repeticoes medidas de cada caso (padrao: %d)\n", BENCH_REPS);
+	printf(" -w: execucoes de aquecimento (padrao: %d)\n", BENCH_WARMUP);
+	printf(" -f: roda so os casos cujo nome contem o filtro\n");
+	printf(" -o: arquivo CSV de saida (kernel,numpts,reps,min,median,p90,\n");
+	printf("     max,mean, tempos em segundos)\n");
+	printf(" -l: lista os casos e sai\n");
+	printf("EX1: bench -n 1000,1000000 -r 10 -o base.csv\n");
+	printf("EX2: bench -f cut_ -g face -n 100000\n\n");
+}
+
+/**
+ * \brief Função principal: lê os parâmetros e roda a suíte
+ * \param argc Número de parâmetros passados pela linha de comando
+ * \param argv Parâmetros passados por linha de comando
+ */
+int main(int argc, char **argv)
+{
+	char *shape = BENCH_SHAPE;
+	char *sizes = BENCH_SIZES;
+	char *filter = NULL;
+	char *output = NULL;
+	uint reps = BENCH_REPS;
+	uint warmup = BENCH_WARMUP;
+	uint numcases = sizeof(bench_cases) / sizeof(bench_cases[0]);
+
+	int opt;
+	while ((opt = getopt(argc, argv, "g:n:r:w:f:o:lh")) != -1) {
+		switch (opt) {
+		case 'g':
+			shape = optarg;
+			break;
+		case 'n':
+			sizes = optarg;
+			break;
+		case 'r':
+			reps = (uint)atoi(optarg);
+			break;
+		case 'w':
+			warmup = (uint)atoi(optarg);
+			break;
+		case 'f':
+			filter = optarg;
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		case 'l':
+			for (uint i = 0; i < numcases; i++)
+				printf("%s\n", bench_cases[i].name);
+			return 0;
+		default:
+			bench_help();
+			return 1;
+		}
+	}
+
+	if (reps == 0)
+		reps = 1;
+
+	int s = synth_shape(shape);
+	if (s < 0) {
+		printf("forma desconhecida %s, abortando...\n", shape);
+		return 1;
+	}
+
+	uint numsizes = 0;
+	uint numpts[BENCH_MAXSIZES];
+	for (char *s = sizes; *s != '\0' && numsizes < BENCH_MAXSIZES; s++) {
+		char *end = NULL;
+		long n = strtol(s, &end, 10);
+
+		if (end == s || n <= 0) {
+			printf("tamanhos invalidos %s, abortando...\n", sizes);
+			return 1;
+		}
+
+		numpts[numsizes++] = (uint)n;
+		s = end;
+
+		if (*s == '\0')
+			break;
+	}
+
+	FILE *csv = NULL;
+	if (output != NULL) {
+		csv = fopen(output, "w");
+		if (csv == NULL) {
+			printf("erro abrindo %s, abortando...\n", output);
+			return 1;
+		}
+
+		fprintf(csv, "kernel,numpts,reps,min,median,p90,max,mean\n");
+	}
+
+	real *times = malloc(reps * sizeof(real));
+	if (times == NULL) {
+		printf("sem memoria, abortando...\n");
+		return 1;
+	}
+
+	printf("%-10s %9s %12s %12s %12s %12s %12s\n",
+	       "kernel", "numpts", "min", "median", "p90", "max", "mean");
+
+	for (uint n = 0; n < numsizes; n++) {
+		struct bench_data data;
+
+		if (!bench_setup(&data, s, numpts[n])) {
+			printf("erro gerando %u pontos, abortando...\n", numpts[n]);
+			bench_teardown(&data);
+			return 1;
+		}
+
+		for (uint i = 0; i < numcases; i++) {
+			if (filter != NULL && strstr(bench_cases[i].name, filter) == NULL)
+				continue;
+
+			bench_run(&data,
+			          &bench_cases[i],
+			          numpts[n],
+			          warmup,
+			          reps,
+			          times,
+			          csv);
+		}
+
+		bench_teardown(&data);
+	}
+
+	free(times);
+	if (csv != NULL)
+		fclose(csv);
+
+	return 0;
+}
+
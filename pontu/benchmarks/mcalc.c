@@ -6,6 +6,7 @@
  */
 
 #include <time.h>
+#include <stdint.h>
 #include <unistd.h>
 #include "../pontu_core.h"
 #include "../pontu_features.h"
@@ -41,6 +42,13 @@
 #define CUT_VSHAPE_S	"vs"
 #define CUT_VSHAPE_T	"vt"
 
+#define SERVER_QUIT		"quit"
+#define SERVER_MAXLINE	4096
+#define SERVER_SEP		","
+#define SERVER_MAXITEMS	64
+
+typedef struct dataframe *(*moment_func)(struct cloud *);
+
 /**
  * \brief Exibe mensagem ao usuário informando como usar o extrator de momentos
  */
@@ -84,8 +92,336 @@ void extraction_help()
     printf("     > vs: corte em V sagital\n");
     printf("     > vt: corte em V transversal\n");
     
+    printf(" -s: modo servidor (ignora -m, -i, -o e -c)\n");
+    printf("     > le requisicoes da entrada padrao, uma por linha:\n");
+    printf("       <nuvem> <momento[,momento...]> <corte[,corte...]> [ordens]\n");
+    printf("     > [ordens] opcional, no formato de -O, vale so para a\n");
+    printf("       requisicao\n");
+    printf("     > responde na saida padrao em binario: int32 n (-1 se\n");
+    printf("       erro) seguido de n blocos (uint32 linhas, uint32\n");
+    printf("       colunas, double dados[linhas*colunas]), um por par\n");
+    printf("       (momento, corte) na ordem momento-major\n");
+    printf("     > \"quit\" ou fim da entrada encerram o servidor\n");
+    
+    printf(" -n: numero maximo de nuvens em cache no modo servidor\n");
+    
+    printf(" -C: diretorio do cache de atributos em disco\n");
+    printf("     > chave: hash dos bytes da nuvem, momento, corte e ordens\n");
+    
+    printf(" -O: ordens dos momentos (padrao: as de compilacao)\n");
+    printf("     > legendre=N,chebyshev=X:Y:Z,spheric=X:Y:Z,\n");
+    printf("       zernike=ORD:REP,harmonics=ORD:REP:SPIN\n");
+    printf("     > valores omitidos repetem o ultimo (chebyshev=3 = 3:3:3)\n");
+    
+    printf(" -p: relatorio de tempos por etapa na saida de erro\n");
+    printf("     > table ou json (requer a libpontu compilada com\n");
+    printf("       make PROFILE=1)\n");
+    printf(" -t: linha do tempo das etapas por thread (trace event JSON,\n");
+    printf("     abre no chrome://tracing ou Perfetto; requer PROFILE=1)\n");
+    printf(" -v: relatorio de memoria por subsistema na saida de erro\n");
+    printf("     (bytes vivos, pico, alocacoes, liberacoes e falhas)\n");
+    
     printf("EX1: mcalc -m hu_1980 -i ../data/cloud1.xyz -o hu1.txt -c t\n");
-    printf("EX2: mcalc -m legendre -i ../dataset/bunny.xyz -o stdout -c w\n\n");
+    printf("EX2: mcalc -m legendre -i ../dataset/bunny.xyz -o stdout -c w\n");
+    printf("EX3: mcalc -s -n 128 < requisicoes.txt > momentos.bin\n");
+    printf("EX4: mcalc -m zkmag -i bs000.xyz -o stdout -c s -C ~/.mcalc\n");
+    printf("EX5: mcalc -m zkodd -i bs000.xyz -o stdout -c w -O zernike=10:8\n\n");
+}
+
+/**
+ * \brief Traduz o nome de um momento na função que o calcula
+ * \param moment Nome do momento
+ * \return Função de extração (hututu caso o nome seja desconhecido)
+ */
+moment_func mcalc_moment(const char *moment)
+{
+	if (!strcmp(moment, HUTUTU))
+		return &hu_cloud_moments_hututu;
+	else if (!strcmp(moment, HU1980))
+		return &hu_cloud_moments_hu1980;
+	else if (!strcmp(moment, LEGENDRE))
+		return &legendre_cloud_moments;
+	else if (!strcmp(moment, CHEBYSHEV))
+		return &chebyshev_cloud_moments;
+	else if (!strcmp(moment, ZERNIKE_ODD))
+		return &zernike_cloud_moments_odd;
+	else if (!strcmp(moment, ZERNIKE_EVEN))
+		return &zernike_cloud_moments_even;
+	else if (!strcmp(moment, ZERNIKE_MAG))
+		return &zernike_cloud_moments_mag;
+	else if (!strcmp(moment, ZERNIKE_FULL))
+		return &zernike_cloud_moments_full;
+	else if (!strcmp(moment, HARMON_ODD))
+		return &harmonics_cloud_moments_odd;
+	else if (!strcmp(moment, HARMON_EVEN))
+		return &harmonics_cloud_moments_even;
+	else if (!strcmp(moment, HARMON_MAG))
+		return &harmonics_cloud_moments_mag;
+	else if (!strcmp(moment, HARMON_FULL))
+		return &harmonics_cloud_moments_full;
+	else if (!strcmp(moment, SPHERIC))
+		return &spheric_cloud_moments;
+	else
+		return &hu_cloud_moments_hututu; // (:
+}
+
+/**
+ * \brief Extrai momentos de uma nuvem aplicando um tipo de corte
+ * \param cloud Nuvem alvo
+ * \param mfunc Função de extração de momentos
+ * \param cut Nome do corte
+ * \return Dataframe com os momentos extraídos
+ */
+struct dataframe *mcalc_extract(struct cloud *cloud,
+                                moment_func mfunc,
+                                const char *cut)
+{
+	if (!strcmp(cut, CUT_WHOLE))
+		return (*mfunc)(cloud);
+	else if (!strcmp(cut, CUT_SAGITTAL))
+		return extraction_sagittal(cloud, mfunc);
+	else if (!strcmp(cut, CUT_TRANSVERSAL))
+		return extraction_transversal(cloud, mfunc);
+	else if (!strcmp(cut, CUT_FRONTAL))
+		return extraction_frontal(cloud, mfunc);
+	else if (!strcmp(cut, CUT_RADIAL))
+		return extraction_radial(cloud, mfunc);
+	else if (!strcmp(cut, CUT_UPPER))
+		return extraction_upper(cloud, mfunc);
+	else if (!strcmp(cut, CUT_LOWER))
+		return extraction_lower(cloud, mfunc);
+	else if (!strcmp(cut, CUT_7))
+		return extraction_7(cloud, mfunc);
+	else if (!strcmp(cut, CUT_6))
+		return extraction_6(cloud, mfunc);
+	else if (!strcmp(cut, CUT_4))
+		return extraction_4(cloud, mfunc);
+	else if (!strcmp(cut, CUT_MANHATTAN))
+		return extraction_manhattan(cloud, mfunc);
+	else if (!strcmp(cut, CUT_VSHAPE))
+		return extraction_vshape(cloud, mfunc);
+	else if (!strcmp(cut, CUT_VSHAPE_F))
+		return extraction_vshape_f(cloud, mfunc);
+	else if (!strcmp(cut, CUT_VSHAPE_S))
+		return extraction_vshape_s(cloud, mfunc);
+	else if (!strcmp(cut, CUT_VSHAPE_T))
+		return extraction_vshape_t(cloud, mfunc);
+	else
+		return (*mfunc)(cloud);
+}
+
+/**
+ * \brief Escreve um dataframe como bloco binário (linhas, colunas, dados)
+ * \param df Dataframe a ser escrito (NULL escreve um bloco vazio)
+ * \param output Arquivo de saída
+ */
+void mcalc_write_block(struct dataframe *df, FILE *output)
+{
+	uint32_t rows = df != NULL ? df->rows : 0;
+	uint32_t cols = df != NULL ? df->cols : 0;
+	
+	fwrite(&rows, sizeof(uint32_t), 1, output);
+	fwrite(&cols, sizeof(uint32_t), 1, output);
+	
+	if (rows * cols > 0)
+		fwrite(df->data, sizeof(real), rows * cols, output);
+}
+
+/**
+ * \brief Separa uma lista separada por vírgulas nos seus itens (itens vazios
+ * são ignorados, como em strtok_r)
+ * \param list Lista no formato a,b,c (modificada)
+ * \param items Saída com ponteiros para os itens (espaço para max)
+ * \param max Número máximo de itens
+ * \return Número de itens, ou -1 se a lista tem mais de max itens
+ */
+int32_t mcalc_split(char *list, char **items, int32_t max)
+{
+	int32_t n = 0;
+	char *save = NULL;
+	
+	for (char *c = strtok_r(list, SERVER_SEP, &save);
+	     c != NULL;
+	     c = strtok_r(NULL, SERVER_SEP, &save)) {
+		if (n == max)
+			return -1;
+		
+		items[n++] = c;
+	}
+	
+	return n;
+}
+
+/**
+ * \brief Extrai momentos consultando antes o cache de atributos em disco
+ * \param fc Cache de atributos (NULL desativa o cache)
+ * \param hash Hash dos bytes da nuvem
+ * \param cloud Nuvem alvo (carregada sob demanda se NULL)
+ * \param cache Cache de nuvens usado para carregar a nuvem (ou NULL)
+ * \param path Caminho da nuvem
+ * \param moment Nome do momento
+ * \param cut Nome do corte
+ * \return Dataframe com os momentos, ou NULL se a nuvem não pôde ser lida
+ */
+struct dataframe *mcalc_cached_extract(struct featcache *fc,
+                                       uint64_t hash,
+                                       struct cloud **cloud,
+                                       struct cloudcache *cache,
+                                       const char *path,
+                                       const char *moment,
+                                       const char *cut)
+{
+	uint64_t key = 0;
+	
+	if (fc != NULL) {
+		key = featcache_key(hash, moment, cut);
+		
+		struct dataframe *cached = featcache_load(fc, key);
+		if (cached != NULL)
+			return cached;
+	}
+	
+	if (*cloud == NULL)
+		*cloud = cache != NULL ? cloudcache_get(cache, path) : cloud_load(path);
+	
+	if (*cloud == NULL)
+		return NULL;
+	
+	struct dataframe *results = mcalc_extract(*cloud, mcalc_moment(moment), cut);
+	
+	if (fc != NULL)
+		featcache_store(fc, key, results);
+	
+	return results;
+}
+
+/**
+ * \brief Atende uma requisição do modo servidor
+ * \param cache Cache de nuvens carregadas
+ * \param fc Cache de atributos em disco (ou NULL)
+ * \param line Requisição no formato "<nuvem> <momentos> <cortes> [ordens]"
+ * \param output Arquivo de saída
+ */
+void mcalc_serve_request(struct cloudcache *cache,
+                         struct featcache *fc,
+                         char *line,
+                         FILE *output)
+{
+	char path[SERVER_MAXLINE];
+	char moments[SERVER_MAXLINE];
+	char cuts[SERVER_MAXLINE];
+	char orders[SERVER_MAXLINE];
+	uint64_t hash = 0;
+	int32_t n = -1;
+	
+	int tokens = sscanf(line, "%s %s %s %s", path, moments, cuts, orders);
+	if (tokens < 3) {
+		fwrite(&n, sizeof(int32_t), 1, output);
+		return;
+	}
+	
+	struct momentcfg previous = *momentcfg_current();
+	if (tokens == 4) {
+		struct momentcfg cfg = previous;
+		if (!momentcfg_parse(&cfg, orders)) {
+			fwrite(&n, sizeof(int32_t), 1, output);
+			return;
+		}
+		
+		momentcfg_set(&cfg);
+	}
+	
+	struct cloud *cloud = NULL;
+	if (fc != NULL) {
+		if (!featcache_hash_file(path, &hash)) {
+			fwrite(&n, sizeof(int32_t), 1, output);
+			momentcfg_set(&previous);
+			return;
+		}
+	} else {
+		cloud = cloudcache_get(cache, path);
+		if (cloud == NULL) {
+			fwrite(&n, sizeof(int32_t), 1, output);
+			momentcfg_set(&previous);
+			return;
+		}
+	}
+	
+	char *mlist[SERVER_MAXITEMS];
+	char *clist[SERVER_MAXITEMS];
+	int32_t nm = mcalc_split(moments, mlist, SERVER_MAXITEMS);
+	int32_t nc = mcalc_split(cuts, clist, SERVER_MAXITEMS);
+	
+	if (nm > 0 && nc > 0)
+		n = nm * nc;
+	
+	fwrite(&n, sizeof(int32_t), 1, output);
+	
+	for (int32_t m = 0; m < nm && n > 0; m++) {
+		for (int32_t c = 0; c < nc; c++) {
+			struct dataframe *results = mcalc_cached_extract(fc,
+			                                                 hash,
+			                                                 &cloud,
+			                                                 cache,
+			                                                 path,
+			                                                 mlist[m],
+			                                                 clist[c]);
+			mcalc_write_block(results, output);
+			dataframe_free(&results);
+		}
+	}
+	
+	momentcfg_set(&previous);
+}
+
+/**
+ * \brief Modo servidor: atende requisições até "quit" ou fim da entrada
+ * \param capacity Número máximo de nuvens mantidas em cache
+ * \param fc Cache de atributos em disco (ou NULL)
+ * \return 0 se encerrou normalmente, ou 1 se não conseguiu iniciar
+ */
+int mcalc_server(uint capacity, struct featcache *fc)
+{
+	struct cloudcache *cache = cloudcache_new(capacity);
+	if (cache == NULL)
+		return 1;
+	
+	char line[SERVER_MAXLINE];
+	while (fgets(line, SERVER_MAXLINE, stdin) != NULL) {
+		if (!strncmp(line, SERVER_QUIT, strlen(SERVER_QUIT)))
+			break;
+		
+		if (line[0] == '\n')
+			continue;
+		
+		mcalc_serve_request(cache, fc, line, stdout);
+		fflush(stdout);
+	}
+	
+	cloudcache_debug(cache, stderr);
+	cloudcache_free(&cache);
+	
+	if (fc != NULL)
+		fprintf(stderr, "featcache hits: %u | misses: %u\n", fc->hits, fc->misses);
+	
+	return 0;
+}
+
+/**
+ * \brief Exibe o relatório de tempos por etapa na saída de erro
+ * \param format Formato do relatório (table ou json; NULL não exibe nada)
+ */
+void mcalc_profile(const char *format)
+{
+	if (format == NULL)
+		return;
+
+	if (!profile_enabled())
+		fprintf(stderr, "libpontu compilada sem PROFILE=1\n");
+	else if (!strcmp(format, "json"))
+		profile_report(stderr, PROFILE_JSON);
+	else
+		profile_report(stderr, PROFILE_TABLE);
 }
 
 /**
@@ -99,9 +435,16 @@ int main(int argc, char** argv)
     char* input = NULL;
     char* output = NULL;
     char* cut = NULL;
+	char* cachedir = NULL;
+	char* orders = NULL;
+	char* profile = NULL;
+	char* trace = NULL;
+	int verbose = 0;
+	int server = 0;
+	uint capacity = 0;
 	
     int opt;
-    while ((opt = getopt(argc, argv, "m:i:o:c:")) != -1) {
+    while ((opt = getopt(argc, argv, "m:i:o:c:sn:C:O:p:t:v")) != -1) {
         switch (opt) {
             case 'm':
                 moment = optarg;
@@ -115,85 +458,88 @@ int main(int argc, char** argv)
             case 'c':
                 cut = optarg;
                 break;
+            case 's':
+                server = 1;
+                break;
+            case 'n':
+                capacity = (uint)atoi(optarg);
+                break;
+            case 'C':
+                cachedir = optarg;
+                break;
+            case 'O':
+                orders = optarg;
+                break;
+            case 'p':
+                profile = optarg;
+                break;
+            case 't':
+                trace = optarg;
+                break;
+            case 'v':
+                verbose = 1;
+                break;
             default:
                 abort();
         }
     }
 	
+	if (orders != NULL) {
+		struct momentcfg cfg;
+		momentcfg_default(&cfg);
+		if (!momentcfg_parse(&cfg, orders)) {
+			printf("ordens invalidas %s, abortando...\n", orders);
+			exit(1);
+		}
+		
+		momentcfg_set(&cfg);
+	}
+	
+	if (trace != NULL && !profile_trace_open(trace))
+		fprintf(stderr, "libpontu compilada sem PROFILE=1\n");
+	
+	struct featcache* fc = NULL;
+	if (cachedir != NULL) {
+		fc = featcache_new(cachedir);
+		if (fc == NULL) {
+			printf("erro abrindo cache %s, abortando...\n", cachedir);
+			exit(1);
+		}
+	}
+	
+	if (server) {
+		int ret = mcalc_server(capacity, fc);
+		featcache_free(&fc);
+		profile_trace_close();
+		mcalc_profile(profile);
+		if (verbose)
+			mem_report(stderr, MEM_TABLE);
+		return ret;
+	}
+	
     if (moment == NULL || input == NULL || output == NULL || cut == NULL) {
         extraction_help();
         return 1;
     }
 	
-    struct dataframe* (*mfunc)(struct cloud*) = &hu_cloud_moments_hututu;
-    if (!strcmp(moment, HUTUTU))
-        mfunc = &hu_cloud_moments_hututu;
-    else if (!strcmp(moment, HU1980))
-        mfunc = &hu_cloud_moments_hu1980;
-    else if (!strcmp(moment, LEGENDRE))
-        mfunc = &legendre_cloud_moments;
-    else if (!strcmp(moment, CHEBYSHEV))
-        mfunc = &chebyshev_cloud_moments;
-    else if (!strcmp(moment, ZERNIKE_ODD))
-        mfunc = &zernike_cloud_moments_odd;
-    else if (!strcmp(moment, ZERNIKE_EVEN))
-        mfunc = &zernike_cloud_moments_even;
-    else if (!strcmp(moment, ZERNIKE_MAG))
-        mfunc = &zernike_cloud_moments_mag;
-	else if (!strcmp(moment, ZERNIKE_FULL))
-        mfunc = &zernike_cloud_moments_full;
-	else if (!strcmp(moment, HARMON_ODD))
-        mfunc = &harmonics_cloud_moments_odd;
-    else if (!strcmp(moment, HARMON_EVEN))
-        mfunc = &harmonics_cloud_moments_even;
-    else if (!strcmp(moment, HARMON_MAG))
-        mfunc = &harmonics_cloud_moments_mag;
-	else if (!strcmp(moment, HARMON_FULL))
-        mfunc = &harmonics_cloud_moments_full;
-    else if (!strcmp(moment, SPHERIC))
-        mfunc = &spheric_cloud_moments;
-    else
-    	mfunc = &hu_cloud_moments_hututu; // (:
-	
-    struct cloud* cloud = cloud_load_xyz(input);
-    if (input == NULL) {
+	uint64_t hash = 0;
+	if (fc != NULL && !featcache_hash_file(input, &hash)) {
         printf("abortando...\n");
         exit(1);
-    }
+	}
 	
-	struct dataframe* results = NULL;
-	if (!strcmp(cut, CUT_WHOLE))
-		results = (*mfunc)(cloud);
-	else if (!strcmp(cut, CUT_SAGITTAL))
-		results = extraction_sagittal(cloud, mfunc);
-	else if (!strcmp(cut, CUT_TRANSVERSAL))
-		results = extraction_transversal(cloud, mfunc);
-	else if (!strcmp(cut, CUT_FRONTAL))
-		results = extraction_frontal(cloud, mfunc);
-	else if (!strcmp(cut, CUT_RADIAL))
-		results = extraction_radial(cloud, mfunc);
-	else if (!strcmp(cut, CUT_UPPER))
-		results = extraction_upper(cloud, mfunc);
-	else if (!strcmp(cut, CUT_LOWER))
-		results = extraction_lower(cloud, mfunc);
-	else if (!strcmp(cut, CUT_7))
-		results = extraction_7(cloud, mfunc);
-	else if (!strcmp(cut, CUT_6))
-		results = extraction_6(cloud, mfunc);
-	else if (!strcmp(cut, CUT_4))
-		results = extraction_4(cloud, mfunc);
-	else if (!strcmp(cut, CUT_MANHATTAN))
-		results = extraction_manhattan(cloud, mfunc);
-	else if (!strcmp(cut, CUT_VSHAPE))
-		results = extraction_vshape(cloud, mfunc);
-	else if (!strcmp(cut, CUT_VSHAPE_F))
-		results = extraction_vshape_f(cloud, mfunc);
-	else if (!strcmp(cut, CUT_VSHAPE_S))
-		results = extraction_vshape_s(cloud, mfunc);
-	else if (!strcmp(cut, CUT_VSHAPE_T))
-		results = extraction_vshape_t(cloud, mfunc);
-	else
-		results = (*mfunc)(cloud);
+    struct cloud* cloud = NULL;
+	struct dataframe* results = mcalc_cached_extract(fc,
+	                                                 hash,
+	                                                 &cloud,
+	                                                 NULL,
+	                                                 input,
+	                                                 moment,
+	                                                 cut);
+    if (results == NULL) {
+        printf("abortando...\n");
+        exit(1);
+    }
 	
 	if (!strcmp(output, "stdout")) {
 		dataframe_debug(results, stdout);
@@ -203,6 +549,11 @@ int main(int argc, char** argv)
 	
     dataframe_free(&results);
     cloud_free(&cloud);
+	featcache_free(&fc);
+	profile_trace_close();
+	mcalc_profile(profile);
+	if (verbose)
+		mem_report(stderr, MEM_TABLE);
     
     return 0;
 }
@@ -0,0 +1,92 @@
+/**
+ * \file synth.c
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Gerador de nuvens sintéticas determinísticas
+ */
+
+#include <stdint.h>
+#include <unistd.h>
+#include "../pontu_core.h"
+
+#define SYNTH_SEED 42
+
+/**
+ * \brief Exibe mensagem ao usuário informando como usar o gerador
+ */
+void synth_help()
+{
+	printf("synth: gerador de nuvens sinteticas\n");
+	printf("faltando argumentos! obrigatorios: [ -s | -n | -o ]\n");
+	printf(" -s: forma da nuvem\n");
+	for (int s = 0; s < SYNTH_NUMSHAPES; s++)
+		printf("     > %s\n", synth_name(s));
+	printf(" -n: numero de pontos\n");
+	printf(" -S: semente (padrao: %d); mesma semente, mesma nuvem\n",
+	       SYNTH_SEED);
+	printf(" -o: arquivo de saida (.xyz, .csv, .ply ou .pcd)\n");
+	printf("EX1: synth -s face -n 1000000 -o face.xyz\n");
+	printf("EX2: synth -s duplicates -n 5000000 -S 7 -o dup.ply\n\n");
+}
+
+/**
+ * \brief Função principal: lê os parâmetros, gera e salva a nuvem
+ * \param argc Número de parâmetros passados pela linha de comando
+ * \param argv Parâmetros passados por linha de comando
+ */
+int main(int argc, char **argv)
+{
+	char *shape = NULL;
+	char *output = NULL;
+	long numpts = -1;
+	uint64_t seed = SYNTH_SEED;
+
+	int opt;
+	while ((opt = getopt(argc, argv, "s:n:S:o:")) != -1) {
+		switch (opt) {
+		case 's':
+			shape = optarg;
+			break;
+		case 'n':
+			numpts = atol(optarg);
+			break;
+		case 'S':
+			seed = strtoull(optarg, NULL, 10);
+			break;
+		case 'o':
+			output = optarg;
+			break;
+		default:
+			synth_help();
+			return 1;
+		}
+	}
+
+	if (shape == NULL || output == NULL || numpts < 0) {
+		synth_help();
+		return 1;
+	}
+
+	int s = synth_shape(shape);
+	if (s < 0) {
+		printf("forma desconhecida %s, abortando...\n", shape);
+		return 1;
+	}
+
+	struct cloud *cloud = synth_generate(s, (uint)numpts, seed);
+	if (cloud == NULL) {
+		printf("erro gerando a nuvem, abortando...\n");
+		return 1;
+	}
+
+	if (!cloud_save(cloud, output)) {
+		printf("erro salvando %s, abortando...\n", output);
+		cloud_free(&cloud);
+		return 1;
+	}
+
+	cloud_free(&cloud);
+
+	return 0;
+}
+
@@ -0,0 +1,133 @@
+/**
+ * \file attrib.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Typed per-point attribute channels (normals, colors, intensity,
+ * labels...) stored as contiguous arrays next to the points of a cloud.
+ */
+
+#ifndef ATTRIB_H
+#define ATTRIB_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "./calc.h"
+#include "./mem.h"
+
+#define ATTRIB_REAL 0
+#define ATTRIB_INT 1
+#define ATTRIB_UINT 2
+#define ATTRIB_UCHAR 3
+#define ATTRIB_MAXNAME 32
+#define ATTRIB_MINCAPACITY 16
+
+/**
+ * \brief Struct to store a channel: width values of the same type per point.
+ * The rows are packed in data (row i starts at width * i) and the buffer grows
+ * at the front, so pushing a row (the point just inserted in the head of the
+ * cloud) never moves the others
+ */
+struct attrib {
+	char name[ATTRIB_MAXNAME];
+	int type;
+	uint width;
+	uint numpts;
+	uint capacity;
+	size_t stride;
+	unsigned char *buffer;
+	void *data;
+};
+
+/**
+ * \brief Initializes a channel (no rows)
+ * \param name Name of the channel (truncated to ATTRIB_MAXNAME - 1)
+ * \param type ATTRIB_REAL, ATTRIB_INT, ATTRIB_UINT or ATTRIB_UCHAR
+ * \param width Number of values per point (at least 1)
+ * \return Pointer to the new channel or NULL if it fails
+ */
+struct attrib *attrib_new(const char *name, int type, uint width);
+
+/**
+ * \brief Frees a channel
+ * \param attrib Channel to be freed
+ */
+void attrib_free(struct attrib **attrib);
+
+/**
+ * \brief Gets the size of a value of a type
+ * \param type Type of the value
+ * \return Size in bytes, or 0 if the type is unknown
+ */
+size_t attrib_sizeof(int type);
+
+/**
+ * \brief Adds a row of zeros before the first one
+ * \param attrib Target channel
+ * \return 1 if it was added, or 0 if it fails to allocate memory
+ */
+int attrib_push(struct attrib *attrib);
+
+/**
+ * \brief Removes the first row (undoes attrib_push)
+ * \param attrib Target channel
+ */
+void attrib_pop(struct attrib *attrib);
+
+/**
+ * \brief Gets a value of a channel converted to real
+ * \param attrib Target channel
+ * \param i Row
+ * \param c Component (less than width)
+ * \return The value
+ */
+real attrib_get(struct attrib *attrib, uint i, uint c);
+
+/**
+ * \brief Sets a value of a channel converted from real (truncated and clamped
+ * to the range of an integer type)
+ * \param attrib Target channel
+ * \param i Row
+ * \param c Component (less than width)
+ * \param value The value
+ */
+void attrib_set(struct attrib *attrib, uint i, uint c, real value);
+
+/**
+ * \brief Copies a row between two channels of the same type and width
+ * \param dst Destination channel
+ * \param i Destination row
+ * \param src Source channel
+ * \param j Source row
+ * \return 1 if it was copied, or 0 if the channels do not match
+ */
+int attrib_copy_row(struct attrib *dst, uint i, struct attrib *src, uint j);
+
+/**
+ * \brief Reorders the rows of a channel
+ * \param attrib Target channel
+ * \param perm Row i becomes the old row perm[i]
+ * \return 1 if it was reordered, or 0 if it fails to allocate memory
+ */
+int attrib_permute(struct attrib *attrib, const uint *perm);
+
+/**
+ * \brief Prints a value of a channel in its own format (%le for reals)
+ * \param attrib Target channel
+ * \param i Row
+ * \param c Component (less than width)
+ * \param output File to print in
+ */
+void attrib_print(struct attrib *attrib, uint i, uint c, FILE *output);
+
+/**
+ * \brief Debugs a channel
+ * \param attrib Target channel
+ * \param output File to output the debug in
+ */
+void attrib_debug(struct attrib *attrib, FILE *output);
+
+#endif // ATTRIB_H
+
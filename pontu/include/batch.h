@@ -0,0 +1,94 @@
+/**
+ * \file batch.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief All-pairs registration of probes against a gallery (1:N matching).
+ * The kd-trees and normals of every cloud are built once, then the (probe,
+ * gallery) pairs are spread over a pool of threads, each with its own ICP
+ * engine.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdio.h>
+
+#include "./cloud.h"
+#include "./icp.h"
+#include "./dataframe.h"
+#include "./parallel.h"
+
+#define BATCH_PATIENCE 3
+#define BATCH_PROGRESS 0.1
+
+/**
+ * \brief Struct to store a batch. Entry (i, j) of scores is the final error of
+ * probe i registered with gallery j (INFINITY if it was aborted or failed) and
+ * transforms[i * numgallery + j] its transform. The metric and robust options
+ * of config are used by every pair. After patience iterations, a
+ * registration whose error is above abort and no longer drops by at least
+ * BATCH_PROGRESS of itself per iteration is aborted (abort <= 0 never aborts)
+ */
+struct batch {
+	uint numprobes;
+	uint numgallery;
+	struct cloud **probes;
+	struct cloud **gallery;
+	struct icp *config;
+	real abort;
+	uint patience;
+	uint numthreads;
+	uint numaborted;
+	struct dataframe *scores;
+	struct rigid3 *transforms;
+};
+
+/**
+ * \brief Initializes a batch. The clouds are not copied and may appear in
+ * both lists (or more than once in one): each distinct cloud is prepared once
+ * \param probes Clouds registered (sources)
+ * \param numprobes Number of probes
+ * \param gallery Clouds registered to (targets)
+ * \param numgallery Number of gallery clouds
+ * \param metric ICP_PLANE, ICP_SYMMETRIC or ICP_POINT
+ * \return Pointer to the new batch or NULL if it fails
+ */
+struct batch *batch_new(struct cloud **probes,
+                        uint numprobes,
+                        struct cloud **gallery,
+                        uint numgallery,
+                        int metric);
+
+/**
+ * \brief Frees a batch (the clouds are kept)
+ * \param batch Batch to be freed
+ */
+void batch_free(struct batch **batch);
+
+/**
+ * \brief Registers every probe with every gallery cloud
+ * \param batch Target batch
+ * \param t Stop criteria of each registration
+ * \param k Maximum number of iterations of each registration
+ * \param abort Error above which a registration is given up (<= 0 never)
+ * \return 1 if it ran, or 0 if it fails
+ */
+int batch_run(struct batch *batch, real t, uint k, real abort);
+
+/**
+ * \brief Finds the best gallery cloud of a probe (lowest score)
+ * \param batch Target batch (after batch_run)
+ * \param probe Index of the probe
+ * \return Index of the gallery cloud, or numgallery if every pair failed
+ */
+uint batch_best(struct batch *batch, uint probe);
+
+/**
+ * \brief Debugs a batch
+ * \param batch Target batch
+ * \param output File to output the debug in
+ */
+void batch_debug(struct batch *batch, FILE *output);
+
+#endif // BATCH_H
+
@@ -9,6 +9,7 @@
 #define CALC_H
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <math.h>
 #include <float.h>
 #include <complex.h>
@@ -109,6 +110,28 @@ real calc_length2(real x, real y);
  */
 real calc_randr(real max);
 
+/**
+ * \brief Draws from a seeded generator (splitmix64). Sequences are reproducible
+ * and threads don't interfere as long as each one owns its state
+ * \param state State of the generator (initialize it with the seed)
+ * \return A random 64 bits integer
+ */
+uint64_t calc_rand64(uint64_t *state);
+
+/**
+ * \brief Draws a uniform real from a seeded generator
+ * \param state State of the generator (initialize it with the seed)
+ * \return A random real number on the interval [0, 1)
+ */
+real calc_randu(uint64_t *state);
+
+/**
+ * \brief Draws a standard normal real from a seeded generator (Box-Muller)
+ * \param state State of the generator (initialize it with the seed)
+ * \return A random real number with mean 0 and variance 1
+ */
+real calc_randn(uint64_t *state);
+
 /**
  * \brief Gets the higher number out of 2 real numbers
  * \param a The first real
@@ -166,5 +189,17 @@ real calc_gaussian(real x, real s);
  */
 real calc_gaussian3(real x, real y, real z, real s);
 
+/**
+ * \brief Partially sorts ids[begin..end) by c[ids[i]] so the nth one is in
+ * place, the ones before it are not greater and the ones after it are not
+ * smaller (three-way quickselect, O(n) on average)
+ * \param c Values looked up through the ids
+ * \param ids Positions to be reordered
+ * \param begin First position of the range
+ * \param end One past the last position of the range
+ * \param nth Position to be placed (begin <= nth < end)
+ */
+void calc_select(const real *c, uint *ids, uint begin, uint end, uint nth);
+
 #endif // CALC_H
 
@@ -22,6 +22,7 @@
 
 #include "./cloud.h"
 #include "./dataframe.h"
+#include "./momentcfg.h"
 
 /**
  * \brief Calculates chebyshev polynomial
@@ -32,6 +33,15 @@
  */
 real chebyshev_poly(int p, uint n, real x);
 
+/**
+ * \brief Calculates every chebyshev polynomial up to an order
+ * \param p Maximum polynomial order
+ * \param n Number of points of the cloud
+ * \param x Polynomial argument
+ * \param table Output with p + 1 polynomials of x (orders 0 to p)
+ */
+void chebyshev_poly_table(int p, uint n, real x, real *table);
+
 /**
  * \brief Calculates a chebyshev moment
  * \param p Order of dimension x
@@ -43,11 +53,20 @@ real chebyshev_poly(int p, uint n, real x);
 real chebyshev_moment(int p, int q, int r, struct cloud *cloud);
 
 /**
- * \brief Calculates all chebyshev moments
+ * \brief Calculates all chebyshev moments (current configuration)
  * \param cloud Target cloud
  * \return Matrix with moments of the cloud
  */
 struct dataframe *chebyshev_cloud_moments(struct cloud *cloud);
 
+/**
+ * \brief Calculates all chebyshev moments in a single pass
+ * \param cloud Target cloud
+ * \param cfg Moment orders (cfg->chebyshev)
+ * \return Matrix with moments of the cloud
+ */
+struct dataframe *chebyshev_cloud_moments_cfg(struct cloud *cloud,
+                                              struct momentcfg *cfg);
+
 #endif // CHEBYSHEV_H
 
@@ -11,23 +11,44 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 
 #include "./vector3.h"
 #include "./pointset.h"
 #include "./plane.h"
 #include "./algebra.h"
 #include "./octree.h"
+#include "./pointarray.h"
+#include "./simd.h"
+#include "./rigid.h"
+#include "./kdindex.h"
+#include "./parallel.h"
+#include "./attrib.h"
 
 #define CLOUD_MAXBUFFER 1024
+#define CLOUD_NORMAL_K 10
+#define CLOUD_MAXATTRIBS 16
+#define CLOUD_MAXCOLUMNS 64
+#define CLOUD_ATTRIB_NX "nx"
+#define CLOUD_ATTRIB_NY "ny"
+#define CLOUD_ATTRIB_NZ "nz"
+#define CLOUD_ATTRIB_CURVATURE "curvature"
 
 /**
- * \brief Struct to store a cloud
+ * \brief Struct to store a cloud. Row i of every attribute channel belongs to
+ * the i-th point of the set (the order of cloud_pack())
  */
 struct cloud {
 	struct pointset *points;
 	uint numpts;
 	struct vector3 *centroid;
 	struct octree *tree;
+	struct pointarray *array;
+	struct kdindex *index;
+	real *normals;
+	real *curvature;
+	struct attrib *attribs[CLOUD_MAXATTRIBS];
+	uint numattribs;
 };
 
 /**
@@ -49,7 +70,8 @@ void cloud_free(struct cloud **cloud);
  * \param y Coordinate y
  * \param z Coordinate z
  * \return Pointer to the new point on the cloud or NULL if it fails to be 
- * allocated
+ * allocated. The point is the first of the set, so it gets row 0 (zeros) of
+ * every attribute channel
  */
 struct vector3 *cloud_insert_real(struct cloud *cloud, real x, real y, real z);
 /**
@@ -68,6 +90,37 @@ struct vector3 *cloud_insert_vector3(struct cloud *cloud, struct vector3 *p);
  */
 uint cloud_size(struct cloud *cloud);
 
+/**
+ * \brief Adds an attribute channel to a cloud, with a row of zeros for each
+ * point. The channels are plain data: moving the points does not change them
+ * \param cloud Target cloud
+ * \param name Name of the channel
+ * \param type ATTRIB_REAL, ATTRIB_INT, ATTRIB_UINT or ATTRIB_UCHAR
+ * \param width Number of values per point
+ * \return The new channel (or the one with the same name, type and width
+ * already there) or NULL if it fails
+ */
+struct attrib *cloud_add_attrib(struct cloud *cloud,
+                                const char *name,
+                                int type,
+                                uint width);
+
+/**
+ * \brief Gets an attribute channel of a cloud
+ * \param cloud Target cloud
+ * \param name Name of the channel
+ * \return The channel or NULL if the cloud does not have it
+ */
+struct attrib *cloud_get_attrib(struct cloud *cloud, const char *name);
+
+/**
+ * \brief Removes an attribute channel from a cloud
+ * \param cloud Target cloud
+ * \param name Name of the channel
+ * \return 1 if it was removed, or 0 if the cloud does not have it
+ */
+int cloud_remove_attrib(struct cloud *cloud, const char *name);
+
 /**
  * \brief Generates a spacial partition structure if it wasn't already
  * \param cloud The cloud to be partitioned
@@ -89,14 +142,19 @@ struct cloud *cloud_load_xyz(const char *filename);
 struct cloud *cloud_load_csv(const char *filename);
 
 /**
- * \brief Loads cloud from a PLY file (x y z always first properties!)
+ * \brief Loads cloud from a PLY file (ASCII only!). The scalar properties of
+ * the vertices other than x, y and z (the first three if they are not named)
+ * become channels of width 1, except runs name_0, name_1... of one type, which
+ * become a single channel of that width (as cloud_save_ply writes them); the
+ * ones after a list property are dropped
  * \param filename File name
  * \return Cloud loaded from the file or NULL if it fails to allocate memory
  */
 struct cloud *cloud_load_ply(const char *filename);
 
 /**
- * \brief Loads cloud from a PCD file (DATA ASCII only!)
+ * \brief Loads cloud from a PCD file (DATA ASCII only!). The fields other than
+ * x, y and z become channels (of width COUNT), except the padding ones (_)
  * \param filename File name
  * \return Cloud loaded from the file or NULL if it fails to allocate memory
  */
@@ -109,6 +167,13 @@ struct cloud *cloud_load_pcd(const char *filename);
  */
 struct cloud *cloud_load_obj(const char *filename);
 
+/**
+ * \brief Loads cloud from a file choosing the loader by its extension
+ * \param filename File name (.xyz, .csv, .ply, .pcd or .obj; defaults to XYZ)
+ * \return Cloud loaded from the file or NULL if it fails to allocate memory
+ */
+struct cloud *cloud_load(const char *filename);
+
 /**
  * \brief Saves a cloud in a XYZ file
  * \param cloud Cloud to be saved
@@ -126,7 +191,8 @@ int cloud_save_xyz(struct cloud *cloud, const char *filename);
 int cloud_save_csv(struct cloud *cloud, const char *filename);
 
 /**
- * \brief Saves a cloud in a PLY file
+ * \brief Saves a cloud in a PLY file with its channels as properties (width
+ * above 1 writes name_0, name_1...)
  * \param cloud Cloud to be saved
  * \param filename Destination
  * \return 0 if it fails, or 1 if not
@@ -134,7 +200,7 @@ int cloud_save_csv(struct cloud *cloud, const char *filename);
 int cloud_save_ply(struct cloud *cloud, const char *filename);
 
 /**
- * \brief Saves a cloud in a PCD file
+ * \brief Saves a cloud in a PCD file with its channels as fields
  * \param cloud Cloud to be saved
  * \param filename Destination
  * \return 0 if it fails, or 1 if not
@@ -142,18 +208,119 @@ int cloud_save_ply(struct cloud *cloud, const char *filename);
 int cloud_save_pcd(struct cloud *cloud, const char *filename);
 
 /**
- * \brief Makes a copy of a cloud
+ * \brief Saves a cloud in a file choosing the saver by its extension
+ * \param cloud Cloud to be saved
+ * \param filename Destination (.xyz, .csv, .ply or .pcd; defaults to XYZ)
+ * \return 0 if it fails, or 1 if not
+ */
+int cloud_save(struct cloud *cloud, const char *filename);
+
+/**
+ * \brief Makes a copy of a cloud (and its channels)
  * \param cloud The cloud to be copied
  * \return A copy of the input cloud
  */
 struct cloud *cloud_copy(struct cloud *cloud);
 
+/**
+ * \brief Makes a new cloud with some of the points of a cloud (and their
+ * channels), in the given order
+ * \param cloud Source cloud
+ * \param ids Positions of the points in the order of cloud_pack() (repeats
+ * are copied again)
+ * \param numids Number of positions
+ * \return The new cloud or NULL if it fails or a position is out of range
+ */
+struct cloud *cloud_select(struct cloud *cloud, const uint *ids, uint numids);
+
 /**
  * \brief Generates a tree data structure that partitionates the cloud
  * \param cloud The target cloud
  */
 void cloud_partitionate(struct cloud *cloud);
 
+/**
+ * \brief Gets the contiguous copy of the points of a cloud, packing it if
+ * needed. The copy is kept until the cloud is modified by one of the cloud_*
+ * functions (insert, scale, translate, transform, sort)
+ * \param cloud Target cloud
+ * \return The packed points (owned by the cloud) or NULL if it fails
+ */
+struct pointarray *cloud_pack(struct cloud *cloud);
+
+/**
+ * \brief Gets the exact kd-tree of a cloud, building it if needed. Like the
+ * packed copy, it is kept until the points change; its positions are the
+ * positions in cloud_pack()
+ * \param cloud Target cloud
+ * \return The tree (owned by the cloud) or NULL if it fails
+ */
+struct kdindex *cloud_index(struct cloud *cloud);
+
+/**
+ * \brief Estimates the normal and the surface variation of every point in
+ * parallel. Each one comes from the covariance of a neighborhood: the normal is
+ * the eigenvector of the smallest eigenvalue (closed form, no iterations) and
+ * the curvature is that eigenvalue over the sum of the three, from 0 (plane)
+ * to 1/3 (isotropic). Points with less than 3 neighbors get zeros. The results
+ * replace the ones kept by the cloud until the points change
+ * \param cloud Target cloud
+ * \param k Number of neighbors (at least 3), or the most used with radius (the
+ * k nearest within it)
+ * \param radius Radius of the neighborhoods (<= 0 uses the k nearest)
+ * \return 1 if they were estimated, or 0 if it fails
+ */
+int cloud_estimate_normals(struct cloud *cloud, uint k, real radius);
+
+/**
+ * \brief Gets the normal of every point, estimating them if needed from the
+ * k nearest neighbors (see cloud_estimate_normals). They are kept with the
+ * tree, so the k of the first call is used until the points change
+ * \param cloud Target cloud
+ * \param k Size of the neighborhoods (at least 3)
+ * \return Array with x, y and z of each normal, in the order of cloud_pack(),
+ * owned by the cloud, or NULL if it fails
+ */
+real *cloud_normals(struct cloud *cloud, uint k);
+
+/**
+ * \brief Gets the surface variation of every point, estimating it with the
+ * normals if needed (CLOUD_NORMAL_K neighbors)
+ * \param cloud Target cloud
+ * \return Array with the curvature of each point, in the order of
+ * cloud_pack(), owned by the cloud, or NULL if it fails
+ */
+real *cloud_surface_variation(struct cloud *cloud);
+
+/**
+ * \brief Copies the normals and the surface variation of a cloud (estimated
+ * with k neighbors if needed) to the real channels CLOUD_ATTRIB_NX,
+ * CLOUD_ATTRIB_NY, CLOUD_ATTRIB_NZ and CLOUD_ATTRIB_CURVATURE, which are kept
+ * (and saved) when the cloud changes and rotated by cloud_transform() and
+ * cloud_transform_rigid()
+ * \param cloud Target cloud
+ * \param k Size of the neighborhoods (at least 3)
+ * \return 1 if they were stored, or 0 if it fails
+ */
+int cloud_store_normals(struct cloud *cloud, uint k);
+
+/**
+ * \brief Drops the packed copy of the points of a cloud (and the kd-tree and
+ * normals built from it). Call it after changing the points directly (outside
+ * the cloud_* functions)
+ * \param cloud Target cloud
+ */
+void cloud_invalidate(struct cloud *cloud);
+
+/**
+ * \brief Calculates bounds, sums and second order sums of a cloud in a single
+ * vectorized pass
+ * \param cloud Target cloud
+ * \param stats Output statistics
+ * \return 1 if the reduction was done, or 0 if it fails to pack the cloud
+ */
+int cloud_reduce(struct cloud *cloud, struct simd_stats *stats);
+
 /**
  * \brief Calculates the geometric centroid of a cloud
  * \param cloud Target cloud
@@ -210,7 +377,17 @@ void cloud_translate_real(struct cloud *cloud, real x, real y, real z);
 void cloud_transform(struct cloud *cloud, struct matrix* rt);
 
 /**
- * \brief Sort a cloud by an axis using quick sort
+ * \brief Transform a cloud with a rigid transform. The packed copy of the
+ * points is transformed with SIMD and kept valid
+ * \param cloud Target cloud
+ * \param rt Rigid transform
+ * \return 1 if the cloud was transformed, or 0 if it fails to pack it
+ */
+int cloud_transform_rigid(struct cloud *cloud, const struct rigid3 *rt);
+
+/**
+ * \brief Sort a cloud by an axis using quick sort (the rows of the channels
+ * follow their points)
  * \param cloud Target cloud
  * \param axis The axis to sort with (0: x, 1: y, 2: z)
  */
@@ -220,7 +397,8 @@ void cloud_sort(struct cloud *cloud, int axis);
  * \brief Concatenates two clouds
  * \param c1 First cloud
  * \param c2 Second cloud
- * \return New cloud with c1 and c2 points
+ * \return New cloud with c1 and c2 points and the channels of both (zeros for
+ * the points of a cloud without the channel)
  */
 struct cloud *cloud_concat(struct cloud *c1, struct cloud *c2);
 
@@ -257,7 +435,7 @@ real cloud_function_volume(struct cloud *cloud);
  * \param cloud Target cloud
  * \param p Reference
  * \param r Radius for the crop (mm)
- * \return Cropped cloud
+ * \return Cropped cloud (with the channels of the points kept)
  */
 struct cloud *cloud_cut_radius(struct cloud *cloud, struct vector3 *p, real r);
 
@@ -273,7 +451,7 @@ struct cloud *cloud_cut_centroid(struct cloud *cloud, real r);
  * \brief Crops a cloud in a direction from a reference
  * \param cloud Target cloud
  * \param plane Plane to cut
- * \return Cropped cloud
+ * \return Cropped cloud (with the channels of the points kept)
  */
 struct cloud *cloud_cut_plane(struct cloud *cloud, struct plane *plane);
 
@@ -283,7 +461,7 @@ struct cloud *cloud_cut_plane(struct cloud *cloud, struct plane *plane);
  * \param plane The plane to be used to split the cloud
  * \param p1 First slice of the split cloud
  * \param p2 Second slice of the split cloud
- * \return 0 if it fails, or 1 if not
+ * \return 0 if it fails, or 1 if not (both slices get the channels)
  */
 int cloud_plane_partition(struct cloud *src,
 			              struct plane *plane,
@@ -305,7 +483,7 @@ struct vector3 *cloud_max_distance_from_plane(struct cloud *cloud,
  * \param ref Reference point
  * \param dir Direction of the cylinder height
  * \param radius Radius of the cylinder
- * \return Subsample inserted in the cylinder
+ * \return Subsample inserted in the cylinder (with its channels)
  */
 struct cloud *cloud_cut_cylinder(struct cloud *cloud,
 				                 struct vector3 *ref,
@@ -318,7 +496,8 @@ struct cloud *cloud_cut_cylinder(struct cloud *cloud,
  * \param ref Reference point
  * \param dir Direction of the segment
  * \param epslon Width of the segment (mm)
- * \return Subsample of the cloud with points of the segment
+ * \return Subsample of the cloud with points of the segment (with their
+ * channels)
  */
 struct cloud *cloud_segment(struct cloud *cloud,
 			                struct vector3 *ref,
@@ -0,0 +1,80 @@
+/**
+ * \file cloudcache.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief LRU cache of loaded clouds (and their spatial partitions).
+ */
+
+#ifndef CLOUDCACHE_H
+#define CLOUDCACHE_H
+
+#include <stdio.h>
+#include <time.h>
+
+#include "./cloud.h"
+
+#define CLOUDCACHE_MAXPATH 1024
+#define CLOUDCACHE_CAPACITY 64
+
+/**
+ * \brief Struct to store a cache entry (node of a DLL ordered by use)
+ */
+struct cloudcache_entry {
+	char path[CLOUDCACHE_MAXPATH];
+	time_t mtime;
+	struct cloud *cloud;
+	struct cloudcache_entry *prev;
+	struct cloudcache_entry *next;
+};
+
+/**
+ * \brief Struct to store a cache of clouds indexed by file path
+ */
+struct cloudcache {
+	struct cloudcache_entry *head;
+	struct cloudcache_entry *tail;
+	uint size;
+	uint capacity;
+	uint hits;
+	uint misses;
+};
+
+/**
+ * \brief Initializes a cloud cache
+ * \param capacity Maximum number of clouds kept in memory (0 for default)
+ * \return Pointer to the new cache or NULL if it fails to allocate memory
+ */
+struct cloudcache *cloudcache_new(uint capacity);
+
+/**
+ * \brief Frees a cloud cache and every cloud in it
+ * \param cache Cache to be freed
+ */
+void cloudcache_free(struct cloudcache **cache);
+
+/**
+ * \brief Gets a cloud from the cache, loading (and partitioning) it on a miss
+ * \param cache Target cache
+ * \param path Path of the cloud file
+ * \return Cloud owned by the cache or NULL if it can't be loaded. The pointer
+ * is valid until the entry is evicted, so don't keep it between calls
+ */
+struct cloud *cloudcache_get(struct cloudcache *cache, const char *path);
+
+/**
+ * \brief Removes a cloud from the cache
+ * \param cache Target cache
+ * \param path Path of the cloud file
+ * \return 1 if the cloud was cached, or 0 if not
+ */
+int cloudcache_drop(struct cloudcache *cache, const char *path);
+
+/**
+ * \brief Debugs a cache (usage statistics and entries)
+ * \param cache Target cache
+ * \param output File to output the debug in
+ */
+void cloudcache_debug(struct cloudcache *cache, FILE *output);
+
+#endif // CLOUDCACHE_H
+
@@ -0,0 +1,64 @@
+/**
+ * \file cloudview.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Views of a cloud: subsets given by the positions of their points, so
+ * a sample can be read (or fed to a moment accumulator) without copying it.
+ */
+
+#ifndef CLOUDVIEW_H
+#define CLOUDVIEW_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "./cloud.h"
+
+/**
+ * \brief Struct to store a view. ids holds positions in the order of
+ * cloud_pack(), so the view is valid while the cloud is not modified
+ */
+struct cloudview {
+	struct cloud *cloud;
+	uint numids;
+	uint *ids;
+};
+
+/**
+ * \brief Allocates a view
+ * \param cloud Cloud to be viewed (not owned)
+ * \param numids Number of positions (left for the caller to fill)
+ * \return Pointer to the new view or NULL if it fails
+ */
+struct cloudview *cloudview_new(struct cloud *cloud, uint numids);
+
+/**
+ * \brief Frees a view (the cloud is kept)
+ * \param view View to be freed
+ */
+void cloudview_free(struct cloudview **view);
+
+/**
+ * \brief Gets a point of a view
+ * \param view Target view
+ * \param j Position in the view
+ * \return The point of the cloud or NULL if j is out of range
+ */
+struct vector3 *cloudview_point(struct cloudview *view, uint j);
+
+/**
+ * \brief Copies the points of a view to a new cloud (with their channels)
+ * \param view Target view
+ * \return The new cloud or NULL if it fails
+ */
+struct cloud *cloudview_materialize(struct cloudview *view);
+
+/**
+ * \brief Debugs a view
+ * \param view Target view
+ * \param output File to output the debug in
+ */
+void cloudview_debug(struct cloudview *view, FILE *output);
+
+#endif // CLOUDVIEW_H
+
@@ -0,0 +1,95 @@
+/**
+ * \file cluster.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Euclidean cluster extraction: two points are connected when they lie
+ * within a radius of each other and the clusters are the connected components,
+ * merged in a lock-free union-find while the radius queries of the kd-tree run
+ * across threads.
+ */
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <stdatomic.h>
+
+#include "./cloud.h"
+#include "./cloudview.h"
+#include "./kdindex.h"
+#include "./parallel.h"
+
+#define CLUSTER_NONE UINT_MAX
+#define CLUSTER_NEIGHBORS 64
+
+/**
+ * \brief Struct to store the clusters of a cloud. labels holds the cluster of
+ * every point in the order of cloud_pack() (CLUSTER_NONE if its component was
+ * too small or too big) and clusters are numbered by decreasing size, so
+ * cluster 0 is the largest one
+ */
+struct cluster {
+	struct cloud *cloud;
+	uint numclusters;
+	uint *labels;
+	uint *sizes;
+};
+
+/**
+ * \brief Finds the connected components of a cloud (O(n log n) plus the size
+ * of the neighborhoods)
+ * \param cloud Target cloud (not owned; must not be modified while the
+ * clusters are used)
+ * \param radius Maximum distance between neighbor points of a cluster
+ * \param minpts Minimum number of points of a cluster
+ * \param maxpts Maximum number of points of a cluster (0 for no maximum)
+ * \return Pointer to the clusters or NULL if it fails
+ */
+struct cluster *cluster_euclidean(struct cloud *cloud,
+                                  real radius,
+                                  uint minpts,
+                                  uint maxpts);
+
+/**
+ * \brief Frees the clusters (the cloud is kept)
+ * \param clusters Clusters to be freed
+ */
+void cluster_free(struct cluster **clusters);
+
+/**
+ * \brief Gets the points of a cluster
+ * \param clusters Target clusters
+ * \param label Number of the cluster
+ * \return View with the positions of its points in increasing order or NULL if
+ * the cluster does not exist or it fails
+ */
+struct cloudview *cluster_view(struct cluster *clusters, uint label);
+
+/**
+ * \brief Gets the points of every cluster in a single pass
+ * \param clusters Target clusters
+ * \return Array of numclusters views (each one freed by cloudview_free and the
+ * array by free) or NULL if it fails
+ */
+struct cloudview **cluster_views(struct cluster *clusters);
+
+/**
+ * \brief Extracts the largest connected component of a cloud
+ * \param cloud Target cloud
+ * \param radius Maximum distance between neighbor points of a cluster
+ * \return The new cloud (with the channels of the points kept) or NULL if it
+ * fails or the cloud is empty
+ */
+struct cloud *cluster_largest(struct cloud *cloud, real radius);
+
+/**
+ * \brief Debugs the clusters
+ * \param clusters Target clusters
+ * \param output File to output the debug in
+ */
+void cluster_debug(struct cluster *clusters, FILE *output);
+
+#endif // CLUSTER_H
+
@@ -12,6 +12,7 @@
 #include <stdio.h>
 
 #include "./calc.h"
+#include "./mem.h"
 
 /**
  * \brief Struct to store 2D arrays
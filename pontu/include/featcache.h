@@ -0,0 +1,105 @@
+/**
+ * \file featcache.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Content-addressed on-disk cache of extracted features.
+ */
+
+#ifndef FEATCACHE_H
+#define FEATCACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "./dataframe.h"
+#include "./momentcfg.h"
+
+#define FEATCACHE_VERSION 3
+#define FEATCACHE_MAXPATH 1024
+#define FEATCACHE_MAXNAME 32
+#define FEATCACHE_MAGIC "PNTF"
+#define FEATCACHE_FNV_OFFSET 14695981039346656037ULL
+#define FEATCACHE_FNV_PRIME 1099511628211ULL
+
+/**
+ * \brief Struct to store a feature cache rooted in a directory
+ */
+struct featcache {
+	char dir[FEATCACHE_MAXPATH];
+	uint hits;
+	uint misses;
+};
+
+/**
+ * \brief Initializes a feature cache (creates the directory if needed)
+ * \param dir Directory where the cached dataframes are stored
+ * \return Pointer to the new cache or NULL if it fails
+ */
+struct featcache *featcache_new(const char *dir);
+
+/**
+ * \brief Frees a feature cache (the files on disk are kept)
+ * \param cache Cache to be freed
+ */
+void featcache_free(struct featcache **cache);
+
+/**
+ * \brief Hashes a block of bytes (FNV-1a, 64 bits)
+ * \param data Bytes to be hashed
+ * \param size Number of bytes
+ * \param seed Previous hash to be chained (FEATCACHE_FNV_OFFSET to start)
+ * \return The 64 bits hash
+ */
+uint64_t featcache_hash_bytes(const void *data, size_t size, uint64_t seed);
+
+/**
+ * \brief Hashes the content of a file
+ * \param filename File to be hashed
+ * \param hash Output hash
+ * \return 1 if the file was read, or 0 if not
+ */
+int featcache_hash_file(const char *filename, uint64_t *hash);
+
+/**
+ * \brief Hashes the orders used by every moment family
+ * \param cfg Moment orders
+ * \return Hash of the moment orders
+ */
+uint64_t featcache_hash_orders(struct momentcfg *cfg);
+
+/**
+ * \brief Calculates the key of a (cloud, moment, cut) triple under the current
+ * moment orders (momentcfg_current()) and SIMD level (simd_level()), since
+ * vectorized kernels may differ from the scalar ones in the last bits
+ * \param cloud Hash of the cloud bytes
+ * \param moment Name of the moment family
+ * \param cut Name of the cut
+ * \return Key of the entry
+ */
+uint64_t featcache_key(uint64_t cloud,
+                       const char *moment,
+                       const char *cut);
+
+/**
+ * \brief Loads a cached dataframe
+ * \param cache Target cache
+ * \param key Key of the entry
+ * \return The cached dataframe or NULL if it is not in the cache or if the
+ *         file size does not match its header
+ */
+struct dataframe *featcache_load(struct featcache *cache, uint64_t key);
+
+/**
+ * \brief Stores a dataframe in the cache (atomically replaces the entry)
+ *
+ * The entry is written to a uniquely named temporary file and then renamed,
+ * so concurrent writers never share a partial file.
+ * \param cache Target cache
+ * \param key Key of the entry
+ * \param df Dataframe to be stored
+ * \return 1 if the dataframe was stored, or 0 if it fails
+ */
+int featcache_store(struct featcache *cache, uint64_t key, struct dataframe *df);
+
+#endif // FEATCACHE_H
+
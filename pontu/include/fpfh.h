@@ -0,0 +1,77 @@
+/**
+ * \file fpfh.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Fast point feature histograms (Rusu et al., 2009): a 33 bins local
+ * descriptor of every point, invariant to rigid transforms, built from the
+ * angles between its normal and the normals of its k nearest neighbors.
+ */
+
+#ifndef FPFH_H
+#define FPFH_H
+
+#include <stdio.h>
+
+#include "./cloud.h"
+#include "./parallel.h"
+
+#define FPFH_SUBBINS 11
+#define FPFH_BINS 33
+#define FPFH_K 32
+
+/**
+ * \brief Struct to store the descriptors of a cloud. The histogram of the
+ * point at position i of the packed cloud starts at hist[i * FPFH_BINS]; each
+ * of its 3 sub-histograms (one per angle) sums to 100
+ */
+struct fpfh {
+	uint numpts;
+	real *hist;
+};
+
+/**
+ * \brief Computes the descriptors of every point of a cloud in parallel. The
+ * normals come from cloud_normals and are oriented away from the centroid
+ * \param cloud Target cloud
+ * \param k Number of neighbors of each point (FPFH_K is a good start)
+ * \return Pointer to the descriptors or NULL if it fails
+ */
+struct fpfh *fpfh_new(struct cloud *cloud, uint k);
+
+/**
+ * \brief Frees descriptors
+ * \param fpfh Descriptors to be freed
+ */
+void fpfh_free(struct fpfh **fpfh);
+
+/**
+ * \brief Takes the descriptors of a few keypoints (e.g. a sampled copy of the
+ * cloud) from the descriptors of the full cloud, so they keep its detail
+ * \param fpfh Descriptors of cloud
+ * \param cloud The full cloud
+ * \param keys Keypoints (each one gets the descriptor of its nearest point)
+ * \return Pointer to the descriptors of keys or NULL if it fails
+ */
+struct fpfh *fpfh_gather(struct fpfh *fpfh,
+                         struct cloud *cloud,
+                         struct cloud *keys);
+
+/**
+ * \brief Finds the nearest descriptor of a set (squared euclidean distance)
+ * \param fpfh Set searched
+ * \param hist Query histogram (FPFH_BINS reals)
+ * \param dist Output squared distance (can be NULL)
+ * \return Position of the nearest descriptor
+ */
+uint fpfh_nearest(struct fpfh *fpfh, const real *hist, real *dist);
+
+/**
+ * \brief Debugs the descriptor of a point
+ * \param fpfh Target descriptors
+ * \param i Position of the point
+ * \param output File to output the debug in
+ */
+void fpfh_debug(struct fpfh *fpfh, uint i, FILE *output);
+
+#endif // FPFH_H
+
@@ -0,0 +1,73 @@
+/**
+ * \file fps.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Farthest point sampling: subsamples a cloud to exactly k points spread
+ * as evenly as possible, either exactly or over spatial buckets for big clouds.
+ */
+
+#ifndef FPS_H
+#define FPS_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "./cloud.h"
+#include "./simd.h"
+#include "./parallel.h"
+#include "./gridhash.h"
+
+#define FPS_PARALLEL_MIN 65536
+#define FPS_APPROX_FACTOR 8
+#define FPS_APPROX_TRIES 24
+
+/**
+ * \brief Chooses points by farthest point sampling: the first one is the point
+ * farthest from the centroid and each next one the point farthest from all the
+ * chosen so far. Every round is a vectorized distance update, split across the
+ * threads of a team kept for the whole sampling when there are
+ * FPS_PARALLEL_MIN points or more (O(nk))
+ * \param array Target array
+ * \param k Number of points to choose
+ * \param ids Output with the positions of the chosen points in the order they
+ * were chosen (room for k)
+ * \return Number of points chosen (k, or all of them if there are fewer) or 0
+ * if it fails
+ */
+uint fps_select(struct pointarray *array, uint k, uint *ids);
+
+/**
+ * \brief Approximate farthest point sampling for big clouds: the points are
+ * bucketed in a grid with at least FPS_APPROX_FACTOR times k occupied cells,
+ * one point stands for each cell and the exact sampling runs over them (about
+ * O(n + FPS_APPROX_FACTOR k^2)). Falls back to the exact one when the cloud is
+ * not big enough
+ * \param array Target array
+ * \param k Number of points to choose
+ * \param ids Output with the positions of the chosen points in the order they
+ * were chosen (room for k)
+ * \return Number of points chosen (k, or all of them if there are fewer) or 0
+ * if it fails
+ */
+uint fps_select_approx(struct pointarray *array, uint k, uint *ids);
+
+/**
+ * \brief Subsamples a cloud to k points by farthest point sampling
+ * \param cloud Target cloud
+ * \param k Number of points
+ * \return The new cloud (with the channels of the points kept; all the points
+ * if there are fewer than k) or NULL if it fails
+ */
+struct cloud *fps_sampling(struct cloud *cloud, uint k);
+
+/**
+ * \brief Subsamples a cloud to k points by approximate farthest point sampling
+ * \param cloud Target cloud
+ * \param k Number of points
+ * \return The new cloud (with the channels of the points kept; all the points
+ * if there are fewer than k) or NULL if it fails
+ */
+struct cloud *fps_sampling_approx(struct cloud *cloud, uint k);
+
+#endif // FPS_H
+
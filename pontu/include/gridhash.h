@@ -0,0 +1,83 @@
+/**
+ * \file gridhash.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Hash of the occupied cells of a regular grid. Cell coordinates are
+ * packed into a 64 bits key and the keys go into an open addressing table of
+ * 2^bits slots (Fibonacci hashing, linear probing), so only the cells that hold
+ * points cost memory. Used by the grid based samplers.
+ */
+
+#ifndef GRIDHASH_H
+#define GRIDHASH_H
+
+#include <stdint.h>
+#include <math.h>
+
+#include "./calc.h"
+
+#define GRIDHASH_CELLBITS 21
+#define GRIDHASH_MAXCELL ((1ULL << GRIDHASH_CELLBITS) - 1)
+#define GRIDHASH_EMPTY UINT64_MAX
+
+/**
+ * \brief Finds the cell of a coordinate along one axis, clamped to
+ * GRIDHASH_MAXCELL
+ * \param v The coordinate
+ * \param min Smallest coordinate of the grid along the axis
+ * \param size Side of the cells
+ * \return Cell of v
+ */
+static inline uint64_t gridhash_cell(real v, real min, real size)
+{
+	real c = floor((v - min) / size);
+
+	return c >= (real)GRIDHASH_MAXCELL ? GRIDHASH_MAXCELL : (uint64_t)c;
+}
+
+/**
+ * \brief Packs the cell coordinates into a key
+ * \param x Cell along x
+ * \param y Cell along y
+ * \param z Cell along z
+ * \return Key of the cell
+ */
+static inline uint64_t gridhash_key(uint64_t x, uint64_t y, uint64_t z)
+{
+	return x | y << GRIDHASH_CELLBITS | z << 2 * GRIDHASH_CELLBITS;
+}
+
+/**
+ * \brief Empties a table
+ * \param keys Keys of the table (2^bits slots)
+ * \param bits Number of bits of the slots
+ */
+static inline void gridhash_clear(uint64_t *keys, uint bits)
+{
+	for (uint64_t h = 0; h < (1ULL << bits); h++)
+		keys[h] = GRIDHASH_EMPTY;
+}
+
+/**
+ * \brief Finds the slot of a key: the one holding it, or the empty one where it
+ * goes (the table must have an empty slot)
+ * \param keys Keys of the table (2^bits slots)
+ * \param bits Number of bits of the slots
+ * \param key Key to be found
+ * \return Slot of the key (keys[slot] is GRIDHASH_EMPTY if it is not there)
+ */
+static inline uint64_t gridhash_slot(const uint64_t *keys,
+                                     uint bits,
+                                     uint64_t key)
+{
+	uint64_t mask = (1ULL << bits) - 1;
+	uint64_t h = (key * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+
+	while (keys[h] != GRIDHASH_EMPTY && keys[h] != key)
+		h = (h + 1) & mask;
+
+	return h;
+}
+
+#endif // GRIDHASH_H
+
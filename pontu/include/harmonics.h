@@ -136,5 +136,17 @@ struct dataframe *harmonics_cloud_moments_mag(struct cloud *cloud);
  */
 struct dataframe *harmonics_cloud_moments_full(struct cloud *cloud);
 
+/**
+ * \brief Calculates spherical harmonics moments of a cloud in a single pass
+ * \param cloud Target cloud
+ * \param cfg Moment orders (cfg->harmon_ord, cfg->harmon_rep and
+ * cfg->harmon_spin)
+ * \param kind Form of the harmonic (the ZERNIKE_KIND_* values)
+ * \return Matrix with the moments
+ */
+struct dataframe *harmonics_cloud_moments_cfg(struct cloud *cloud,
+                                              struct momentcfg *cfg,
+                                              int kind);
+
 #endif // HARMONICS_H
 
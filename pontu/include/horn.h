@@ -0,0 +1,82 @@
+/**
+ * \file horn.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Closed-form weighted rigid alignment of point correspondences (Horn's
+ * unit quaternion method) with a real 4x4 Jacobi eigen solver. Every buffer
+ * lives on the stack.
+ */
+
+#ifndef HORN_H
+#define HORN_H
+
+#include <stdio.h>
+
+#include "./vector3.h"
+#include "./rigid.h"
+
+#define HORN_SWEEPS 32
+#define HORN_EPS 1e-15
+
+/**
+ * \brief Struct to accumulate weighted correspondences. The centroids and the
+ * cross-covariance are updated in one pass with shifted sums, so clouds far
+ * from the origin don't lose precision
+ */
+struct horn {
+	uint numpts;
+	real weight;
+	real source[3];
+	real target[3];
+	real cov[3][3];
+};
+
+/**
+ * \brief Clears an accumulator
+ * \param horn Target accumulator
+ */
+void horn_reset(struct horn *horn);
+
+/**
+ * \brief Adds a correspondence (source point -> target point)
+ * \param horn Target accumulator
+ * \param source Source point
+ * \param target Target point
+ * \param weight Weight of the pair (pairs with weight <= 0 are ignored)
+ */
+void horn_add(struct horn *horn,
+              struct vector3 *source,
+              struct vector3 *target,
+              real weight);
+
+/**
+ * \brief Diagonalizes a symmetric 4x4 matrix with cyclic Jacobi rotations
+ * \param a Matrix to be diagonalized (destroyed: the eigenvalues end up on
+ * its diagonal)
+ * \param values Output eigenvalues
+ * \param vectors Output eigenvectors (column j goes with values[j])
+ * \return 1 if it converged in HORN_SWEEPS sweeps, or 0 if not
+ */
+int horn_eigen4(real a[4][4], real values[4], real vectors[4][4]);
+
+/**
+ * \brief Solves the rotation and translation that best map the source points
+ * onto the target points (target ~ rotation * source + translation). The
+ * result is always a proper rotation; when it isn't unique (collinear or
+ * single points) any of the optimal ones is returned, and without any
+ * weighted pair the identity is returned
+ * \param horn Accumulated correspondences
+ * \param rt Output transform
+ * \return 1 if the transform was solved, or 0 if the identity was returned
+ */
+int horn_solve(struct horn *horn, struct rigid3 *rt);
+
+/**
+ * \brief Debugs an accumulator
+ * \param horn Target accumulator
+ * \param output File to output the debug in
+ */
+void horn_debug(struct horn *horn, FILE *output);
+
+#endif // HORN_H
+
@@ -0,0 +1,181 @@
+/**
+ * \file icp.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief ICP engine over exact kd-tree correspondences. Every buffer is
+ * allocated with the engine, so the iterations never touch the heap and a
+ * single engine can register many clouds (or every level of a pyramid).
+ */
+
+#ifndef ICP_H
+#define ICP_H
+
+#include <stdio.h>
+#include <time.h>
+
+#include "./cloud.h"
+#include "./horn.h"
+#include "./pyramid.h"
+
+#define ICP_PLANE 0
+#define ICP_SYMMETRIC 1
+#define ICP_POINT 2
+#define ICP_EPS 1e-10
+#define ICP_LEVEL_TOL 0.01
+#define ICP_KERNEL_NONE 0
+#define ICP_HUBER 1
+#define ICP_TUKEY 2
+#define ICP_HUBER_K 1.345
+#define ICP_TUKEY_K 4.685
+#define ICP_MAD 1.4826
+
+/**
+ * \brief Struct to report an iteration. The error is the mean distance of the
+ * numpairs pairs kept (nonzero weight) before the step and the timings are in
+ * seconds
+ */
+struct icp_iteration {
+	uint level;
+	uint iter;
+	uint numpts;
+	uint numpairs;
+	real error;
+	real change;
+	real match;
+	real solve;
+};
+
+/**
+ * \brief Function called after every iteration
+ * \param stats The iteration
+ * \param data User data of the engine
+ * \return 0 to stop the registration, or anything else to keep going
+ */
+typedef int (*icp_callback)(struct icp_iteration *stats, void *data);
+
+/**
+ * \brief Struct to store an engine. For the i-th point of source, pairs[i] is
+ * the position of its nearest point in target, dist[i] the squared distance
+ * between them, weights[i] the weight of the pair and moved[3 * i] its
+ * coordinates after rt. The flag stopped is set when the callback stops a
+ * registration. The robust options (see icp_set_robust) are trim, maxdist,
+ * kernel and scale; work and order are scratch for their residual quantiles
+ */
+struct icp {
+	int metric;
+	uint numpts;
+	uint *pairs;
+	real *dist;
+	real *weights;
+	real *work;
+	uint *order;
+	real *moved;
+	real trim;
+	real maxdist;
+	int kernel;
+	real scale;
+	struct rigid3 rt;
+	struct icp_iteration stats;
+	int stopped;
+	icp_callback callback;
+	void *data;
+};
+
+/**
+ * \brief Initializes an engine
+ * \param numpts Largest source it will register (it grows if needed)
+ * \param metric ICP_PLANE, ICP_SYMMETRIC or ICP_POINT
+ * \return Pointer to the new engine (rt is the identity) or NULL if it fails
+ */
+struct icp *icp_new(uint numpts, int metric);
+
+/**
+ * \brief Frees an engine
+ * \param icp Engine to be freed
+ */
+void icp_free(struct icp **icp);
+
+/**
+ * \brief Grows the buffers of an engine
+ * \param icp Target engine
+ * \param numpts Number of source points
+ * \return 1 if the buffers fit numpts, or 0 if it fails
+ */
+int icp_reserve(struct icp *icp, uint numpts);
+
+/**
+ * \brief Sets the function called after every iteration
+ * \param icp Target engine
+ * \param callback The function (NULL to remove it)
+ * \param data User data passed to callback
+ */
+void icp_set_callback(struct icp *icp, icp_callback callback, void *data);
+
+/**
+ * \brief Sets how the pairs of each iteration are weighted. The pairs farther
+ * than maxdist are dropped, then only the trim fraction of the closest ones is
+ * kept and the kernel weights the rest by their distance r: Huber gives
+ * min(1, c / r) and Tukey (1 - (r / c)^2)^2 up to c, with c = ICP_HUBER_K or
+ * ICP_TUKEY_K times the scale. Every step is linear on the number of pairs:
+ * the trim cut and the median are found by selection, not sorting
+ * \param icp Target engine
+ * \param trim Fraction of the pairs kept, in (0, 1] (1 keeps all)
+ * \param maxdist Largest distance of a pair (<= 0 keeps all)
+ * \param kernel ICP_KERNEL_NONE, ICP_HUBER or ICP_TUKEY
+ * \param scale Scale of the kernel (<= 0 estimates it every iteration as
+ * ICP_MAD times the median distance of the kept pairs)
+ */
+void icp_set_robust(struct icp *icp,
+                    real trim,
+                    real maxdist,
+                    int kernel,
+                    real scale);
+
+/**
+ * \brief Registers source with target starting from icp->rt, which holds the
+ * result afterwards. The kd-tree and normals of the clouds are built (once)
+ * before the first iteration. Each iteration pairs the points with their
+ * exact nearest neighbors and takes a step of the metric: point-to-point
+ * (Horn), point-to-plane or symmetric (the linearized 6x6 system of the
+ * distances along the normals). When the system is degenerate the iteration
+ * takes a point-to-point step instead. It stops early if no pair is kept
+ * \param icp Target engine
+ * \param source The source cloud
+ * \param target The target cloud
+ * \param t Stop criteria (change of the mean distance between iterations)
+ * \param k Maximum number of iterations
+ * \return 1 if it ran (even if the callback stopped it), or 0 if it fails
+ */
+int icp_run(struct icp *icp,
+            struct cloud *source,
+            struct cloud *target,
+            real t,
+            uint k);
+
+/**
+ * \brief Registers two pyramids coarse to fine, starting each finer level from
+ * the transform of the previous one. A sampled level cannot be registered
+ * below its voxel size, so it stops once the error changes less than
+ * ICP_LEVEL_TOL times its leaf size (or t, if larger)
+ * \param icp Target engine
+ * \param source Pyramid of the source cloud
+ * \param target Pyramid of the target cloud
+ * \param t Stop criteria of each level
+ * \param k Maximum number of iterations of each level
+ * \return 1 if it ran (even if the callback stopped it), or 0 if it fails
+ */
+int icp_run_pyramid(struct icp *icp,
+                    struct pyramid *source,
+                    struct pyramid *target,
+                    real t,
+                    uint k);
+
+/**
+ * \brief Debugs an engine (transform and last iteration)
+ * \param icp Target engine
+ * \param output File to output the debug in
+ */
+void icp_debug(struct icp *icp, FILE *output);
+
+#endif // ICP_H
+
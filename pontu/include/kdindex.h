@@ -0,0 +1,112 @@
+/**
+ * \file kdindex.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Static kd-tree over an array of points. Unlike the octree, queries
+ * are exact and answer with the position of the point in the array, so
+ * per-point data (normals, labels) can be looked up. The tree keeps its own
+ * copy of the coordinates, ordered so every leaf is contiguous.
+ */
+
+#ifndef KDINDEX_H
+#define KDINDEX_H
+
+#include <stdio.h>
+
+#include "./pointarray.h"
+
+#define KDINDEX_LEAFSIZE 8
+#define KDINDEX_NONE ((uint)-1)
+
+/**
+ * \brief Struct to store a node of the tree (leaf if axis is -1) and the
+ * bounding box of its points, which keeps queries far from the cloud cheap
+ */
+struct kdindex_node {
+	int axis;
+	real split;
+	real min[3];
+	real max[3];
+	uint begin;
+	uint end;
+	uint left;
+	uint right;
+};
+
+/**
+ * \brief Struct to store a kd-tree. Slot i of x, y and z holds the point at
+ * position ids[i] of the indexed array
+ */
+struct kdindex {
+	uint numpts;
+	uint numnodes;
+	real *x;
+	real *y;
+	real *z;
+	uint *ids;
+	struct kdindex_node *nodes;
+};
+
+/**
+ * \brief Builds a tree over an array of points (O(n log n))
+ * \param array Points to be indexed (not referenced after the call)
+ * \return Pointer to the new tree or NULL if it fails
+ */
+struct kdindex *kdindex_new(struct pointarray *array);
+
+/**
+ * \brief Frees a tree
+ * \param index Tree to be freed
+ */
+void kdindex_free(struct kdindex **index);
+
+/**
+ * \brief Finds the nearest point of the tree
+ * \param index Target tree
+ * \param p Coordinates (x, y, z) of the query
+ * \param dist Output squared distance to the nearest point (can be NULL)
+ * \return Position of the nearest point or KDINDEX_NONE if the tree is empty
+ */
+uint kdindex_nearest(struct kdindex *index, const real *p, real *dist);
+
+/**
+ * \brief Finds the k nearest points of the tree
+ * \param index Target tree
+ * \param p Coordinates (x, y, z) of the query
+ * \param k Number of neighbors
+ * \param ids Output positions (at least k), nearest first
+ * \param dist Output squared distances (at least k)
+ * \return Number of neighbors found (less than k only if the tree is smaller)
+ */
+uint kdindex_knn(struct kdindex *index,
+                 const real *p,
+                 uint k,
+                 uint *ids,
+                 real *dist);
+
+/**
+ * \brief Finds every point of the tree within a radius (unordered)
+ * \param index Target tree
+ * \param p Coordinates (x, y, z) of the query
+ * \param radius Radius of the search
+ * \param ids Output positions
+ * \param dist Output squared distances (can be NULL)
+ * \param max Capacity of ids and dist
+ * \return Number of points in the radius (only the first max are stored)
+ */
+uint kdindex_radius(struct kdindex *index,
+                    const real *p,
+                    real radius,
+                    uint *ids,
+                    real *dist,
+                    uint max);
+
+/**
+ * \brief Debugs a tree
+ * \param index Target tree
+ * \param output File to output the debug in
+ */
+void kdindex_debug(struct kdindex *index, FILE *output);
+
+#endif // KDINDEX_H
+
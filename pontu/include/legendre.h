@@ -13,6 +13,7 @@
 
 #include "./cloud.h"
 #include "./dataframe.h"
+#include "./momentcfg.h"
 
 /**
  * \brief Calculates Legendre polynomial
@@ -22,6 +23,14 @@
  */
 real legendre_poly(int n, real x);
 
+/**
+ * \brief Calculates every Legendre polynomial up to an order
+ * \param n Maximum polynomial order
+ * \param x Polynomial argument
+ * \param table Output with n + 1 polynomials of x (orders 0 to n)
+ */
+void legendre_poly_table(int n, real x, real *table);
+
 /**
  * \brief Calculates normalized coordinate of Legendre
  * \param c Original coordinate value
@@ -51,11 +60,20 @@ real legendre_norm(int p, int q, int r, struct cloud *cloud);
 real legendre_moment(int p, int q, int r, struct cloud *cloud);
 
 /**
- * \brief Calculates Legendre moments of a cloud
+ * \brief Calculates Legendre moments of a cloud (current configuration)
  * \param cloud Target cloud
  * \return Matrix with the moments
  */
 struct dataframe *legendre_cloud_moments(struct cloud *cloud);
 
+/**
+ * \brief Calculates Legendre moments of a cloud in a single pass
+ * \param cloud Target cloud
+ * \param cfg Moment orders (cfg->legendre)
+ * \return Matrix with the (order + 1)^3 moments
+ */
+struct dataframe *legendre_cloud_moments_cfg(struct cloud *cloud,
+                                             struct momentcfg *cfg);
+
 #endif // LEGENDRE_H
 
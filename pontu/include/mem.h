@@ -0,0 +1,154 @@
+/**
+ * \file mem.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Allocation hook of the point containers and indexes. Every block goes
+ * through a pluggable allocator (malloc by default) and is accounted in its
+ * subsystem: live bytes, peak, allocations, frees and failures. A limit on the
+ * live bytes makes oversized requests fail (NULL) instead of exhausting the
+ * machine.
+ */
+
+#ifndef MEM_H
+#define MEM_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "./profile.h"
+
+#define MEM_POINTSET 0
+#define MEM_VECTOR3 1
+#define MEM_POINTARRAY 2
+#define MEM_KDINDEX 3
+#define MEM_KDTREE 4
+#define MEM_OCTREE 5
+#define MEM_DATAFRAME 6
+#define MEM_VOXELGRID 7
+#define MEM_ATTRIB 8
+#define MEM_NUMSUBSYSTEMS 9
+#define MEM_TABLE 0
+#define MEM_JSON 1
+
+/**
+ * \brief Struct to store an allocator. Blocks are released with the size they
+ * were requested with, so pools need no headers
+ */
+struct mem_allocator {
+	void *(*alloc)(size_t size, size_t align, void *data);
+	void *(*resize)(void *ptr, size_t oldsize, size_t size, void *data);
+	void (*release)(void *ptr, size_t size, void *data);
+	void *data;
+};
+
+/**
+ * \brief Struct to store the accounting of a subsystem
+ */
+struct mem_stats {
+	atomic_size_t live;
+	atomic_size_t peak;
+	atomic_uint_fast64_t allocs;
+	atomic_uint_fast64_t frees;
+	atomic_uint_fast64_t failures;
+};
+
+/**
+ * \brief Allocates a block
+ * \param subsystem Subsystem to account it in
+ * \param size Number of bytes
+ * \return The block or NULL if it fails or goes over the limit
+ */
+void *mem_alloc(int subsystem, size_t size);
+
+/**
+ * \brief Allocates a block of zeros
+ * \param subsystem Subsystem to account it in
+ * \param num Number of elements
+ * \param size Size of each element
+ * \return The block or NULL if it fails, overflows or goes over the limit
+ */
+void *mem_calloc(int subsystem, size_t num, size_t size);
+
+/**
+ * \brief Allocates an aligned block
+ * \param subsystem Subsystem to account it in
+ * \param align Alignment (a power of two dividing size)
+ * \param size Number of bytes
+ * \return The block or NULL if it fails or goes over the limit
+ */
+void *mem_aligned(int subsystem, size_t align, size_t size);
+
+/**
+ * \brief Resizes a block (allocates it if ptr is NULL)
+ * \param subsystem Subsystem it is accounted in
+ * \param ptr Target block
+ * \param oldsize Size it was requested with
+ * \param size New size
+ * \return The block or NULL if it fails (ptr is still valid then)
+ */
+void *mem_realloc(int subsystem, void *ptr, size_t oldsize, size_t size);
+
+/**
+ * \brief Releases a block (NULL is ignored)
+ * \param subsystem Subsystem it is accounted in
+ * \param ptr Target block
+ * \param size Size it was requested with
+ */
+void mem_free(int subsystem, void *ptr, size_t size);
+
+/**
+ * \brief Replaces the allocator. It must be done while no block is live
+ * \param allocator The new allocator or NULL to restore malloc
+ */
+void mem_set_allocator(const struct mem_allocator *allocator);
+
+/**
+ * \brief Limits the live bytes of every subsystem together
+ * \param bytes The limit or 0 to remove it
+ */
+void mem_set_limit(size_t bytes);
+
+/**
+ * \brief Gets the accounting of a subsystem
+ * \param subsystem Target subsystem
+ * \return The accounting or NULL if the subsystem is unknown
+ */
+struct mem_stats *mem_get(int subsystem);
+
+/**
+ * \brief Gets the live bytes of every subsystem together
+ * \return Number of bytes
+ */
+size_t mem_live();
+
+/**
+ * \brief Gets the peak of the live bytes of every subsystem together
+ * \return Number of bytes
+ */
+size_t mem_peak();
+
+/**
+ * \brief Gets the name of a subsystem
+ * \param subsystem Target subsystem
+ * \return The name or NULL if the subsystem is unknown
+ */
+const char *mem_name(int subsystem);
+
+/**
+ * \brief Zeroes the counters of every subsystem and brings the peaks down to
+ * the live bytes
+ */
+void mem_reset();
+
+/**
+ * \brief Reports the accounting of every subsystem used and the total
+ * \param output File to output the report in
+ * \param format MEM_TABLE or MEM_JSON
+ */
+void mem_report(FILE *output, int format);
+
+#endif // MEM_H
+
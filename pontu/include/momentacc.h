@@ -0,0 +1,167 @@
+/**
+ * \file momentacc.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Incremental accumulators of geometric moments. Points can be added
+ * and removed in O(1) (for a fixed order) and the central, normalized and
+ * Legendre moments are derived on demand from the raw sums.
+ */
+
+#ifndef MOMENTACC_H
+#define MOMENTACC_H
+
+#include <stdio.h>
+
+#include "./cloud.h"
+#include "./cloudview.h"
+#include "./dataframe.h"
+#include "./momentcfg.h"
+
+/**
+ * \brief Struct to store the raw sums S(p, q, r) of (x - ox)^p * (y - oy)^q *
+ * (z - oz)^r for p, q, r in [0, order]. The origin o is the first point added
+ * to the empty accumulator, which keeps the sums well conditioned for clouds
+ * far from (0, 0, 0)
+ */
+struct momentacc {
+	int order;
+	uint numpts;
+	real origin[3];
+	real *sums;
+	real *binom;
+	real *legendre;
+};
+
+/**
+ * \brief Initializes an empty accumulator
+ * \param order Maximum order of each dimension (0 to MOMENTCFG_MAXORD)
+ * \return Pointer to the new accumulator or NULL if it fails
+ */
+struct momentacc *momentacc_new(int order);
+
+/**
+ * \brief Frees an accumulator
+ * \param acc Accumulator to be freed
+ */
+void momentacc_free(struct momentacc **acc);
+
+/**
+ * \brief Removes every point from an accumulator
+ * \param acc Target accumulator
+ */
+void momentacc_reset(struct momentacc *acc);
+
+/**
+ * \brief Adds a point to an accumulator
+ * \param acc Target accumulator
+ * \param point Point to be added
+ */
+void momentacc_add(struct momentacc *acc, struct vector3 *point);
+
+/**
+ * \brief Removes a point previously added to an accumulator (removing the
+ * last point clears the sums exactly). Repeated
+ * additions and removals accumulate rounding error, so long running windows
+ * should be rebuilt from time to time (momentacc_reset + momentacc_add_cloud)
+ * \param acc Target accumulator
+ * \param point Point to be removed
+ */
+void momentacc_remove(struct momentacc *acc, struct vector3 *point);
+
+/**
+ * \brief Adds every point of a cloud to an accumulator
+ * \param acc Target accumulator
+ * \param cloud Cloud with the points to be added
+ */
+void momentacc_add_cloud(struct momentacc *acc, struct cloud *cloud);
+
+/**
+ * \brief Removes every point of a cloud from an accumulator
+ * \param acc Target accumulator
+ * \param cloud Cloud with the points to be removed
+ */
+void momentacc_remove_cloud(struct momentacc *acc, struct cloud *cloud);
+
+/**
+ * \brief Adds every point of a view to an accumulator, without copying them
+ * \param acc Target accumulator
+ * \param view View with the points to be added
+ */
+void momentacc_add_view(struct momentacc *acc, struct cloudview *view);
+
+/**
+ * \brief Gets a raw moment (sum of x^p * y^q * z^r)
+ * \param acc Target accumulator
+ * \param p Order of dimension x
+ * \param q Order of dimension y
+ * \param r Order of dimension z
+ * \return Raw moment p+q+r
+ */
+real momentacc_raw(struct momentacc *acc, int p, int q, int r);
+
+/**
+ * \brief Calculates the centroid of the accumulated points
+ * \param acc Target accumulator
+ * \return Pointer to the centroid or NULL if the accumulator is empty
+ */
+struct vector3 *momentacc_centroid(struct momentacc *acc);
+
+/**
+ * \brief Calculates a central moment from the raw sums (unweighted, unlike
+ * hu_central_moment())
+ * \param acc Target accumulator
+ * \param p Order of dimension x
+ * \param q Order of dimension y
+ * \param r Order of dimension z
+ * \return Central moment p+q+r
+ */
+real momentacc_central(struct momentacc *acc, int p, int q, int r);
+
+/**
+ * \brief Calculates a scale normalized central moment, with the number of
+ * points as the zero order moment. Unlike hu_normalized_moment(), it is not
+ * weighted by the distance to the centroid (that weight doesn't reduce to raw
+ * sums), so the values differ
+ * \param acc Target accumulator
+ * \param p Order of dimension x
+ * \param q Order of dimension y
+ * \param r Order of dimension z
+ * \return Normalized moment p+q+r
+ */
+real momentacc_normalized(struct momentacc *acc, int p, int q, int r);
+
+/**
+ * \brief Calculates every central moment up to the accumulator order
+ * \param acc Target accumulator
+ * \return Matrix with the (order + 1)^3 moments (p-major, like legendre)
+ */
+struct dataframe *momentacc_central_moments(struct momentacc *acc);
+
+/**
+ * \brief Calculates the 3D Hu (1980) invariants J1, J2 and J3 (needs order 2)
+ * from unweighted normalized moments. The formulas are those of
+ * hu_cloud_moments_hu1980(), but its moments are weighted by the distance to
+ * the centroid, so the two don't return the same values
+ * \param acc Target accumulator
+ * \return Matrix with the 3 invariants or NULL if the order is too low
+ */
+struct dataframe *momentacc_hu1980(struct momentacc *acc);
+
+/**
+ * \brief Calculates the Legendre moments of the centered points from the
+ * central moments. Unlike legendre_cloud_moments(), they are not weighted by
+ * the distance to the centroid (that weight doesn't reduce to raw sums)
+ * \param acc Target accumulator
+ * \return Matrix with the (order + 1)^3 moments
+ */
+struct dataframe *momentacc_legendre_moments(struct momentacc *acc);
+
+/**
+ * \brief Debugs an accumulator
+ * \param acc Target accumulator
+ * \param output File to output the debug in
+ */
+void momentacc_debug(struct momentacc *acc, FILE *output);
+
+#endif // MOMENTACC_H
+
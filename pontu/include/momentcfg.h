@@ -0,0 +1,75 @@
+/**
+ * \file momentcfg.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Runtime configuration of the moment orders.
+ */
+
+#ifndef MOMENTCFG_H
+#define MOMENTCFG_H
+
+#include <stdio.h>
+
+#include "./calc.h"
+
+#define MOMENTCFG_MAXORD 32
+#define MOMENTCFG_SEP ","
+
+#if defined(__GNUC__)
+#define MOMENTCFG_UNROLL _Pragma("GCC unroll 16")
+#else
+#define MOMENTCFG_UNROLL
+#endif
+
+/**
+ * \brief Struct to store the orders used by every moment family
+ */
+struct momentcfg {
+	int legendre;
+	int chebyshev[3];
+	int spheric[3];
+	int zernike_ord;
+	int zernike_rep;
+	int harmon_ord;
+	int harmon_rep;
+	int harmon_spin;
+};
+
+/**
+ * \brief Fills a configuration with the compile-time defaults (ZERNIKE_ORD,
+ * HARMON_ORD, LEGENDRE_ORDER, CHEBYSHEV_ORDER_*, SPHERIC_ORDER_*)
+ * \param cfg Target configuration
+ */
+void momentcfg_default(struct momentcfg *cfg);
+
+/**
+ * \brief Gets the configuration used by the *_cloud_moments() functions
+ * \return Pointer to the current configuration
+ */
+struct momentcfg *momentcfg_current();
+
+/**
+ * \brief Replaces the configuration used by the *_cloud_moments() functions
+ * (not thread safe: set it before extracting in parallel)
+ * \param cfg New configuration (NULL restores the defaults)
+ */
+void momentcfg_set(struct momentcfg *cfg);
+
+/**
+ * \brief Parses a list of orders into a configuration
+ * \param cfg Configuration to be modified (fields not in spec are kept)
+ * \param spec List like "legendre=3,chebyshev=2:2:4,zernike=10:8,
+ * harmonics=5:5:5,spheric=3" (missing values repeat the last one given)
+ * \return 1 if the whole list was parsed, or 0 if not
+ */
+int momentcfg_parse(struct momentcfg *cfg, const char *spec);
+
+/**
+ * \brief Debugs a configuration
+ * \param cfg Target configuration
+ * \param output File to output the debug in
+ */
+void momentcfg_debug(struct momentcfg *cfg, FILE *output);
+
+#endif // MOMENTCFG_H
+
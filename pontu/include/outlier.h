@@ -0,0 +1,81 @@
+/**
+ * \file outlier.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Outlier removal for raw scans: statistical (mean distance to the k
+ * nearest neighbors against the spread of the whole cloud) and radius (minimum
+ * number of neighbors within a radius). The neighbors come from the kd-tree of
+ * the cloud and the points are split across threads.
+ */
+
+#ifndef OUTLIER_H
+#define OUTLIER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "./cloud.h"
+#include "./cloudview.h"
+#include "./kdindex.h"
+#include "./parallel.h"
+
+/**
+ * \brief Computes, for every point, the mean distance to its k nearest
+ * neighbors (the point itself not counted)
+ * \param cloud Target cloud
+ * \param k Number of neighbors (at least 1)
+ * \param dist Output with the mean distances in the order of cloud_pack()
+ * (room for the number of points)
+ * \return 1 if it succeeds or 0 if it fails
+ */
+int outlier_mean_distances(struct cloud *cloud, uint k, real *dist);
+
+/**
+ * \brief Statistical outlier removal: a point is kept if its mean distance to
+ * its k nearest neighbors is at most the mean of these distances over the
+ * cloud plus sigma standard deviations (O(n k log n))
+ * \param cloud Target cloud
+ * \param k Number of neighbors (at least 1)
+ * \param sigma Number of standard deviations tolerated
+ * \return View with the positions of the kept points in increasing order or
+ * NULL if it fails
+ */
+struct cloudview *outlier_statistical(struct cloud *cloud, uint k, real sigma);
+
+/**
+ * \brief Radius outlier removal: a point is kept if at least minpts other
+ * points lie within radius of it
+ * \param cloud Target cloud
+ * \param radius Radius of the search
+ * \param minpts Minimum number of neighbors
+ * \return View with the positions of the kept points in increasing order or
+ * NULL if it fails
+ */
+struct cloudview *outlier_radius(struct cloud *cloud, real radius, uint minpts);
+
+/**
+ * \brief Removes the outliers of a cloud by outlier_statistical()
+ * \param cloud Target cloud
+ * \param k Number of neighbors (at least 1)
+ * \param sigma Number of standard deviations tolerated
+ * \return The new cloud (with the channels of the points kept) or NULL if it
+ * fails
+ */
+struct cloud *outlier_filter_statistical(struct cloud *cloud,
+                                         uint k,
+                                         real sigma);
+
+/**
+ * \brief Removes the outliers of a cloud by outlier_radius()
+ * \param cloud Target cloud
+ * \param radius Radius of the search
+ * \param minpts Minimum number of neighbors
+ * \return The new cloud (with the channels of the points kept) or NULL if it
+ * fails
+ */
+struct cloud *outlier_filter_radius(struct cloud *cloud,
+                                    real radius,
+                                    uint minpts);
+
+#endif // OUTLIER_H
+
@@ -0,0 +1,117 @@
+/**
+ * \file parallel.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Minimal parallel loop over C11 threads. The PONTU_THREADS environment
+ * variable sets how many threads are used (the online cores by default).
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stdlib.h>
+#include <threads.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "./calc.h"
+#include "./profile.h"
+
+#define PARALLEL_ENV "PONTU_THREADS"
+#define PARALLEL_MAXTHREADS 256
+
+/**
+ * \brief Body of a parallel loop
+ * \param i Iteration to run
+ * \param thread Index of the thread running it (below the number of threads),
+ * so per-thread buffers can be indexed without locks
+ * \param data User data of the loop
+ */
+typedef void (*parallel_func)(uint i, uint thread, void *data);
+
+/**
+ * \brief Struct to store a loop being run: iterations are taken from next
+ */
+struct parallel_loop {
+	uint n;
+	atomic_uint next;
+	parallel_func func;
+	void *data;
+};
+
+/**
+ * \brief Struct to store a thread of a loop (team is NULL out of a team)
+ */
+struct parallel_worker {
+	struct parallel_loop *loop;
+	struct parallel_team *team;
+	uint thread;
+};
+
+/**
+ * \brief Struct to store a team: threads kept alive across many short loops,
+ * so each loop costs two wakeups instead of creating and joining threads.
+ * Rounds start when generation changes and end when pending drops to 0
+ */
+struct parallel_team {
+	uint numthreads;
+	uint generation;
+	uint pending;
+	int quit;
+	mtx_t lock;
+	cnd_t start;
+	cnd_t done;
+	struct parallel_loop loop;
+	struct parallel_worker workers[PARALLEL_MAXTHREADS];
+	thrd_t threads[PARALLEL_MAXTHREADS];
+};
+
+/**
+ * \brief Gets the default number of threads (PONTU_THREADS or the online cores)
+ * \return Number of threads, at least 1
+ */
+uint parallel_threads();
+
+/**
+ * \brief Runs func for every i in [0, n) across threads. Iterations are handed
+ * out one at a time from an atomic counter, so uneven ones balance themselves,
+ * and the calling thread works as thread 0. If a thread can't be started the
+ * others run its share
+ * \param n Number of iterations
+ * \param numthreads Number of threads (0 uses parallel_threads())
+ * \param func Body of the loop
+ * \param data User data passed to func
+ * \return Number of threads actually used
+ */
+uint parallel_for(uint n, uint numthreads, parallel_func func, void *data);
+
+/**
+ * \brief Starts a team of threads (the calling thread is thread 0 of every
+ * loop, so numthreads - 1 are created)
+ * \param numthreads Number of threads (0 uses parallel_threads())
+ * \return Pointer to the new team or NULL if it fails (if only some threads
+ * start, the team runs with those)
+ */
+struct parallel_team *parallel_team_new(uint numthreads);
+
+/**
+ * \brief Stops and frees a team
+ * \param team Team to be freed
+ */
+void parallel_team_free(struct parallel_team **team);
+
+/**
+ * \brief Runs func for every i in [0, n) across the threads of a team, like
+ * parallel_for(), and returns when every iteration is done
+ * \param team Target team (one loop at a time)
+ * \param n Number of iterations
+ * \param func Body of the loop
+ * \param data User data passed to func
+ */
+void parallel_team_run(struct parallel_team *team,
+                       uint n,
+                       parallel_func func,
+                       void *data);
+
+#endif // PARALLEL_H
+
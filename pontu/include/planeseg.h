@@ -0,0 +1,104 @@
+/**
+ * \file planeseg.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief RANSAC plane segmentation. Hypotheses come from 3 random points, their
+ * inliers are counted by vectorized passes over the packed coordinates (cut
+ * short once a hypothesis can no longer win) and the number of iterations
+ * adapts to the best inlier ratio found. Planes are peeled off one after the
+ * other, so walls and tables can be stripped before feature extraction.
+ */
+
+#ifndef PLANESEG_H
+#define PLANESEG_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "./calc.h"
+#include "./plane.h"
+#include "./cloud.h"
+#include "./cloudview.h"
+#include "./simd.h"
+
+#define PLANESEG_CONFIDENCE 0.99
+#define PLANESEG_MAXITER 1000
+#define PLANESEG_CHUNK 4096
+
+/**
+ * \brief Struct to store the planes found in a cloud. inliers[i] holds the
+ * points of planes[i] and rest the points left in no plane, all of them views
+ * of the cloud with positions in increasing order
+ */
+struct planeseg {
+	struct cloud *cloud;
+	uint numplanes;
+	struct plane **planes;
+	struct cloudview **inliers;
+	struct cloudview *rest;
+};
+
+/**
+ * \brief Finds up to maxplanes planes, each one the biggest plane of the points
+ * left by the previous ones, refined by least squares over its inliers. Stops
+ * at the first plane with fewer than minpts inliers (at most PLANESEG_MAXITER
+ * hypotheses per plane)
+ * \param cloud Target cloud (not owned; must not be modified while the planes
+ * are used)
+ * \param threshold Maximum distance from an inlier to its plane
+ * \param minpts Minimum number of inliers of a plane (at least 3)
+ * \param maxplanes Maximum number of planes
+ * \param seed Seed of the sampling (same seed, same planes)
+ * \return Pointer to the planes or NULL if it fails
+ */
+struct planeseg *planeseg_extract(struct cloud *cloud,
+                                  real threshold,
+                                  uint minpts,
+                                  uint maxplanes,
+                                  uint64_t seed);
+
+/**
+ * \brief Frees the planes and their views (the cloud is kept)
+ * \param seg Planes to be freed
+ */
+void planeseg_free(struct planeseg **seg);
+
+/**
+ * \brief Finds the biggest plane of a cloud
+ * \param cloud Target cloud
+ * \param threshold Maximum distance from an inlier to the plane
+ * \param seed Seed of the sampling
+ * \param plane Output plane (can be NULL; freed by plane_free)
+ * \return View with the positions of the inliers in increasing order or NULL
+ * if it fails or the cloud has fewer than 3 points
+ */
+struct cloudview *planeseg_largest(struct cloud *cloud,
+                                   real threshold,
+                                   uint64_t seed,
+                                   struct plane **plane);
+
+/**
+ * \brief Strips the planes of a cloud (background walls, tables and floors)
+ * \param cloud Target cloud
+ * \param threshold Maximum distance from an inlier to its plane
+ * \param minpts Minimum number of inliers of a plane (at least 3)
+ * \param maxplanes Maximum number of planes
+ * \param seed Seed of the sampling
+ * \return The new cloud with the points in no plane (channels kept) or NULL
+ * if it fails
+ */
+struct cloud *planeseg_strip(struct cloud *cloud,
+                             real threshold,
+                             uint minpts,
+                             uint maxplanes,
+                             uint64_t seed);
+
+/**
+ * \brief Debugs the planes
+ * \param seg Target planes
+ * \param output File to output the debug in
+ */
+void planeseg_debug(struct planeseg *seg, FILE *output);
+
+#endif // PLANESEG_H
+
@@ -0,0 +1,59 @@
+/**
+ * \file pointarray.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Contiguous (structure of arrays) copy of a set of points, used by the
+ * vectorized reductions.
+ */
+
+#ifndef POINTARRAY_H
+#define POINTARRAY_H
+
+#include <stdio.h>
+
+#include "./vector3.h"
+#include "./pointset.h"
+
+#define POINTARRAY_ALIGN 64
+
+/**
+ * \brief Struct to store the coordinates of a set of points in three aligned
+ * arrays, plus the point each entry was copied from
+ */
+struct pointarray {
+	real *x;
+	real *y;
+	real *z;
+	struct vector3 **refs;
+	uint numpts;
+};
+
+/**
+ * \brief Initializes an array of points (coordinates are not initialized)
+ * \param numpts Number of points
+ * \return Pointer to the new array or NULL if it fails to allocate memory
+ */
+struct pointarray *pointarray_new(uint numpts);
+
+/**
+ * \brief Frees an array of points
+ * \param array Array to be freed
+ */
+void pointarray_free(struct pointarray **array);
+
+/**
+ * \brief Copies a set of points into a new array (same order as the set)
+ * \param set Target set
+ * \return Pointer to the new array or NULL if it fails to allocate memory
+ */
+struct pointarray *pointarray_from_pointset(struct pointset *set);
+
+/**
+ * \brief Debugs an array of points
+ * \param array Target array
+ * \param output File to output the debug in
+ */
+void pointarray_debug(struct pointarray *array, FILE *output);
+
+#endif // POINTARRAY_H
+
@@ -9,6 +9,7 @@
 #define POINTSET_H
 
 #include "./vector3.h"
+#include "./mem.h"
 
 /**
  * @TODO
@@ -0,0 +1,214 @@
+/**
+ * \file profile.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Optional instrumentation of the hot paths: scoped timers and counters
+ * per stage, and a timeline of the scopes of every thread in the trace event
+ * format (chrome://tracing, Perfetto). It is compiled in only with
+ * PONTU_PROFILE defined (make PROFILE=1); otherwise every PROFILE_* macro
+ * expands to nothing. The timeline is recorded while a trace is open, either
+ * by profile_trace_open or by naming its file in PONTU_TRACE.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define PROFILE_LOAD 0
+#define PROFILE_PARTITION 1
+#define PROFILE_NN 2
+#define PROFILE_MOMENT 3
+#define PROFILE_CUT 4
+#define PROFILE_ICP 5
+#define PROFILE_OTHER 6
+#define PROFILE_NUMSTAGES 7
+#define PROFILE_NONE -1
+#define PROFILE_TABLE 0
+#define PROFILE_JSON 1
+#define PROFILE_TRACE_ENV "PONTU_TRACE"
+#define PROFILE_TRACE_MINEVENTS 1024
+#define PROFILE_TRACE_MAXEVENTS 1048576
+
+/**
+ * \brief Struct to store an open scope: its stage, the stage it is nested in,
+ * its name in the timeline (NULL leaves it out), when it started (nanoseconds)
+ * and the points it processed
+ */
+struct profile_scope {
+	int stage;
+	int outer;
+	const char *name;
+	uint64_t start;
+	uint64_t points;
+};
+
+/**
+ * \brief Struct to store a span of the timeline
+ */
+struct profile_event {
+	const char *name;
+	int stage;
+	uint64_t start;
+	uint64_t duration;
+};
+
+/**
+ * \brief Struct to store the spans recorded by a thread. Only its thread
+ * writes to it, so recording takes no locks
+ */
+struct profile_trace {
+	struct profile_event *events;
+	uint32_t numevents;
+	uint32_t capacity;
+	uint32_t thread;
+	uint64_t dropped;
+	struct profile_trace *next;
+};
+
+/**
+ * \brief Struct to store the counters of a stage
+ */
+struct profile_stage {
+	atomic_uint_fast64_t calls;
+	atomic_uint_fast64_t nanos;
+	atomic_uint_fast64_t points;
+	atomic_uint_fast64_t bytes;
+};
+
+#ifdef PONTU_PROFILE
+
+/**
+ * \brief Times the rest of the enclosing block as a call of a stage (one per
+ * block), named after the enclosing function in the timeline. A scope inside
+ * another one of the same stage is not counted, and the time of a stage
+ * includes the stages nested in it
+ */
+#define PROFILE_SCOPE(stage)                                                   \
+	struct profile_scope profile_scope_                                        \
+	__attribute__((cleanup(profile_end))) = profile_begin(stage, __func__)
+
+/**
+ * \brief Like PROFILE_SCOPE, but left out of the timeline: for calls too fine
+ * to draw one by one (a single nearest neighbor query). Their batches should
+ * open a PROFILE_SPAN instead
+ */
+#define PROFILE_QUERY(stage)                                                   \
+	struct profile_scope profile_scope_                                        \
+	__attribute__((cleanup(profile_end))) = profile_begin(stage, NULL)
+
+/**
+ * \brief Draws the rest of the enclosing block in the timeline (one per block)
+ * without counting it in any stage
+ */
+#define PROFILE_SPAN(name)                                                     \
+	struct profile_scope profile_span_                                         \
+	__attribute__((cleanup(profile_end))) = profile_begin(PROFILE_NONE, name)
+
+/**
+ * \brief Adds points processed to the scope of the enclosing block
+ */
+#define PROFILE_POINTS(n) (profile_scope_.points += (n))
+
+/**
+ * \brief Adds bytes allocated to the innermost open stage of the thread
+ */
+#define PROFILE_BYTES(n) profile_bytes(n)
+
+#else
+
+#define PROFILE_SCOPE(stage) ((void)0)
+#define PROFILE_QUERY(stage) ((void)0)
+#define PROFILE_SPAN(name) ((void)0)
+#define PROFILE_POINTS(n) ((void)0)
+#define PROFILE_BYTES(n) ((void)0)
+
+#endif
+
+/**
+ * \brief Opens a scope (use PROFILE_SCOPE, PROFILE_QUERY or PROFILE_SPAN
+ * instead)
+ * \param stage Stage of the scope (PROFILE_NONE counts it in no stage)
+ * \param name Name of the scope in the timeline (NULL leaves it out)
+ * \return The open scope
+ */
+struct profile_scope profile_begin(int stage, const char *name);
+
+/**
+ * \brief Closes a scope, adds it to its stage and records it in the timeline
+ * if a trace is open (use PROFILE_SCOPE, PROFILE_QUERY or PROFILE_SPAN
+ * instead)
+ * \param scope Target scope
+ */
+void profile_end(struct profile_scope *scope);
+
+/**
+ * \brief Adds bytes allocated to the innermost open stage of the calling
+ * thread (PROFILE_OTHER if there is none)
+ * \param bytes Number of bytes
+ */
+void profile_bytes(uint64_t bytes);
+
+/**
+ * \brief Checks if the library was compiled with PONTU_PROFILE
+ * \return 1 if it was, or 0 if not
+ */
+int profile_enabled();
+
+/**
+ * \brief Gets the name of a stage
+ * \param stage Target stage
+ * \return The name or NULL if the stage is unknown
+ */
+const char *profile_name(int stage);
+
+/**
+ * \brief Gets the counters of a stage
+ * \param stage Target stage
+ * \return The counters or NULL if the stage is unknown
+ */
+struct profile_stage *profile_get(int stage);
+
+/**
+ * \brief Zeroes the counters of every stage
+ */
+void profile_reset();
+
+/**
+ * \brief Reports the counters of every stage used: calls, wall time
+ * (seconds), points and bytes
+ * \param output File to output the report in
+ * \param format PROFILE_TABLE or PROFILE_JSON
+ */
+void profile_report(FILE *output, int format);
+
+/**
+ * \brief Starts recording the timeline of every thread, to be saved in a file
+ * by profile_trace_close. Each thread keeps up to PROFILE_TRACE_MAXEVENTS
+ * spans and counts the ones dropped after that
+ * \param filename Path to the trace file (JSON)
+ * \return 1 if the trace was opened, or 0 if one is already open or the
+ * library was compiled without PONTU_PROFILE
+ */
+int profile_trace_open(const char *filename);
+
+/**
+ * \brief Stops recording and saves the timeline in the trace event format. It
+ * must be called once the threads being traced are done
+ * \return 1 if the file was saved, or 0 if no trace is open or it fails
+ */
+int profile_trace_close();
+
+/**
+ * \brief Checks if a trace is open
+ * \return 1 if it is, or 0 if not
+ */
+int profile_tracing();
+
+#endif // PROFILE_H
+
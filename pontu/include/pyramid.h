@@ -0,0 +1,54 @@
+/**
+ * \file pyramid.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Multi-resolution pyramids of a cloud built with voxelgrid sampling,
+ * used by the coarse-to-fine registration.
+ */
+
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include <stdio.h>
+
+#include "./cloud.h"
+#include "./voxelgrid.h"
+
+#define PYRAMID_RESOLUTION 128.0
+
+/**
+ * \brief Struct to store a pyramid. Level 0 is the original cloud (not owned)
+ * and level i > 0 samples level i - 1 with leafsizes[i], which doubles at every
+ * level. Each level keeps its own kd-tree and normals once they are built
+ */
+struct pyramid {
+	uint numlevels;
+	real *leafsizes;
+	struct cloud **levels;
+};
+
+/**
+ * \brief Builds a pyramid of a cloud
+ * \param cloud Original cloud (must outlive the pyramid)
+ * \param numlevels Number of levels (1 is just the original cloud)
+ * \param leafsize Voxel size of level 1 (<= 0 uses the diagonal of the
+ * bounding box divided by PYRAMID_RESOLUTION)
+ * \return Pointer to the new pyramid or NULL if it fails
+ */
+struct pyramid *pyramid_new(struct cloud *cloud, uint numlevels, real leafsize);
+
+/**
+ * \brief Frees a pyramid (the original cloud is kept)
+ * \param pyr Pyramid to be freed
+ */
+void pyramid_free(struct pyramid **pyr);
+
+/**
+ * \brief Debugs a pyramid
+ * \param pyr Target pyramid
+ * \param output File to output the debug in
+ */
+void pyramid_debug(struct pyramid *pyr, FILE *output);
+
+#endif // PYRAMID_H
+
@@ -0,0 +1,51 @@
+/**
+ * \file ransac.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Global initial alignment of two clouds from FPFH correspondences with
+ * RANSAC. Its transform is a starting point for ICP, which only converges
+ * locally.
+ */
+
+#ifndef RANSAC_H
+#define RANSAC_H
+
+#include <stdio.h>
+
+#include "./cloud.h"
+#include "./horn.h"
+#include "./fpfh.h"
+#include "./parallel.h"
+
+#define RANSAC_ITERATIONS 20000
+#define RANSAC_EDGE 0.9
+#define RANSAC_MINPAIRS 16
+
+/**
+ * \brief Aligns source with target. Each point of source is paired with the
+ * point of target with the nearest descriptor, keeping only mutual pairs (all
+ * pairs if there are less than RANSAC_MINPAIRS mutual ones). Every iteration
+ * samples 3 pairs, skips them unless their triangles have matching sides (by
+ * RANSAC_EDGE), solves them and counts the pairs closer than threshold after
+ * the transform. The best hypothesis is refined with all its inliers
+ * \param source The source cloud
+ * \param target The target cloud
+ * \param fs Descriptors of source
+ * \param ft Descriptors of target
+ * \param threshold Largest distance of an inlier
+ * \param iterations Number of hypotheses (RANSAC_ITERATIONS is a good start)
+ * \param seed Seed of the random generator (same seed, same result)
+ * \param rt Output transform (identity if it fails)
+ * \return Number of inliers of rt (0 if it fails)
+ */
+uint ransac_align(struct cloud *source,
+                  struct cloud *target,
+                  struct fpfh *fs,
+                  struct fpfh *ft,
+                  real threshold,
+                  uint iterations,
+                  uint64_t seed,
+                  struct rigid3 *rt);
+
+#endif // RANSAC_H
+
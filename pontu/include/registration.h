@@ -9,6 +9,17 @@
 #define REGISTRATION_H
 
 #include "./cloud.h"
+#include "./horn.h"
+#include "./pyramid.h"
+#include "./icp.h"
+#include "./fpfh.h"
+#include "./ransac.h"
+
+#define REGISTRATION_PLANE ICP_PLANE
+#define REGISTRATION_SYMMETRIC ICP_SYMMETRIC
+#define REGISTRATION_POINT ICP_POINT
+#define REGISTRATION_GLOBAL_LEVELS 3
+#define REGISTRATION_GLOBAL_INLIER 2.0
 
 typedef struct cloud *(*closest_points_func)(struct cloud *, struct cloud *);
 
@@ -30,6 +41,33 @@ struct cloud *registration_closest_points_bf(struct cloud *source,
 struct cloud *registration_closest_points_tree(struct cloud *source,
                                                struct cloud *target);
 
+/**
+ * \brief Finds the rigid transform of weighted correspondences (the i-th point
+ * of source goes with the i-th point of target) without touching the heap
+ * \param source The source cloud
+ * \param target The target cloud
+ * \param weights Weight of each pair (NULL weights every pair with 1)
+ * \param rt Output transform (identity if no pair has weight)
+ * \return 1 if the transform was solved, or 0 if no pair has weight
+ */
+int registration_align_rigid(struct cloud *source,
+                             struct cloud *target,
+                             real *weights,
+                             struct rigid3 *rt);
+
+/**
+ * \brief Finds the transformation matrix 4x4 (rotation + translation) of
+ * weighted correspondences (the i-th point of source goes with the i-th point
+ * of target)
+ * \param source The source cloud
+ * \param target The target cloud
+ * \param weights Weight of each pair (NULL weights every pair with 1)
+ * \return The transformation matrix 4x4 (identity if no pair has weight)
+ */
+struct matrix *registration_align_weighted(struct cloud *source,
+                                          struct cloud *target,
+                                          real *weights);
+
 /**
  * \brief Finds the transformation matrix 4x4 (rotation + translation)
  * \param source The source cloud
@@ -54,5 +92,78 @@ struct matrix *registration_icp(struct cloud *source,
                                  uint k,
                                  closest_points_func cp);
 
+/**
+ * \brief Applies the point-to-plane ICP algorithm to register source with
+ * target. Each iteration pairs the points with their exact nearest neighbors
+ * and solves the linearized 6x6 system of the distances along the normals of
+ * target (estimated once and kept with its kd-tree). The symmetric metric also
+ * uses the normals of source and rotates both clouds halfway. When the system
+ * is degenerate (e.g. every point paired with the same neighbor, far from the
+ * solution) the iteration takes a point-to-point step instead. This is a one
+ * shot wrapper of icp_run; keep a struct icp to register many clouds or to
+ * follow the iterations
+ * \param source The source cloud
+ * \param target The target cloud
+ * \param aligned Pointer to the output cloud registered
+ * \param t Stop criteria (change of the mean distance between iterations)
+ * \param k Maximun number of iterations
+ * \param metric REGISTRATION_PLANE, REGISTRATION_SYMMETRIC or
+ * REGISTRATION_POINT (exact point-to-point, no normals)
+ * \return The transformation matrix 4x4
+ */
+struct matrix *registration_icp_plane(struct cloud *source,
+                                      struct cloud *target,
+                                      struct cloud **aligned,
+                                      real t,
+                                      uint k,
+                                      int metric);
+
+/**
+ * \brief Applies ICP coarse to fine: registers the coarsest common level of the
+ * pyramids first and starts each finer level from the previous transform.
+ * A sampled level cannot be registered below its voxel size, so it stops once
+ * the error changes less than ICP_LEVEL_TOL times its leaf size (or
+ * t, if larger). The kd-trees and normals stay cached in the levels, so
+ * pyramids can be reused across registrations
+ * \param source Pyramid of the source cloud
+ * \param target Pyramid of the target cloud
+ * \param aligned Pointer to the output cloud registered (full resolution)
+ * \param t Stop criteria of each level
+ * \param k Maximun number of iterations of each level
+ * \param metric REGISTRATION_PLANE, REGISTRATION_SYMMETRIC or
+ * REGISTRATION_POINT
+ * \return The transformation matrix 4x4
+ */
+struct matrix *registration_icp_pyramid(struct pyramid *source,
+                                        struct pyramid *target,
+                                        struct cloud **aligned,
+                                        real t,
+                                        uint k,
+                                        int metric);
+
+/**
+ * \brief Registers two clouds in any initial pose: both are sampled in a
+ * pyramid of REGISTRATION_GLOBAL_LEVELS levels (same leaf size), the points
+ * of level 1 take the FPFH descriptors of the full clouds and give a global
+ * alignment by RANSAC (inliers closer than REGISTRATION_GLOBAL_INLIER leaves)
+ * and ICP refines it coarse to fine
+ * \param source The source cloud
+ * \param target The target cloud
+ * \param aligned Pointer to the output cloud registered
+ * \param t Stop criteria of each level
+ * \param k Maximun number of iterations of each level
+ * \param metric REGISTRATION_PLANE, REGISTRATION_SYMMETRIC or
+ * REGISTRATION_POINT
+ * \param seed Seed of RANSAC (same seed, same result)
+ * \return The transformation matrix 4x4
+ */
+struct matrix *registration_icp_global(struct cloud *source,
+                                       struct cloud *target,
+                                       struct cloud **aligned,
+                                       real t,
+                                       uint k,
+                                       int metric,
+                                       uint64_t seed);
+
 #endif // REGISTRATION_H
 
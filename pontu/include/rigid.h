@@ -0,0 +1,363 @@
+/**
+ * \file rigid.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Fixed-size real 3x3 and 4x4 matrices and rigid transforms. They are
+ * plain values (no heap) and the small operations are inlined, unlike the
+ * general complex struct matrix.
+ */
+
+#ifndef RIGID_H
+#define RIGID_H
+
+#include <stdio.h>
+
+#include "./vector3.h"
+#include "./matrix.h"
+
+/**
+ * \brief Struct to store a real 3x3 matrix (row-major)
+ */
+struct mat3 {
+	real m[3][3];
+};
+
+/**
+ * \brief Struct to store a real 4x4 matrix (row-major)
+ */
+struct mat4 {
+	real m[4][4];
+};
+
+/**
+ * \brief Struct to store a rigid transform p' = rot * p + t
+ */
+struct rigid3 {
+	struct mat3 rot;
+	real t[3];
+};
+
+/**
+ * \brief Gets the 3x3 identity
+ * \return The identity matrix
+ */
+static inline struct mat3 mat3_identity()
+{
+	struct mat3 out = {{{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}}};
+
+	return out;
+}
+
+/**
+ * \brief Multiplies two 3x3 matrices
+ * \param a Left matrix
+ * \param b Right matrix
+ * \return a * b
+ */
+static inline struct mat3 mat3_mul(const struct mat3 *a, const struct mat3 *b)
+{
+	struct mat3 out;
+
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			out.m[i][j] = a->m[i][0] * b->m[0][j] +
+			              a->m[i][1] * b->m[1][j] +
+			              a->m[i][2] * b->m[2][j];
+
+	return out;
+}
+
+/**
+ * \brief Transposes a 3x3 matrix
+ * \param a Target matrix
+ * \return Transpose of a
+ */
+static inline struct mat3 mat3_transpose(const struct mat3 *a)
+{
+	struct mat3 out;
+
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			out.m[i][j] = a->m[j][i];
+
+	return out;
+}
+
+/**
+ * \brief Calculates the determinant of a 3x3 matrix
+ * \param a Target matrix
+ * \return Determinant of a
+ */
+static inline real mat3_det(const struct mat3 *a)
+{
+	return a->m[0][0] * (a->m[1][1] * a->m[2][2] - a->m[1][2] * a->m[2][1]) -
+	       a->m[0][1] * (a->m[1][0] * a->m[2][2] - a->m[1][2] * a->m[2][0]) +
+	       a->m[0][2] * (a->m[1][0] * a->m[2][1] - a->m[1][1] * a->m[2][0]);
+}
+
+/**
+ * \brief Inverts a 3x3 matrix (adjugate over determinant)
+ * \param a Target matrix
+ * \param inv Output inverse (untouched if a is singular)
+ * \return 1 if a was inverted, or 0 if it is singular
+ */
+static inline int mat3_inverse(const struct mat3 *a, struct mat3 *inv)
+{
+	real det = mat3_det(a);
+	if (det == 0.0)
+		return 0;
+
+	real f = 1.0 / det;
+
+	inv->m[0][0] = f * (a->m[1][1] * a->m[2][2] - a->m[1][2] * a->m[2][1]);
+	inv->m[0][1] = f * (a->m[0][2] * a->m[2][1] - a->m[0][1] * a->m[2][2]);
+	inv->m[0][2] = f * (a->m[0][1] * a->m[1][2] - a->m[0][2] * a->m[1][1]);
+	inv->m[1][0] = f * (a->m[1][2] * a->m[2][0] - a->m[1][0] * a->m[2][2]);
+	inv->m[1][1] = f * (a->m[0][0] * a->m[2][2] - a->m[0][2] * a->m[2][0]);
+	inv->m[1][2] = f * (a->m[0][2] * a->m[1][0] - a->m[0][0] * a->m[1][2]);
+	inv->m[2][0] = f * (a->m[1][0] * a->m[2][1] - a->m[1][1] * a->m[2][0]);
+	inv->m[2][1] = f * (a->m[0][1] * a->m[2][0] - a->m[0][0] * a->m[2][1]);
+	inv->m[2][2] = f * (a->m[0][0] * a->m[1][1] - a->m[0][1] * a->m[1][0]);
+
+	return 1;
+}
+
+/**
+ * \brief Multiplies a 3x3 matrix by a vector
+ * \param a Target matrix
+ * \param v Target vector
+ * \return a * v
+ */
+static inline struct vector3 mat3_apply(const struct mat3 *a,
+                                        const struct vector3 *v)
+{
+	struct vector3 out;
+
+	out.x = a->m[0][0] * v->x + a->m[0][1] * v->y + a->m[0][2] * v->z;
+	out.y = a->m[1][0] * v->x + a->m[1][1] * v->y + a->m[1][2] * v->z;
+	out.z = a->m[2][0] * v->x + a->m[2][1] * v->y + a->m[2][2] * v->z;
+
+	return out;
+}
+
+/**
+ * \brief Builds the rotation of angle |w| about the axis w (Rodrigues)
+ * \param w Rotation vector (x, y, z)
+ * \return The rotation matrix
+ */
+struct mat3 mat3_rotation(const real *w);
+
+/**
+ * \brief Decomposes a symmetric 3x3 matrix in closed form (trigonometric
+ * eigenvalues, eigenvectors from cross products of the rows of a - value * I)
+ * \param a Symmetric matrix
+ * \param values Output eigenvalues in ascending order
+ * \param vectors Output orthonormal eigenvectors (column j goes with values[j])
+ */
+void mat3_sym_eigen(const struct mat3 *a, real *values, struct mat3 *vectors);
+
+/**
+ * \brief Gets the 4x4 identity
+ * \return The identity matrix
+ */
+static inline struct mat4 mat4_identity()
+{
+	struct mat4 out = {{{1.0, 0.0, 0.0, 0.0},
+	                    {0.0, 1.0, 0.0, 0.0},
+	                    {0.0, 0.0, 1.0, 0.0},
+	                    {0.0, 0.0, 0.0, 1.0}}};
+
+	return out;
+}
+
+/**
+ * \brief Multiplies two 4x4 matrices
+ * \param a Left matrix
+ * \param b Right matrix
+ * \return a * b
+ */
+static inline struct mat4 mat4_mul(const struct mat4 *a, const struct mat4 *b)
+{
+	struct mat4 out;
+
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			out.m[i][j] = a->m[i][0] * b->m[0][j] +
+			              a->m[i][1] * b->m[1][j] +
+			              a->m[i][2] * b->m[2][j] +
+			              a->m[i][3] * b->m[3][j];
+
+	return out;
+}
+
+/**
+ * \brief Applies a 4x4 homogeneous transform to a point
+ * \param a Target matrix
+ * \param v Target point
+ * \return The transformed point (divided by w when w is neither 0 nor 1)
+ */
+static inline struct vector3 mat4_apply(const struct mat4 *a,
+                                        const struct vector3 *v)
+{
+	struct vector3 out;
+	real c[4];
+
+	for (int i = 0; i < 4; i++)
+		c[i] = a->m[i][0] * v->x + a->m[i][1] * v->y + a->m[i][2] * v->z +
+		       a->m[i][3];
+
+	if (c[3] != 0.0 && c[3] != 1.0) {
+		c[0] /= c[3];
+		c[1] /= c[3];
+		c[2] /= c[3];
+	}
+
+	out.x = c[0];
+	out.y = c[1];
+	out.z = c[2];
+
+	return out;
+}
+
+/**
+ * \brief Inverts a 4x4 matrix (cofactor expansion)
+ * \param a Target matrix
+ * \param inv Output inverse (untouched if a is singular)
+ * \return 1 if a was inverted, or 0 if it is singular
+ */
+int mat4_inverse(const struct mat4 *a, struct mat4 *inv);
+
+/**
+ * \brief Gets the identity transform
+ * \return The identity transform
+ */
+static inline struct rigid3 rigid3_identity()
+{
+	struct rigid3 out = {mat3_identity(), {0.0, 0.0, 0.0}};
+
+	return out;
+}
+
+/**
+ * \brief Applies a rigid transform to a point
+ * \param rt Target transform
+ * \param v Target point
+ * \return rot * v + t
+ */
+static inline struct vector3 rigid3_apply(const struct rigid3 *rt,
+                                          const struct vector3 *v)
+{
+	struct vector3 out = mat3_apply(&rt->rot, v);
+
+	out.x += rt->t[0];
+	out.y += rt->t[1];
+	out.z += rt->t[2];
+
+	return out;
+}
+
+/**
+ * \brief Composes two rigid transforms
+ * \param a Transform applied last
+ * \param b Transform applied first
+ * \return a * b (the point goes through b and then a)
+ */
+static inline struct rigid3 rigid3_compose(const struct rigid3 *a,
+                                           const struct rigid3 *b)
+{
+	struct rigid3 out;
+
+	out.rot = mat3_mul(&a->rot, &b->rot);
+
+	for (int i = 0; i < 3; i++)
+		out.t[i] = a->rot.m[i][0] * b->t[0] +
+		           a->rot.m[i][1] * b->t[1] +
+		           a->rot.m[i][2] * b->t[2] +
+		           a->t[i];
+
+	return out;
+}
+
+/**
+ * \brief Inverts a rigid transform (the rotation must be orthonormal)
+ * \param rt Target transform
+ * \return The inverse transform
+ */
+static inline struct rigid3 rigid3_inverse(const struct rigid3 *rt)
+{
+	struct rigid3 out;
+
+	out.rot = mat3_transpose(&rt->rot);
+
+	for (int i = 0; i < 3; i++)
+		out.t[i] = -(out.rot.m[i][0] * rt->t[0] +
+		             out.rot.m[i][1] * rt->t[1] +
+		             out.rot.m[i][2] * rt->t[2]);
+
+	return out;
+}
+
+/**
+ * \brief Converts a rigid transform to a 4x4 homogeneous matrix
+ * \param rt Target transform
+ * \return The 4x4 matrix
+ */
+static inline struct mat4 rigid3_to_mat4(const struct rigid3 *rt)
+{
+	struct mat4 out = mat4_identity();
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++)
+			out.m[i][j] = rt->rot.m[i][j];
+
+		out.m[i][3] = rt->t[i];
+	}
+
+	return out;
+}
+
+/**
+ * \brief Converts the upper 3x4 block of a 4x4 matrix to a transform (the
+ * last row is ignored)
+ * \param a Target matrix
+ * \return The transform
+ */
+static inline struct rigid3 rigid3_from_mat4(const struct mat4 *a)
+{
+	struct rigid3 out;
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++)
+			out.rot.m[i][j] = a->m[i][j];
+
+		out.t[i] = a->m[i][3];
+	}
+
+	return out;
+}
+
+/**
+ * \brief Converts the upper 3x4 block of a heap matrix to a transform (real
+ * parts only)
+ * \param mat Matrix with at least 3 rows and 4 columns
+ * \param rt Output transform
+ * \return 1 if it was converted, or 0 if the matrix is too small
+ */
+int rigid3_from_matrix(struct matrix *mat, struct rigid3 *rt);
+
+/**
+ * \brief Converts a rigid transform to a heap 4x4 matrix
+ * \param rt Target transform
+ * \return The transformation matrix 4x4 or NULL if it fails
+ */
+struct matrix *rigid3_to_matrix(const struct rigid3 *rt);
+
+/**
+ * \brief Debugs a rigid transform
+ * \param rt Target transform
+ * \param output File to output the debug in
+ */
+void rigid3_debug(const struct rigid3 *rt, FILE *output);
+
+#endif // RIGID_H
+
@@ -0,0 +1,150 @@
+/**
+ * \file simd.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Vectorized reductions over arrays of points. The SSE2, AVX2 and
+ * AVX-512 paths are chosen at runtime from the CPU features, so the library
+ * stays portable. The PONTU_SIMD environment variable (scalar, sse2, avx2 or
+ * avx512) caps the level used.
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdio.h>
+
+#include "./pointarray.h"
+#include "./rigid.h"
+
+#define SIMD_SCALAR 0
+#define SIMD_SSE2 1
+#define SIMD_AVX2 2
+#define SIMD_AVX512 3
+#define SIMD_ENV "PONTU_SIMD"
+#define SIMD_BLOCK 8
+
+/**
+ * \brief Struct to store the result of a fused reduction: bounds, sums and
+ * second order sums about the first point (well conditioned covariance)
+ */
+struct simd_stats {
+	uint numpts;
+	real min[3];
+	real max[3];
+	real sum[3];
+	real origin[3];
+	real moment[6];
+};
+
+/**
+ * \brief Gets the level in use (detected once, capped by PONTU_SIMD)
+ * \return SIMD_SCALAR, SIMD_SSE2, SIMD_AVX2 or SIMD_AVX512
+ */
+int simd_level();
+
+/**
+ * \brief Changes the level in use (not thread safe: call it before starting
+ * threads)
+ * \param level Desired level (capped by what the CPU supports)
+ * \return The level actually used
+ */
+int simd_set_level(int level);
+
+/**
+ * \brief Gets the name of a level
+ * \param level Target level
+ * \return Name of the level
+ */
+const char *simd_name(int level);
+
+/**
+ * \brief Calculates bounds, sums and second order sums of an array of points in
+ * a single pass
+ * \param array Target array
+ * \param stats Output statistics (min = INFINITY and max = -INFINITY if empty)
+ */
+void simd_reduce(struct pointarray *array, struct simd_stats *stats);
+
+/**
+ * \brief Calculates the biggest squared distance from the points to p
+ * \param array Target array
+ * \param p Reference point
+ * \return Biggest squared distance (0 if the array is empty)
+ */
+real simd_max_squared_distance(struct pointarray *array, struct vector3 *p);
+
+/**
+ * \brief Calculates the sum of the distances from the points to p
+ * \param array Target array
+ * \param p Reference point
+ * \return Sum of the distances
+ */
+real simd_sum_distance(struct pointarray *array, struct vector3 *p);
+
+/**
+ * \brief Applies a rigid transform to every point of an array, in place (the
+ * referenced points are not touched)
+ * \param array Target array
+ * \param rt Transform to be applied
+ */
+void simd_transform(struct pointarray *array, const struct rigid3 *rt);
+
+/**
+ * \brief Distance update of farthest point sampling over a range of an array:
+ * lowers mind[i] to the squared distance from point i to p and finds the point
+ * of the range farthest from the ones chosen so far (biggest mind, the first
+ * one on ties)
+ * \param array Target array
+ * \param begin First point of the range (a multiple of SIMD_BLOCK)
+ * \param end One past the last point of the range
+ * \param p Point just chosen
+ * \param mind Squared distance from each point to the chosen ones, aligned to
+ * POINTARRAY_ALIGN like the coordinates
+ * \return Index of the farthest point (begin if the range is empty)
+ */
+uint simd_update_farthest(struct pointarray *array,
+                          uint begin,
+                          uint end,
+                          struct vector3 *p,
+                          real *mind);
+
+/**
+ * \brief Counts the points of a range of an array within a distance of a
+ * plane (the inlier count of RANSAC)
+ * \param array Target array
+ * \param begin First point of the range (a multiple of SIMD_BLOCK)
+ * \param end One past the last point of the range
+ * \param coef Plane a x + b y + c z + d = 0 as {a, b, c, d}, with (a, b, c) of
+ * unit length
+ * \param threshold Maximum distance to the plane
+ * \return Number of points
+ */
+uint simd_count_plane(struct pointarray *array,
+                      uint begin,
+                      uint end,
+                      const real *coef,
+                      real threshold);
+
+/**
+ * \brief Calculates the centroid from a reduction
+ * \param stats Reduction of the points
+ * \return Pointer to the centroid
+ */
+struct vector3 *simd_stats_centroid(struct simd_stats *stats);
+
+/**
+ * \brief Calculates the covariance matrix from a reduction
+ * \param stats Reduction of the points
+ * \param cov Output with the 6 distinct entries: xx, xy, xz, yy, yz and zz
+ */
+void simd_stats_covariance(struct simd_stats *stats, real *cov);
+
+/**
+ * \brief Debugs a reduction
+ * \param stats Target reduction
+ * \param output File to output the debug in
+ */
+void simd_stats_debug(struct simd_stats *stats, FILE *output);
+
+#endif // SIMD_H
+
@@ -22,6 +22,7 @@
 
 #include "./cloud.h"
 #include "./dataframe.h"
+#include "./momentcfg.h"
 
 /**
  * \brief Image function from the spheric equation
@@ -35,6 +36,14 @@
  */
 real spheric_quad(real x, real y, real z, int p, int q, int r);
 
+/**
+ * \brief Calculates every power of a coordinate up to an exponent
+ * \param n Maximum exponent
+ * \param x Coordinate
+ * \param table Output with n + 1 powers of x (pow(x, 0) to pow(x, n))
+ */
+void spheric_pow_table(int n, real x, real *table);
+
 /**
  * \brief Calculates spheric moments of a cloud
  * \param p Order of coordinate x
@@ -62,5 +71,14 @@ real spheric_normalized_moment(int p, int q, int r, struct cloud *cloud);
  */
 struct dataframe *spheric_cloud_moments(struct cloud *cloud);
 
+/**
+ * \brief Calculates spheric moments of a cloud in a single pass
+ * \param cloud Target cloud
+ * \param cfg Moment orders (cfg->spheric)
+ * \return Matrix with moments of the cloud
+ */
+struct dataframe *spheric_cloud_moments_cfg(struct cloud *cloud,
+                                            struct momentcfg *cfg);
+
 #endif // SPHERIC_H
 
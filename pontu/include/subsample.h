@@ -0,0 +1,67 @@
+/**
+ * \file subsample.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Linear time subsampling (random without replacement, reservoir,
+ * stride and Poisson disk). Samples are returned as views of the cloud, which
+ * cloudview_materialize turns into clouds when a copy is needed.
+ */
+
+#ifndef SUBSAMPLE_H
+#define SUBSAMPLE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "./calc.h"
+#include "./cloud.h"
+#include "./cloudview.h"
+#include "./simd.h"
+#include "./gridhash.h"
+
+/**
+ * \brief Picks k distinct points uniformly at random in a single pass
+ * (selection sampling, O(n))
+ * \param cloud Target cloud
+ * \param k Number of points (all of them if the cloud has fewer)
+ * \param seed Seed of the generator (same seed, same sample)
+ * \return View with the positions in increasing order or NULL if it fails
+ */
+struct cloudview *subsample_random(struct cloud *cloud, uint k, uint64_t seed);
+
+/**
+ * \brief Picks k distinct points uniformly at random while walking the set
+ * once, without using its size (reservoir sampling, O(n))
+ * \param cloud Target cloud
+ * \param k Number of points (all of them if the cloud has fewer)
+ * \param seed Seed of the generator (same seed, same sample)
+ * \return View with the positions in increasing order or NULL if it fails
+ */
+struct cloudview *subsample_reservoir(struct cloud *cloud,
+                                      uint k,
+                                      uint64_t seed);
+
+/**
+ * \brief Picks every stride-th point, starting from the first one
+ * \param cloud Target cloud
+ * \param stride Step between picked points (at least 1)
+ * \return View with the positions in increasing order or NULL if it fails
+ */
+struct cloudview *subsample_stride(struct cloud *cloud, uint stride);
+
+/**
+ * \brief Picks points no closer than radius to each other: the points are
+ * visited in random order and each one is kept if no kept point lies within
+ * radius, looked up in a hash grid of cells of that size (O(n) expected)
+ * \param cloud Target cloud
+ * \param radius Minimum distance between picked points (> 0)
+ * \param seed Seed of the visiting order (same seed, same sample)
+ * \return View with the positions in increasing order or NULL if it fails
+ */
+struct cloudview *subsample_poisson(struct cloud *cloud,
+                                    real radius,
+                                    uint64_t seed);
+
+#endif // SUBSAMPLE_H
+
@@ -0,0 +1,126 @@
+/**
+ * \file synth.h
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Seeded synthetic clouds (cubes, shells, clusters, scans, faces and
+ * duplicated points) to benchmark and test at any scale without data files.
+ */
+
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdio.h>
+#include <string.h>
+
+#include "./calc.h"
+#include "./cloud.h"
+
+#define SYNTH_CUBE 0
+#define SYNTH_SPHERE 1
+#define SYNTH_CLUSTERS 2
+#define SYNTH_PLANE 3
+#define SYNTH_FACE 4
+#define SYNTH_DUPLICATES 5
+#define SYNTH_NUMSHAPES 6
+#define SYNTH_NOISE 0.002
+#define SYNTH_CLUSTERS_K 8
+#define SYNTH_CLUSTERS_SIGMA 0.05
+#define SYNTH_UNIQUE 0.01
+
+/**
+ * \brief Generates points uniformly distributed in a cube centered at the
+ * origin
+ * \param numpts Number of points
+ * \param side Size of the edges of the cube
+ * \param seed Seed of the generator (same seed, same cloud)
+ * \return The new cloud or NULL if it fails
+ */
+struct cloud *synth_cube(uint numpts, real side, uint64_t seed);
+
+/**
+ * \brief Generates points uniformly distributed on a sphere centered at the
+ * origin, displaced along the radius by gaussian noise
+ * \param numpts Number of points
+ * \param radius Radius of the sphere
+ * \param noise Standard deviation of the noise (0 puts them on the surface)
+ * \param seed Seed of the generator (same seed, same cloud)
+ * \return The new cloud or NULL if it fails
+ */
+struct cloud *synth_sphere(uint numpts, real radius, real noise, uint64_t seed);
+
+/**
+ * \brief Generates isotropic gaussian clusters with centers uniformly
+ * distributed in the unit cube. Each point picks its cluster at random
+ * \param numpts Number of points
+ * \param numclusters Number of clusters (at least 1)
+ * \param sigma Standard deviation of each cluster
+ * \param seed Seed of the generator (same seed, same cloud)
+ * \return The new cloud or NULL if it fails
+ */
+struct cloud *synth_clusters(uint numpts,
+                             uint numclusters,
+                             real sigma,
+                             uint64_t seed);
+
+/**
+ * \brief Generates a scan of the square [-1, 1]^2 of the plane z = 0: evenly
+ * spaced scan lines along x, each one with evenly spaced samples jittered
+ * along the line, and gaussian noise in z
+ * \param numpts Number of points
+ * \param noise Standard deviation of the noise (0 keeps them on the plane)
+ * \param seed Seed of the generator (same seed, same cloud)
+ * \return The new cloud or NULL if it fails
+ */
+struct cloud *synth_plane(uint numpts, real noise, uint64_t seed);
+
+/**
+ * \brief Generates a face-like height field, as a frontal range scan: points
+ * uniformly distributed in an ellipse of the xy plane (0.8 by 1.0), with z
+ * from a dome plus gaussian bumps for the nose, eye sockets, mouth and chin
+ * and gaussian noise. The nose tip is near (0, 0) and y points to the forehead
+ * \param numpts Number of points
+ * \param noise Standard deviation of the noise (0 keeps them on the surface)
+ * \param seed Seed of the generator (same seed, same cloud)
+ * \return The new cloud or NULL if it fails
+ */
+struct cloud *synth_face(uint numpts, real noise, uint64_t seed);
+
+/**
+ * \brief Generates a cloud of exact duplicates: numunique points uniformly
+ * distributed in the unit cube, each point of the cloud a copy of one of them
+ * \param numpts Number of points
+ * \param numunique Number of distinct points (at least 1)
+ * \param seed Seed of the generator (same seed, same cloud)
+ * \return The new cloud or NULL if it fails
+ */
+struct cloud *synth_duplicates(uint numpts, uint numunique, uint64_t seed);
+
+/**
+ * \brief Generates a shape with the default parameters: unit cube, unit sphere
+ * and SYNTH_NOISE for the noisy shapes, SYNTH_CLUSTERS_K clusters of
+ * SYNTH_CLUSTERS_SIGMA and SYNTH_UNIQUE times numpts distinct duplicates
+ * \param shape SYNTH_CUBE, SYNTH_SPHERE, SYNTH_CLUSTERS, SYNTH_PLANE,
+ * SYNTH_FACE or SYNTH_DUPLICATES
+ * \param numpts Number of points
+ * \param seed Seed of the generator (same seed, same cloud)
+ * \return The new cloud or NULL if it fails (or the shape is unknown)
+ */
+struct cloud *synth_generate(int shape, uint numpts, uint64_t seed);
+
+/**
+ * \brief Gets a shape by its name (cube, sphere, clusters, plane, face or
+ * duplicates)
+ * \param name Name of the shape
+ * \return The shape or -1 if the name is unknown
+ */
+int synth_shape(const char *name);
+
+/**
+ * \brief Gets the name of a shape
+ * \param shape Target shape
+ * \return The name or NULL if the shape is unknown
+ */
+const char *synth_name(int shape);
+
+#endif // SYNTH_H
+
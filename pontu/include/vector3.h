@@ -12,6 +12,7 @@
 #include <stdio.h>
 
 #include "./calc.h"
+#include "./mem.h"
 
 #define VECTOR3_AXIS_X 0
 #define VECTOR3_AXIS_Y 1
@@ -8,6 +8,8 @@
 #ifndef VOXELGRID_H
 #define VOXELGRID_H
 
+#include <limits.h>
+
 #include "./vector3.h"
 #include "./cloud.h"
 
@@ -18,6 +18,44 @@
 
 #include "./cloud.h"
 #include "./dataframe.h"
+#include "./momentcfg.h"
+
+#define ZERNIKE_KIND_ODD 0
+#define ZERNIKE_KIND_EVEN 1
+#define ZERNIKE_KIND_MAG 2
+#define ZERNIKE_KIND_FULL 3
+
+/**
+ * \brief Struct to store one term of a radial Zernike polynomial
+ */
+struct zernike_term {
+	int power;
+	real num;
+	real den;
+};
+
+/**
+ * \brief Struct to store a valid (n, m) pair and the range of its terms
+ */
+struct zernike_pair {
+	int n;
+	int m;
+	int first;
+	int last;
+};
+
+/**
+ * \brief Struct to store the coefficients of every radial polynomial up to an
+ * order, so they can be evaluated for all pairs in a single pass
+ */
+struct zernike_radial {
+	int ord;
+	int rep;
+	int numpairs;
+	int numterms;
+	struct zernike_pair *pairs;
+	struct zernike_term *terms;
+};
 
 /**
  * \brief Zernike polynomial boundary conditions
@@ -44,6 +82,31 @@ int zernike_nummoments(int ord, int rep);
  */
 real zernike_radpoly(int n, int m, real distance);
 
+/**
+ * \brief Initializes the radial table of every valid pair up to (ord, rep)
+ * \param ord Maximum order
+ * \param rep Maximum repetition
+ * \return Pointer to the new table or NULL if it fails to allocate memory
+ */
+struct zernike_radial *zernike_radial_new(int ord, int rep);
+
+/**
+ * \brief Frees a radial table
+ * \param radial Table to be freed
+ */
+void zernike_radial_free(struct zernike_radial **radial);
+
+/**
+ * \brief Evaluates every radial polynomial of a table (same values as
+ * zernike_radpoly())
+ * \param radial Target table
+ * \param distance Radial distance
+ * \param radpoly Output with numpairs polynomials, in pair order
+ */
+void zernike_radial_eval(struct zernike_radial *radial,
+                         real distance,
+                         real *radpoly);
+
 /**
  * \brief Calculates the azimutal angle
  * \param y Coordinate y
@@ -128,5 +191,17 @@ struct dataframe *zernike_cloud_moments_mag(struct cloud *cloud);
  */
 struct dataframe *zernike_cloud_moments_full(struct cloud *cloud);
 
+/**
+ * \brief Calculates Zernike moments of a cloud in a single pass
+ * \param cloud Target cloud
+ * \param cfg Moment orders (cfg->zernike_ord and cfg->zernike_rep)
+ * \param kind ZERNIKE_KIND_ODD, ZERNIKE_KIND_EVEN, ZERNIKE_KIND_MAG or
+ * ZERNIKE_KIND_FULL
+ * \return Matrix with the moments
+ */
+struct dataframe *zernike_cloud_moments_cfg(struct cloud *cloud,
+                                            struct momentcfg *cfg,
+                                            int kind);
+
 #endif // ZERNIKE_H
 
@@ -5,11 +5,21 @@
 #include "include/vector3.h"
 #include "include/matrix.h"
 #include "include/algebra.h"
+#include "include/rigid.h"
 #include "include/plane.h"
 #include "include/pointset.h"
+#include "include/pointarray.h"
+#include "include/simd.h"
 #include "include/cloud.h"
 #include "include/kdtree.h"
 #include "include/octree.h"
+#include "include/kdindex.h"
+#include "include/cloudcache.h"
+#include "include/parallel.h"
+#include "include/attrib.h"
+#include "include/synth.h"
+#include "include/profile.h"
+#include "include/mem.h"
 
 #endif // PONTU_CORE_H
 
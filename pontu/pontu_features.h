@@ -9,6 +9,9 @@
 #include "include/chebyshev.h"
 #include "include/spheric.h"
 #include "include/harmonics.h"
+#include "include/momentcfg.h"
+#include "include/momentacc.h"
+#include "include/featcache.h"
 
 #endif // PONTU_FEATURES_H
 
@@ -1,7 +1,12 @@
 #ifndef PONTU_REGISTRATION_H
 #define PONTU_REGISTRATION_H
 
+#include "include/horn.h"
+#include "include/icp.h"
+#include "include/fpfh.h"
+#include "include/ransac.h"
 #include "include/registration.h"
+#include "include/batch.h"
 
 #endif // PONTU_REGISTRATION_H
 
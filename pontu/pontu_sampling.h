@@ -2,6 +2,13 @@
 #define PONTU_SAMPLING_H
 
 #include "include/voxelgrid.h"
+#include "include/pyramid.h"
+#include "include/fps.h"
+#include "include/cloudview.h"
+#include "include/subsample.h"
+#include "include/outlier.h"
+#include "include/cluster.h"
+#include "include/planeseg.h"
 
 #endif // PONTU_SAMPLING_H
 
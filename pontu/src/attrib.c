@@ -0,0 +1,212 @@
+#include "../include/attrib.h"
+
+struct attrib *attrib_new(const char *name, int type, uint width)
+{
+	size_t size = attrib_sizeof(type);
+	if (size == 0 || width == 0)
+		return NULL;
+
+	struct attrib *attrib = mem_alloc(MEM_ATTRIB, sizeof(struct attrib));
+	if (attrib == NULL)
+		return NULL;
+
+	strncpy(attrib->name, name, ATTRIB_MAXNAME - 1);
+	attrib->name[ATTRIB_MAXNAME - 1] = '\0';
+	attrib->type = type;
+	attrib->width = width;
+	attrib->numpts = 0;
+	attrib->capacity = 0;
+	attrib->stride = width * size;
+	attrib->buffer = NULL;
+	attrib->data = NULL;
+
+	return attrib;
+}
+
+void attrib_free(struct attrib **attrib)
+{
+	if (*attrib == NULL)
+		return;
+
+	mem_free(MEM_ATTRIB,
+	         (*attrib)->buffer,
+	         (*attrib)->capacity * (*attrib)->stride);
+	mem_free(MEM_ATTRIB, *attrib, sizeof(struct attrib));
+	*attrib = NULL;
+}
+
+size_t attrib_sizeof(int type)
+{
+	switch (type) {
+	case ATTRIB_REAL:
+		return sizeof(real);
+	case ATTRIB_INT:
+		return sizeof(int);
+	case ATTRIB_UINT:
+		return sizeof(uint);
+	case ATTRIB_UCHAR:
+		return sizeof(unsigned char);
+	default:
+		return 0;
+	}
+}
+
+static int attrib_grow(struct attrib *attrib)
+{
+	uint capacity = attrib->capacity * 2;
+	if (capacity < ATTRIB_MINCAPACITY)
+		capacity = ATTRIB_MINCAPACITY;
+
+	unsigned char *buffer = mem_alloc(MEM_ATTRIB, capacity * attrib->stride);
+	if (buffer == NULL)
+		return 0;
+
+	unsigned char *data = buffer + (capacity - attrib->numpts) * attrib->stride;
+	if (attrib->numpts > 0)
+		memcpy(data, attrib->data, attrib->numpts * attrib->stride);
+
+	mem_free(MEM_ATTRIB, attrib->buffer, attrib->capacity * attrib->stride);
+	attrib->buffer = buffer;
+	attrib->data = data;
+	attrib->capacity = capacity;
+
+	return 1;
+}
+
+int attrib_push(struct attrib *attrib)
+{
+	if (attrib->numpts == attrib->capacity && !attrib_grow(attrib))
+		return 0;
+
+	if (attrib->numpts == 0)
+		attrib->data = attrib->buffer + attrib->capacity * attrib->stride;
+
+	attrib->data = (unsigned char *)attrib->data - attrib->stride;
+	attrib->numpts++;
+	memset(attrib->data, 0, attrib->stride);
+
+	return 1;
+}
+
+void attrib_pop(struct attrib *attrib)
+{
+	if (attrib->numpts == 0)
+		return;
+
+	attrib->data = (unsigned char *)attrib->data + attrib->stride;
+	attrib->numpts--;
+}
+
+real attrib_get(struct attrib *attrib, uint i, uint c)
+{
+	uint k = i * attrib->width + c;
+
+	switch (attrib->type) {
+	case ATTRIB_REAL:
+		return ((real *)attrib->data)[k];
+	case ATTRIB_INT:
+		return ((int *)attrib->data)[k];
+	case ATTRIB_UINT:
+		return ((uint *)attrib->data)[k];
+	case ATTRIB_UCHAR:
+		return ((unsigned char *)attrib->data)[k];
+	default:
+		return 0.0;
+	}
+}
+
+static real attrib_clamp(real value, real min, real max)
+{
+	if (value != value)
+		return 0.0;
+
+	return value < min ? min : (value > max ? max : value);
+}
+
+void attrib_set(struct attrib *attrib, uint i, uint c, real value)
+{
+	uint k = i * attrib->width + c;
+
+	switch (attrib->type) {
+	case ATTRIB_REAL:
+		((real *)attrib->data)[k] = value;
+		break;
+	case ATTRIB_INT:
+		value = attrib_clamp(value, INT_MIN, INT_MAX);
+		((int *)attrib->data)[k] = (int)value;
+		break;
+	case ATTRIB_UINT:
+		value = attrib_clamp(value, 0.0, UINT_MAX);
+		((uint *)attrib->data)[k] = (uint)value;
+		break;
+	case ATTRIB_UCHAR:
+		value = attrib_clamp(value, 0.0, UCHAR_MAX);
+		((unsigned char *)attrib->data)[k] = (unsigned char)value;
+		break;
+	}
+}
+
+int attrib_copy_row(struct attrib *dst, uint i, struct attrib *src, uint j)
+{
+	if (dst->type != src->type || dst->width != src->width)
+		return 0;
+
+	memcpy((unsigned char *)dst->data + i * dst->stride,
+	       (unsigned char *)src->data + j * src->stride,
+	       src->stride);
+
+	return 1;
+}
+
+int attrib_permute(struct attrib *attrib, const uint *perm)
+{
+	if (attrib->numpts == 0)
+		return 1;
+
+	size_t size = attrib->numpts * attrib->stride;
+	unsigned char *rows = mem_alloc(MEM_ATTRIB, size);
+	if (rows == NULL)
+		return 0;
+
+	for (uint i = 0; i < attrib->numpts; i++)
+		memcpy(rows + i * attrib->stride,
+		       (unsigned char *)attrib->data + perm[i] * attrib->stride,
+		       attrib->stride);
+
+	memcpy(attrib->data, rows, size);
+	mem_free(MEM_ATTRIB, rows, size);
+
+	return 1;
+}
+
+void attrib_print(struct attrib *attrib, uint i, uint c, FILE *output)
+{
+	uint k = i * attrib->width + c;
+
+	switch (attrib->type) {
+	case ATTRIB_REAL:
+		fprintf(output, "%le", ((real *)attrib->data)[k]);
+		break;
+	case ATTRIB_INT:
+		fprintf(output, "%d", ((int *)attrib->data)[k]);
+		break;
+	case ATTRIB_UINT:
+		fprintf(output, "%u", ((uint *)attrib->data)[k]);
+		break;
+	case ATTRIB_UCHAR:
+		fprintf(output, "%u", ((unsigned char *)attrib->data)[k]);
+		break;
+	}
+}
+
+void attrib_debug(struct attrib *attrib, FILE *output)
+{
+	fprintf(output,
+	        "%s | type: %d | width: %u | numpts: %u | capacity: %u\n",
+	        attrib->name,
+	        attrib->type,
+	        attrib->width,
+	        attrib->numpts,
+	        attrib->capacity);
+}
+
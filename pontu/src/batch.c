@@ -0,0 +1,264 @@
+#include "../include/batch.h"
+
+struct batch_item {
+	struct cloud *cloud;
+	int index;
+	int normals;
+};
+
+struct batch_job {
+	struct batch *batch;
+	struct batch_item *items;
+	struct icp **engines;
+	real t;
+	uint k;
+	atomic_uint numaborted;
+	atomic_int failed;
+};
+
+static int batch_continue(struct icp_iteration *stats, void *data)
+{
+	struct batch *batch = data;
+
+	return batch->abort <= 0.0 ||
+	       stats->iter + 1 < batch->patience ||
+	       stats->error <= batch->abort ||
+	       stats->change > BATCH_PROGRESS * stats->error;
+}
+
+static void batch_prepare(uint i, uint thread, void *data)
+{
+	PROFILE_SPAN(__func__);
+
+	struct batch_job *job = data;
+	struct batch_item *item = &job->items[i];
+	int ok = cloud_pack(item->cloud) != NULL;
+
+	if (ok && item->index)
+		ok = cloud_index(item->cloud) != NULL;
+
+	if (ok && item->normals)
+		ok = cloud_normals(item->cloud, CLOUD_NORMAL_K) != NULL;
+
+	if (!ok)
+		atomic_store(&job->failed, 1);
+
+	(void)thread;
+}
+
+static int batch_compare(const void *a, const void *b)
+{
+	uintptr_t i = (uintptr_t)((const struct batch_item *)a)->cloud;
+	uintptr_t j = (uintptr_t)((const struct batch_item *)b)->cloud;
+
+	return (i > j) - (i < j);
+}
+
+static uint batch_items(struct batch *batch, struct batch_item *items)
+{
+	int metric = batch->config->metric;
+	uint n = 0;
+
+	for (uint g = 0; g < batch->numgallery; g++, n++) {
+		items[n].cloud = batch->gallery[g];
+		items[n].index = 1;
+		items[n].normals = metric != ICP_POINT;
+	}
+
+	for (uint p = 0; p < batch->numprobes; p++, n++) {
+		items[n].cloud = batch->probes[p];
+		items[n].index = 0;
+		items[n].normals = metric == ICP_SYMMETRIC;
+	}
+
+	qsort(items, n, sizeof(struct batch_item), &batch_compare);
+
+	uint numitems = 0;
+
+	for (uint i = 0; i < n; i++) {
+		if (numitems > 0 && items[numitems - 1].cloud == items[i].cloud) {
+			items[numitems - 1].index |= items[i].index;
+			items[numitems - 1].normals |= items[i].normals;
+		} else {
+			items[numitems++] = items[i];
+		}
+	}
+
+	return numitems;
+}
+
+static void batch_register(uint i, uint thread, void *data)
+{
+	PROFILE_SPAN(__func__);
+
+	struct batch_job *job = data;
+	struct batch *batch = job->batch;
+	struct icp *icp = job->engines[thread];
+	uint p = i / batch->numgallery;
+	uint g = i % batch->numgallery;
+	real score = INFINITY;
+
+	icp->rt = rigid3_identity();
+
+	if (icp_run(icp, batch->probes[p], batch->gallery[g], job->t, job->k)) {
+		if (icp->stopped)
+			atomic_fetch_add(&job->numaborted, 1);
+		else
+			score = icp->stats.error;
+	}
+
+	dataframe_set(batch->scores, p, g, score);
+	batch->transforms[i] = icp->rt;
+}
+
+struct batch *batch_new(struct cloud **probes,
+                        uint numprobes,
+                        struct cloud **gallery,
+                        uint numgallery,
+                        int metric)
+{
+	struct batch *batch = malloc(sizeof(struct batch));
+	if (batch == NULL)
+		return NULL;
+
+	batch->numprobes = numprobes;
+	batch->numgallery = numgallery;
+	batch->probes = probes;
+	batch->gallery = gallery;
+	batch->abort = 0.0;
+	batch->patience = BATCH_PATIENCE;
+	batch->numthreads = 0;
+	batch->numaborted = 0;
+	batch->config = icp_new(0, metric);
+	batch->scores = dataframe_new(numprobes, numgallery);
+	batch->transforms = malloc((numprobes * numgallery + 1) *
+	                           sizeof(struct rigid3));
+
+	if (batch->config == NULL ||
+	    batch->scores == NULL ||
+	    batch->transforms == NULL) {
+		batch_free(&batch);
+		return NULL;
+	}
+
+	return batch;
+}
+
+void batch_free(struct batch **batch)
+{
+	if (*batch == NULL)
+		return;
+
+	icp_free(&(*batch)->config);
+	dataframe_free(&(*batch)->scores);
+	free((*batch)->transforms);
+	free(*batch);
+	*batch = NULL;
+}
+
+int batch_run(struct batch *batch, real t, uint k, real abort)
+{
+	uint numthreads = batch->numthreads;
+	uint numpairs = batch->numprobes * batch->numgallery;
+	uint maxpts = 0;
+
+	if (numthreads == 0)
+		numthreads = parallel_threads();
+
+	numthreads = numthreads > numpairs ? numpairs : numthreads;
+	numthreads = numthreads == 0 ? 1 : numthreads;
+
+	for (uint i = 0; i < batch->numprobes; i++)
+		if (batch->probes[i]->numpts > maxpts)
+			maxpts = batch->probes[i]->numpts;
+
+	struct batch_job job;
+
+	job.batch = batch;
+	job.t = t;
+	job.k = k;
+	job.engines = calloc(numthreads, sizeof(struct icp *));
+	job.items = malloc((batch->numgallery + batch->numprobes + 1) *
+	                   sizeof(struct batch_item));
+	atomic_init(&job.numaborted, 0);
+	atomic_init(&job.failed, 0);
+
+	if (job.engines == NULL || job.items == NULL) {
+		free(job.engines);
+		free(job.items);
+		return 0;
+	}
+
+	int ok = 1;
+
+	for (uint i = 0; i < numthreads && ok; i++) {
+		struct icp *config = batch->config;
+
+		job.engines[i] = icp_new(maxpts, config->metric);
+		ok = job.engines[i] != NULL;
+
+		if (ok) {
+			icp_set_robust(job.engines[i],
+			               config->trim,
+			               config->maxdist,
+			               config->kernel,
+			               config->scale);
+			icp_set_callback(job.engines[i], &batch_continue, batch);
+		}
+	}
+
+	batch->abort = abort;
+
+	if (ok) {
+		uint numitems = batch_items(batch, job.items);
+
+		parallel_for(numitems, numthreads, &batch_prepare, &job);
+
+		ok = !atomic_load(&job.failed);
+	}
+
+	if (ok)
+		parallel_for(numpairs, numthreads, &batch_register, &job);
+
+	batch->numaborted = atomic_load(&job.numaborted);
+
+	for (uint i = 0; i < numthreads; i++)
+		icp_free(&job.engines[i]);
+
+	free(job.engines);
+	free(job.items);
+
+	return ok;
+}
+
+uint batch_best(struct batch *batch, uint probe)
+{
+	uint best = batch->numgallery;
+	real min = INFINITY;
+
+	for (uint j = 0; j < batch->numgallery; j++) {
+		real score = dataframe_get(batch->scores, probe, j);
+
+		if (score < min) {
+			min = score;
+			best = j;
+		}
+	}
+
+	return best;
+}
+
+void batch_debug(struct batch *batch, FILE *output)
+{
+	fprintf(output,
+	        "probes: %u | gallery: %u | metric: %d | abort: %le | "
+	        "aborted: %u\n",
+	        batch->numprobes,
+	        batch->numgallery,
+	        batch->config->metric,
+	        batch->abort,
+	        batch->numaborted);
+
+	dataframe_debug(batch->scores, output);
+}
+
@@ -45,6 +45,29 @@ real calc_randr(real max)
 	return (real)rand() / (real)(RAND_MAX / max);
 }
 
+uint64_t calc_rand64(uint64_t *state)
+{
+	uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+	return z ^ (z >> 31);
+}
+
+real calc_randu(uint64_t *state)
+{
+	return (calc_rand64(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+real calc_randn(uint64_t *state)
+{
+	real u = 1.0 - calc_randu(state);
+	real v = calc_randu(state);
+
+	return sqrt(-2.0 * log(u)) * cos(2.0 * CALC_PI * v);
+}
+
 real calc_max2(real a, real b)
 {
 	return a > b ? a : b;
@@ -94,3 +117,43 @@ real calc_gaussian3(real x, real y, real z, real s)
 	return num / den;
 }
 
+static void calc_swap(uint *ids, uint a, uint b)
+{
+	uint tmp = ids[a];
+	ids[a] = ids[b];
+	ids[b] = tmp;
+}
+
+void calc_select(const real *c, uint *ids, uint begin, uint end, uint nth)
+{
+	while (end - begin > 1) {
+		real a = c[ids[begin]];
+		real b = c[ids[begin + (end - begin) / 2]];
+		real d = c[ids[end - 1]];
+		real pivot = (a < b) ? ((b < d) ? b : ((a < d) ? d : a)) :
+		                       ((a < d) ? a : ((b < d) ? d : b));
+
+		uint lt = begin;
+		uint i = begin;
+		uint gt = end;
+
+		while (i < gt) {
+			real v = c[ids[i]];
+
+			if (v < pivot)
+				calc_swap(ids, lt++, i++);
+			else if (v > pivot)
+				calc_swap(ids, i, --gt);
+			else
+				i++;
+		}
+
+		if (nth < lt)
+			end = lt;
+		else if (nth >= gt)
+			begin = gt;
+		else
+			return;
+	}
+}
+
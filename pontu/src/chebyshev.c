@@ -16,6 +16,23 @@ real chebyshev_poly(int p, uint n, real x)
 	return (num1 - num2) / p;
 }
 
+void chebyshev_poly_table(int p, uint n, real x, real *table)
+{
+	table[0] = 1.0;
+
+	if (p >= 1)
+		table[1] = x;
+
+	for (int i = 2; i <= p; i++) {
+		real num1 = ((2 * i) - 1) * x * table[i - 1];
+		real num2 = (i - 1) *
+		            (1 - (((i - 1) * (i - 1)) / (n * n))) *
+		            table[i - 2];
+
+		table[i] = (num1 - num2) / i;
+	}
+}
+
 real chebyshev_moment(int p, int q, int r, struct cloud *cloud)
 {
 	struct vector3 *centroid = cloud_get_centroid(cloud);
@@ -34,30 +51,87 @@ real chebyshev_moment(int p, int q, int r, struct cloud *cloud)
 	return moment;
 }
 
+#define CHEBYSHEV_KERNEL(name, NX, NY, NZ)                                    \
+static void name(struct cloud *cloud,                                        \
+                 struct vector3 *centroid,                                   \
+                 int *order,                                                 \
+                 real *moments)                                              \
+{                                                                             \
+	real tx[MOMENTCFG_MAXORD + 1];                                            \
+	real ty[MOMENTCFG_MAXORD + 1];                                            \
+	real tz[MOMENTCFG_MAXORD + 1];                                            \
+	uint n = cloud->numpts;                                                   \
+	                                                                          \
+	for (struct pointset *set = cloud->points; set != NULL; set = set->next) { \
+		real d = vector3_distance(set->point, centroid);                      \
+		uint col = 0;                                                         \
+		                                                                      \
+		chebyshev_poly_table(NX, n, set->point->x - centroid->x, tx);         \
+		chebyshev_poly_table(NY, n, set->point->y - centroid->y, ty);         \
+		chebyshev_poly_table(NZ, n, set->point->z - centroid->z, tz);         \
+		                                                                      \
+		MOMENTCFG_UNROLL                                                      \
+		for (int p = 0; p <= NX; p++)                                         \
+			MOMENTCFG_UNROLL                                                  \
+			for (int q = 0; q <= NY; q++)                                     \
+				MOMENTCFG_UNROLL                                              \
+				for (int r = 0; r <= NZ; r++)                                 \
+					moments[col++] += tx[p] * ty[q] * tz[r] * d;              \
+	}                                                                         \
+	                                                                          \
+	(void)order;                                                              \
+}
+
+CHEBYSHEV_KERNEL(chebyshev_kernel_1, 1, 1, 1)
+CHEBYSHEV_KERNEL(chebyshev_kernel_2, 2, 2, 2)
+CHEBYSHEV_KERNEL(chebyshev_kernel_3, 3, 3, 3)
+CHEBYSHEV_KERNEL(chebyshev_kernel_4, 4, 4, 4)
+CHEBYSHEV_KERNEL(chebyshev_kernel_n, order[0], order[1], order[2])
+
 struct dataframe *chebyshev_cloud_moments(struct cloud *cloud)
 {
-	int m = (CHEBYSHEV_ORDER_X + 1) *
-	        (CHEBYSHEV_ORDER_Y + 1) *
-	        (CHEBYSHEV_ORDER_Z + 1);
+	return chebyshev_cloud_moments_cfg(cloud, momentcfg_current());
+}
+
+struct dataframe *chebyshev_cloud_moments_cfg(struct cloud *cloud,
+                                              struct momentcfg *cfg)
+{
+	PROFILE_SCOPE(PROFILE_MOMENT);
+	PROFILE_POINTS(cloud->numpts);
+
+	int *order = cfg->chebyshev;
+	for (int i = 0; i < 3; i++)
+		if (order[i] < 0 || order[i] > MOMENTCFG_MAXORD)
+			return NULL;
+
+	int m = (order[0] + 1) * (order[1] + 1) * (order[2] + 1);
 	struct dataframe *results = dataframe_new(1, m);
+	if (results == NULL)
+		return NULL;
 
-	int p = 0;
-	int q = 0;
-	int r = 0;
-	int col = 0;
-
-	for (p = 0; p <= CHEBYSHEV_ORDER_X; p++) {
-		for (q = 0; q <= CHEBYSHEV_ORDER_Y; q++) {
-			for (r = 0; r <= CHEBYSHEV_ORDER_Z; r++) {
-				dataframe_set(results,
-				              0,
-				              col,
-				              chebyshev_moment(p, q, r, cloud));
-				col++;
-			}
-		}
+	struct vector3 *centroid = cloud_get_centroid(cloud);
+	int equal = order[0] == order[1] && order[1] == order[2];
+
+	switch (equal ? order[0] : -1) {
+	case 1:
+		chebyshev_kernel_1(cloud, centroid, order, results->data);
+		break;
+	case 2:
+		chebyshev_kernel_2(cloud, centroid, order, results->data);
+		break;
+	case 3:
+		chebyshev_kernel_3(cloud, centroid, order, results->data);
+		break;
+	case 4:
+		chebyshev_kernel_4(cloud, centroid, order, results->data);
+		break;
+	default:
+		chebyshev_kernel_n(cloud, centroid, order, results->data);
+		break;
 	}
 
+	vector3_free(&centroid);
+
 	return results;
 }
 
@@ -10,6 +10,11 @@ struct cloud *cloud_new()
 	cloud->numpts = 0;
 	cloud->centroid = vector3_zero();
 	cloud->tree = NULL;
+	cloud->array = NULL;
+	cloud->index = NULL;
+	cloud->normals = NULL;
+	cloud->curvature = NULL;
+	cloud->numattribs = 0;
 	
 	return cloud;
 }
@@ -22,19 +27,39 @@ void cloud_free(struct cloud **cloud)
 	pointset_free(&(*cloud)->points);
 	vector3_free(&(*cloud)->centroid);
 	octree_free(&(*cloud)->tree);
+	cloud_invalidate(*cloud);
+
+	for (uint a = 0; a < (*cloud)->numattribs; a++)
+		attrib_free(&(*cloud)->attribs[a]);
 	
 	free(*cloud);
 	*cloud = NULL;
 }
 
+static void cloud_pop_attribs(struct cloud *cloud, uint numattribs)
+{
+	for (uint a = 0; a < numattribs; a++)
+		attrib_pop(cloud->attribs[a]);
+}
+
 struct vector3 *cloud_insert_real(struct cloud *cloud, real x, real y, real z)
 {
+	for (uint a = 0; a < cloud->numattribs; a++) {
+		if (!attrib_push(cloud->attribs[a])) {
+			cloud_pop_attribs(cloud, a);
+			return NULL;
+		}
+	}
+
 	struct vector3 *i = pointset_insert(&cloud->points, x, y, z);
+	cloud_invalidate(cloud);
 	
-	if (i != NULL)
+	if (i != NULL) {
 		cloud->numpts++;
-	else
+	} else {
+		cloud_pop_attribs(cloud, cloud->numattribs);
 		return NULL;
+	}
 	
 	return i;
 }
@@ -49,8 +74,283 @@ uint cloud_size(struct cloud *cloud)
 	return cloud->numpts;
 }
 
+struct attrib *cloud_add_attrib(struct cloud *cloud,
+                                const char *name,
+                                int type,
+                                uint width)
+{
+	struct attrib *attrib = cloud_get_attrib(cloud, name);
+	if (attrib != NULL) {
+		if (attrib->type != type || attrib->width != width)
+			return NULL;
+
+		return attrib;
+	}
+
+	if (cloud->numattribs == CLOUD_MAXATTRIBS)
+		return NULL;
+
+	attrib = attrib_new(name, type, width);
+	if (attrib == NULL)
+		return NULL;
+
+	for (uint i = 0; i < cloud->numpts; i++) {
+		if (!attrib_push(attrib)) {
+			attrib_free(&attrib);
+			return NULL;
+		}
+	}
+
+	cloud->attribs[cloud->numattribs++] = attrib;
+
+	return attrib;
+}
+
+struct attrib *cloud_get_attrib(struct cloud *cloud, const char *name)
+{
+	for (uint a = 0; a < cloud->numattribs; a++)
+		if (!strncmp(cloud->attribs[a]->name, name, ATTRIB_MAXNAME - 1))
+			return cloud->attribs[a];
+
+	return NULL;
+}
+
+int cloud_remove_attrib(struct cloud *cloud, const char *name)
+{
+	for (uint a = 0; a < cloud->numattribs; a++) {
+		if (!strncmp(cloud->attribs[a]->name, name, ATTRIB_MAXNAME - 1)) {
+			attrib_free(&cloud->attribs[a]);
+			cloud->numattribs--;
+
+			for (uint b = a; b < cloud->numattribs; b++)
+				cloud->attribs[b] = cloud->attribs[b + 1];
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int cloud_copy_attribs(struct cloud *dst, struct cloud *src)
+{
+	for (uint a = 0; a < src->numattribs; a++) {
+		struct attrib *attrib = src->attribs[a];
+
+		if (cloud_get_attrib(dst, attrib->name) != NULL)
+			continue;
+
+		if (cloud_add_attrib(dst,
+		                     attrib->name,
+		                     attrib->type,
+		                     attrib->width) == NULL)
+			return 0;
+	}
+
+	return 1;
+}
+
+static struct vector3 *cloud_insert_row(struct cloud *dst,
+                                        struct cloud *src,
+                                        uint i,
+                                        struct vector3 *p)
+{
+	struct vector3 *q = cloud_insert_vector3(dst, p);
+	if (q == NULL)
+		return NULL;
+
+	for (uint a = 0; a < src->numattribs; a++) {
+		struct attrib *attrib = cloud_get_attrib(dst, src->attribs[a]->name);
+
+		if (attrib != NULL)
+			attrib_copy_row(attrib, 0, src->attribs[a], i);
+	}
+
+	return q;
+}
+
+static int cloud_read_row(struct cloud *cloud,
+                          const char *buffer,
+                          uint numcols,
+                          const uint *xyz,
+                          struct attrib **cols,
+                          const uint *comps)
+{
+	real values[CLOUD_MAXCOLUMNS] = {0.0};
+	const char *s = buffer;
+
+	for (uint c = 0; c < numcols; c++) {
+		char *end = NULL;
+		values[c] = strtod(s, &end);
+
+		if (end == s)
+			return 0;
+
+		s = end;
+	}
+
+	if (cloud_insert_real(cloud,
+	                      values[xyz[0]],
+	                      values[xyz[1]],
+	                      values[xyz[2]]) == NULL)
+		return 0;
+
+	for (uint c = 0; c < numcols; c++)
+		if (cols[c] != NULL)
+			attrib_set(cols[c], 0, comps[c], values[c]);
+
+	return 1;
+}
+
+static uint cloud_bind_fields(struct cloud *cloud,
+                              char names[][ATTRIB_MAXNAME],
+                              const int *types,
+                              const uint *counts,
+                              uint numfields,
+                              uint *xyz,
+                              struct attrib **cols,
+                              uint *comps)
+{
+	const char *axes[3] = {"x", "y", "z"};
+	uint found = 0;
+	uint c = 0;
+
+	for (uint f = 0; f < numfields; f++) {
+		if (c + counts[f] > CLOUD_MAXCOLUMNS)
+			break;
+
+		for (int k = 0; k < 3; k++) {
+			if (counts[f] == 1 && !strcmp(names[f], axes[k])) {
+				xyz[k] = c;
+				found |= 1 << k;
+			}
+		}
+
+		c += counts[f];
+	}
+
+	if (found != 7) {
+		xyz[0] = 0;
+		xyz[1] = 1;
+		xyz[2] = 2;
+	}
+
+	c = 0;
+	for (uint f = 0; f < numfields; f++) {
+		if (c + counts[f] > CLOUD_MAXCOLUMNS)
+			break;
+
+		int coord = c < 3;
+		if (found == 7)
+			coord = counts[f] == 1 &&
+			        (c == xyz[0] || c == xyz[1] || c == xyz[2]);
+
+		struct attrib *attrib = NULL;
+		if (!coord && strcmp(names[f], "_"))
+			attrib = cloud_add_attrib(cloud, names[f], types[f], counts[f]);
+
+		for (uint j = 0; j < counts[f]; j++) {
+			cols[c] = attrib;
+			comps[c] = j;
+			c++;
+		}
+	}
+
+	for (; c < 3; c++) {
+		cols[c] = NULL;
+		comps[c] = 0;
+	}
+
+	return c;
+}
+
+static int cloud_ply_type(const char *type)
+{
+	if (!strcmp(type, "uchar") || !strcmp(type, "uint8"))
+		return ATTRIB_UCHAR;
+
+	if (!strcmp(type, "ushort") || !strcmp(type, "uint16") ||
+	    !strcmp(type, "uint") || !strcmp(type, "uint32"))
+		return ATTRIB_UINT;
+
+	if (!strcmp(type, "char") || !strcmp(type, "int8") ||
+	    !strcmp(type, "short") || !strcmp(type, "int16") ||
+	    !strcmp(type, "int") || !strcmp(type, "int32"))
+		return ATTRIB_INT;
+
+	return ATTRIB_REAL;
+}
+
+static const char *cloud_ply_name(int type)
+{
+	switch (type) {
+	case ATTRIB_INT:
+		return "int";
+	case ATTRIB_UINT:
+		return "uint";
+	case ATTRIB_UCHAR:
+		return "uchar";
+	default:
+		return "float";
+	}
+}
+
+static int cloud_pcd_type(const char *type, const char *size)
+{
+	if (type[0] == 'I')
+		return ATTRIB_INT;
+
+	if (type[0] == 'U')
+		return atoi(size) == 1 ? ATTRIB_UCHAR : ATTRIB_UINT;
+
+	return ATTRIB_REAL;
+}
+
+static char cloud_pcd_name(int type)
+{
+	switch (type) {
+	case ATTRIB_INT:
+		return 'I';
+	case ATTRIB_UINT:
+	case ATTRIB_UCHAR:
+		return 'U';
+	default:
+		return 'F';
+	}
+}
+
+static uint cloud_tokens(const char *line,
+                         char tokens[][ATTRIB_MAXNAME],
+                         uint max)
+{
+	uint n = 0;
+	int len = 0;
+
+	line += strcspn(line, " \t\n");
+	while (n < max && sscanf(line, "%31s%n", tokens[n], &len) == 1) {
+		line += len;
+		n++;
+	}
+
+	return n;
+}
+
+static void cloud_print_row(struct cloud *cloud, uint i, FILE *file)
+{
+	for (uint a = 0; a < cloud->numattribs; a++) {
+		for (uint j = 0; j < cloud->attribs[a]->width; j++) {
+			fputc(' ', file);
+			attrib_print(cloud->attribs[a], i, j, file);
+		}
+	}
+
+	fputc('\n', file);
+}
+
 struct cloud *cloud_load_xyz(const char *filename)
 {
+	PROFILE_SCOPE(PROFILE_LOAD);
+
 	FILE *file = fopen(filename, "r");
 	if (file == NULL)
 		return NULL;
@@ -68,12 +368,15 @@ struct cloud *cloud_load_xyz(const char *filename)
 		cloud_insert_real(cloud, x, y, z);
 	
 	fclose(file);
-	
+	PROFILE_POINTS(cloud->numpts);
+
 	return cloud;
 }
 
 struct cloud *cloud_load_csv(const char *filename)
 {
+	PROFILE_SCOPE(PROFILE_LOAD);
+
 	FILE *file = fopen(filename, "r");
 	if (file == NULL)
 		return NULL;
@@ -91,12 +394,63 @@ struct cloud *cloud_load_csv(const char *filename)
 		cloud_insert_real(cloud, x, y, z);
 
 	fclose(file);
+	PROFILE_POINTS(cloud->numpts);
 
 	return cloud;
 }
 
+static int cloud_ply_component(const char *name, char *base)
+{
+	const char *sep = strrchr(name, '_');
+	if (sep == NULL || sep == name || sep[1] == '\0')
+		return -1;
+
+	for (const char *c = sep + 1; *c != '\0'; c++)
+		if (!isdigit((unsigned char)*c))
+			return -1;
+
+	size_t len = sep - name;
+	memcpy(base, name, len);
+	base[len] = '\0';
+
+	return atoi(sep + 1);
+}
+
+static int cloud_ply_group(char names[][ATTRIB_MAXNAME],
+                           const int *types,
+                           uint *counts,
+                           uint numfields)
+{
+	if (numfields < 2)
+		return 0;
+
+	char base[ATTRIB_MAXNAME];
+	char prevbase[ATTRIB_MAXNAME];
+	uint prev = numfields - 2;
+	int j = cloud_ply_component(names[numfields - 1], base);
+
+	if (j < 1 || (uint)j != counts[prev] || types[prev] != types[numfields - 1])
+		return 0;
+
+	if (counts[prev] == 1) {
+		if (cloud_ply_component(names[prev], prevbase) != 0 ||
+		    strcmp(base, prevbase))
+			return 0;
+
+		strcpy(names[prev], prevbase);
+	} else if (strcmp(base, names[prev])) {
+		return 0;
+	}
+
+	counts[prev]++;
+
+	return 1;
+}
+
 struct cloud *cloud_load_ply(const char *filename)
 {
+	PROFILE_SCOPE(PROFILE_LOAD);
+
 	uint numpts = 0;
 	char buffer[CLOUD_MAXBUFFER];
 
@@ -124,12 +478,36 @@ struct cloud *cloud_load_ply(const char *filename)
 		return NULL;
 	}
 
+	char names[CLOUD_MAXCOLUMNS][ATTRIB_MAXNAME];
+	char type[ATTRIB_MAXNAME];
+	int types[CLOUD_MAXCOLUMNS];
+	uint counts[CLOUD_MAXCOLUMNS];
+	uint numfields = 0;
+	int vertex = 0;
+	int list = 0;
+
 	while (fgets(buffer, CLOUD_MAXBUFFER, file)) {
 		if (!strcmp(buffer, "end_header\n"))
 			break;
 
-		if (!strncmp(buffer, "element vertex", 14))
-			sscanf(buffer, "element vertex %d\n", &numpts);
+		if (!strncmp(buffer, "element", 7)) {
+			vertex = !strncmp(buffer, "element vertex", 14);
+			if (vertex)
+				sscanf(buffer, "element vertex %d\n", &numpts);
+		} else if (vertex && !strncmp(buffer, "property list", 13)) {
+			list = 1;
+		} else if (vertex && !list && numfields < CLOUD_MAXCOLUMNS &&
+		           sscanf(buffer,
+		                  "property %31s %31s",
+		                  type,
+		                  names[numfields]) == 2) {
+			types[numfields] = cloud_ply_type(type);
+			counts[numfields] = 1;
+			numfields++;
+
+			if (cloud_ply_group(names, types, counts, numfields))
+				numfields--;
+		}
 	}
 
 	struct cloud *cloud = cloud_new();
@@ -138,25 +516,35 @@ struct cloud *cloud_load_ply(const char *filename)
 		return NULL;
 	}
 
-	real x = 0;
-	real y = 0;
-	real z = 0;
+	uint xyz[3];
+	struct attrib *cols[CLOUD_MAXCOLUMNS];
+	uint comps[CLOUD_MAXCOLUMNS];
+	uint numcols = cloud_bind_fields(cloud,
+	                                 names,
+	                                 types,
+	                                 counts,
+	                                 numfields,
+	                                 xyz,
+	                                 cols,
+	                                 comps);
+
 	for (uint i = 0; i < numpts; i++) {
-		if (fgets(buffer, CLOUD_MAXBUFFER, file)) {
-			sscanf(buffer, "%le %le %le %*s\n", &x, &y, &z);
-			cloud_insert_real(cloud, x, y, z);
-		} else {
+		if (fgets(buffer, CLOUD_MAXBUFFER, file))
+			cloud_read_row(cloud, buffer, numcols, xyz, cols, comps);
+		else
 			break;
-		}
 	}
 
 	fclose(file);
+	PROFILE_POINTS(cloud->numpts);
 
 	return cloud;
 }
 
 struct cloud *cloud_load_pcd(const char *filename)
 {
+	PROFILE_SCOPE(PROFILE_LOAD);
+
 	uint numpts = 0;
 	char buffer[CLOUD_MAXBUFFER];
 
@@ -164,12 +552,42 @@ struct cloud *cloud_load_pcd(const char *filename)
 	if (file == NULL)
 		return NULL;
 
+	char names[CLOUD_MAXCOLUMNS][ATTRIB_MAXNAME];
+	char sizes[CLOUD_MAXCOLUMNS][ATTRIB_MAXNAME];
+	char typenames[CLOUD_MAXCOLUMNS][ATTRIB_MAXNAME];
+	char countnames[CLOUD_MAXCOLUMNS][ATTRIB_MAXNAME];
+	int types[CLOUD_MAXCOLUMNS];
+	uint counts[CLOUD_MAXCOLUMNS];
+	uint numfields = 0;
+	uint numsizes = 0;
+	uint numtypes = 0;
+	uint numcounts = 0;
+
 	while (fgets(buffer, CLOUD_MAXBUFFER, file)) {
 		if (!strcmp(buffer, "DATA ascii\n"))
 			break;
 
 		if (!strncmp(buffer, "POINTS", 6))
 			sscanf(buffer, "POINTS %d\n", &numpts);
+		else if (!strncmp(buffer, "FIELDS", 6))
+			numfields = cloud_tokens(buffer, names, CLOUD_MAXCOLUMNS);
+		else if (!strncmp(buffer, "SIZE", 4))
+			numsizes = cloud_tokens(buffer, sizes, CLOUD_MAXCOLUMNS);
+		else if (!strncmp(buffer, "TYPE", 4))
+			numtypes = cloud_tokens(buffer, typenames, CLOUD_MAXCOLUMNS);
+		else if (!strncmp(buffer, "COUNT", 5))
+			numcounts = cloud_tokens(buffer, countnames, CLOUD_MAXCOLUMNS);
+	}
+
+	for (uint f = 0; f < numfields; f++) {
+		types[f] = ATTRIB_REAL;
+		if (f < numtypes)
+			types[f] = cloud_pcd_type(typenames[f],
+			                          f < numsizes ? sizes[f] : "4");
+
+		counts[f] = f < numcounts ? (uint)atoi(countnames[f]) : 1;
+		if (counts[f] == 0)
+			counts[f] = 1;
 	}
 
 	struct cloud *cloud = cloud_new();
@@ -178,25 +596,35 @@ struct cloud *cloud_load_pcd(const char *filename)
 		return NULL;
 	}
 
-	real x = 0;
-	real y = 0;
-	real z = 0;
+	uint xyz[3];
+	struct attrib *cols[CLOUD_MAXCOLUMNS];
+	uint comps[CLOUD_MAXCOLUMNS];
+	uint numcols = cloud_bind_fields(cloud,
+	                                 names,
+	                                 types,
+	                                 counts,
+	                                 numfields,
+	                                 xyz,
+	                                 cols,
+	                                 comps);
+
 	for (uint i = 0; i < numpts; i++) {
-		if (fgets(buffer, CLOUD_MAXBUFFER, file)) {
-			sscanf(buffer, "%le %le %le %*s\n", &x, &y, &z);
-			cloud_insert_real(cloud, x, y, z);
-		} else {
+		if (fgets(buffer, CLOUD_MAXBUFFER, file))
+			cloud_read_row(cloud, buffer, numcols, xyz, cols, comps);
+		else
 			break;
-		}
 	}
 
 	fclose(file);
+	PROFILE_POINTS(cloud->numpts);
 
 	return cloud;
 }
 
 struct cloud *cloud_load_obj(const char *filename)
 {
+	PROFILE_SCOPE(PROFILE_LOAD);
+
 	FILE *file = fopen(filename, "r");
 	if (file == NULL)
 		return NULL;
@@ -221,10 +649,29 @@ struct cloud *cloud_load_obj(const char *filename)
 	}
 
 	fclose(file);
+	PROFILE_POINTS(cloud->numpts);
 
 	return cloud;
 }
 
+struct cloud *cloud_load(const char *filename)
+{
+	const char *ext = strrchr(filename, '.');
+	if (ext == NULL)
+		return cloud_load_xyz(filename);
+
+	if (!strcmp(ext, ".csv"))
+		return cloud_load_csv(filename);
+	else if (!strcmp(ext, ".ply"))
+		return cloud_load_ply(filename);
+	else if (!strcmp(ext, ".pcd"))
+		return cloud_load_pcd(filename);
+	else if (!strcmp(ext, ".obj"))
+		return cloud_load_obj(filename);
+	else
+		return cloud_load_xyz(filename);
+}
+
 int cloud_save_xyz(struct cloud *cloud, const char *filename)
 {
 	FILE *file = fopen(filename, "w");
@@ -273,12 +720,29 @@ int cloud_save_ply(struct cloud *cloud, const char *filename)
 	fprintf(file, "property float x\n");
 	fprintf(file, "property float y\n");
 	fprintf(file, "property float z\n");
+
+	for (uint a = 0; a < cloud->numattribs; a++) {
+		struct attrib *attrib = cloud->attribs[a];
+
+		for (uint j = 0; j < attrib->width; j++) {
+			fprintf(file, "property %s %s", cloud_ply_name(attrib->type),
+			                                attrib->name);
+
+			if (attrib->width > 1)
+				fprintf(file, "_%u", j);
+
+			fprintf(file, "\n");
+		}
+	}
+
 	fprintf(file, "end_header\n");
 
+	uint i = 0;
 	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		fprintf(file, "%le %le %le\n", set->point->x,
-			                           set->point->y,
-			                           set->point->z);
+		fprintf(file, "%le %le %le", set->point->x,
+			                         set->point->y,
+			                         set->point->z);
+		cloud_print_row(cloud, i++, file);
 	}
 
 	fclose(file);
@@ -293,20 +757,36 @@ int cloud_save_pcd(struct cloud *cloud, const char *filename)
 		return 0;
 
 	fprintf(file, "VERSION .7\n");
-	fprintf(file, "FIELDS x y z\n");
-	fprintf(file, "SIZE 4 4 4\n");
-	fprintf(file, "TYPE F F F\n");
-	fprintf(file, "COUNT 1 1 1\n");
+
+	fprintf(file, "FIELDS x y z");
+	for (uint a = 0; a < cloud->numattribs; a++)
+		fprintf(file, " %s", cloud->attribs[a]->name);
+
+	fprintf(file, "\nSIZE 4 4 4");
+	for (uint a = 0; a < cloud->numattribs; a++)
+		fprintf(file, " %zu", attrib_sizeof(cloud->attribs[a]->type));
+
+	fprintf(file, "\nTYPE F F F");
+	for (uint a = 0; a < cloud->numattribs; a++)
+		fprintf(file, " %c", cloud_pcd_name(cloud->attribs[a]->type));
+
+	fprintf(file, "\nCOUNT 1 1 1");
+	for (uint a = 0; a < cloud->numattribs; a++)
+		fprintf(file, " %u", cloud->attribs[a]->width);
+
+	fprintf(file, "\n");
 	fprintf(file, "WIDTH %d\n", cloud->numpts);
 	fprintf(file, "HEIGHT 1\n");
 	fprintf(file, "VIEWPOINT 0 0 0 1 0 0 0\n");
 	fprintf(file, "POINTS %d\n", cloud->numpts);
 	fprintf(file, "DATA ascii\n");
 
+	uint i = 0;
 	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		fprintf(file, "%le %le %le\n", set->point->x,
-			                           set->point->y,
-			                           set->point->z);
+		fprintf(file, "%le %le %le", set->point->x,
+			                         set->point->y,
+			                         set->point->z);
+		cloud_print_row(cloud, i++, file);
 	}
 
 	fclose(file);
@@ -314,43 +794,306 @@ int cloud_save_pcd(struct cloud *cloud, const char *filename)
 	return 1;
 }
 
+int cloud_save(struct cloud *cloud, const char *filename)
+{
+	const char *ext = strrchr(filename, '.');
+	if (ext == NULL)
+		return cloud_save_xyz(cloud, filename);
+
+	if (!strcmp(ext, ".csv"))
+		return cloud_save_csv(cloud, filename);
+	else if (!strcmp(ext, ".ply"))
+		return cloud_save_ply(cloud, filename);
+	else if (!strcmp(ext, ".pcd"))
+		return cloud_save_pcd(cloud, filename);
+	else
+		return cloud_save_xyz(cloud, filename);
+}
+
 struct cloud *cloud_copy(struct cloud *cloud)
 {
 	struct cloud *cpy = cloud_new();
 	if (cpy == NULL)
 		return NULL;
+
+	if (!cloud_copy_attribs(cpy, cloud)) {
+		cloud_free(&cpy);
+		return NULL;
+	}
 	
+	uint i = 0;
 	for (struct pointset *set = cloud->points; set != NULL; set = set->next)
-		cloud_insert_real(cpy, set->point->x, set->point->y, set->point->z);
+		cloud_insert_row(cpy, cloud, i++, set->point);
 	
 	return cpy;
 }
 
+struct cloud *cloud_select(struct cloud *cloud, const uint *ids, uint numids)
+{
+	struct pointarray *array = cloud_pack(cloud);
+	if (array == NULL)
+		return NULL;
+
+	struct cloud *sub = cloud_new();
+	if (sub == NULL)
+		return NULL;
+
+	if (!cloud_copy_attribs(sub, cloud)) {
+		cloud_free(&sub);
+		return NULL;
+	}
+
+	for (uint j = numids; j > 0; j--) {
+		uint i = ids[j - 1];
+
+		if (i >= array->numpts ||
+		    cloud_insert_row(sub, cloud, i, array->refs[i]) == NULL) {
+			cloud_free(&sub);
+			return NULL;
+		}
+	}
+
+	return sub;
+}
+
 void cloud_partitionate(struct cloud *cloud)
 {
 	if (cloud->tree == NULL) {
+		PROFILE_SCOPE(PROFILE_PARTITION);
+		PROFILE_POINTS(cloud->numpts);
+
 		cloud->tree = octree_new(cloud->points, cloud->numpts, 5);
 		octree_partitionate(cloud->tree);
 	}
 }
 
+struct pointarray *cloud_pack(struct cloud *cloud)
+{
+	if (cloud->array == NULL)
+		cloud->array = pointarray_from_pointset(cloud->points);
+
+	return cloud->array;
+}
+
+static void cloud_invalidate_index(struct cloud *cloud)
+{
+	kdindex_free(&cloud->index);
+	free(cloud->normals);
+	free(cloud->curvature);
+	cloud->normals = NULL;
+	cloud->curvature = NULL;
+}
+
+struct kdindex *cloud_index(struct cloud *cloud)
+{
+	if (cloud->index == NULL) {
+		PROFILE_SCOPE(PROFILE_PARTITION);
+
+		struct pointarray *array = cloud_pack(cloud);
+		if (array == NULL)
+			return NULL;
+
+		cloud->index = kdindex_new(array);
+		PROFILE_POINTS(array->numpts);
+	}
+
+	return cloud->index;
+}
+
+struct cloud_normal_job {
+	struct pointarray *array;
+	struct kdindex *index;
+	uint k;
+	real radius;
+	uint *ids;
+	real *dist;
+	real *normals;
+	real *curvature;
+};
+
+static void cloud_normal_point(uint i, uint thread, void *data)
+{
+	struct cloud_normal_job *job = data;
+	struct pointarray *array = job->array;
+	uint *ids = &job->ids[thread * job->k];
+	real *dist = &job->dist[thread * job->k];
+	real p[3] = {array->x[i], array->y[i], array->z[i]};
+	uint n = kdindex_knn(job->index, p, job->k, ids, dist);
+
+	if (job->radius > 0.0)
+		while (n > 0 && dist[n - 1] > job->radius * job->radius)
+			n--;
+
+	real *normal = &job->normals[3 * i];
+
+	if (n < 3) {
+		normal[0] = 0.0;
+		normal[1] = 0.0;
+		normal[2] = 0.0;
+		job->curvature[i] = 0.0;
+		return;
+	}
+
+	real mean[3] = {0.0, 0.0, 0.0};
+	for (uint j = 0; j < n; j++) {
+		mean[0] += array->x[ids[j]];
+		mean[1] += array->y[ids[j]];
+		mean[2] += array->z[ids[j]];
+	}
+
+	for (int a = 0; a < 3; a++)
+		mean[a] /= n;
+
+	struct mat3 cov = {{{0.0}}};
+	for (uint j = 0; j < n; j++) {
+		real d[3] = {array->x[ids[j]] - mean[0],
+		             array->y[ids[j]] - mean[1],
+		             array->z[ids[j]] - mean[2]};
+
+		for (int a = 0; a < 3; a++)
+			for (int b = a; b < 3; b++)
+				cov.m[a][b] += d[a] * d[b];
+	}
+
+	cov.m[1][0] = cov.m[0][1];
+	cov.m[2][0] = cov.m[0][2];
+	cov.m[2][1] = cov.m[1][2];
+
+	real values[3];
+	struct mat3 vectors;
+
+	mat3_sym_eigen(&cov, values, &vectors);
+
+	normal[0] = vectors.m[0][0];
+	normal[1] = vectors.m[1][0];
+	normal[2] = vectors.m[2][0];
+
+	real sum = values[0] + values[1] + values[2];
+	job->curvature[i] = sum > 0.0 ? fmax(values[0], 0.0) / sum : 0.0;
+}
+
+int cloud_estimate_normals(struct cloud *cloud, uint k, real radius)
+{
+	PROFILE_SPAN(__func__);
+
+	struct kdindex *index = cloud_index(cloud);
+	if (index == NULL || k < 3)
+		return 0;
+
+	struct pointarray *array = cloud->array;
+	uint numthreads = parallel_threads();
+	struct cloud_normal_job job;
+
+	job.array = array;
+	job.index = index;
+	job.k = k;
+	job.radius = radius;
+	job.ids = malloc(numthreads * k * sizeof(uint));
+	job.dist = malloc(numthreads * k * sizeof(real));
+	job.normals = malloc((3 * array->numpts + 1) * sizeof(real));
+	job.curvature = malloc((array->numpts + 1) * sizeof(real));
+
+	if (job.ids == NULL || job.dist == NULL ||
+	    job.normals == NULL || job.curvature == NULL) {
+		free(job.ids);
+		free(job.dist);
+		free(job.normals);
+		free(job.curvature);
+		return 0;
+	}
+
+	parallel_for(array->numpts, numthreads, &cloud_normal_point, &job);
+
+	free(job.ids);
+	free(job.dist);
+	free(cloud->normals);
+	free(cloud->curvature);
+	cloud->normals = job.normals;
+	cloud->curvature = job.curvature;
+
+	return 1;
+}
+
+real *cloud_normals(struct cloud *cloud, uint k)
+{
+	if (cloud->normals == NULL && !cloud_estimate_normals(cloud, k, 0.0))
+		return NULL;
+
+	return cloud->normals;
+}
+
+real *cloud_surface_variation(struct cloud *cloud)
+{
+	if (cloud->curvature == NULL &&
+	    !cloud_estimate_normals(cloud, CLOUD_NORMAL_K, 0.0))
+		return NULL;
+
+	return cloud->curvature;
+}
+
+int cloud_store_normals(struct cloud *cloud, uint k)
+{
+	real *normals = cloud_normals(cloud, k);
+	if (normals == NULL)
+		return 0;
+
+	const char *names[4] = {CLOUD_ATTRIB_NX,
+	                        CLOUD_ATTRIB_NY,
+	                        CLOUD_ATTRIB_NZ,
+	                        CLOUD_ATTRIB_CURVATURE};
+	real *channels[4];
+
+	for (int c = 0; c < 4; c++) {
+		struct attrib *attrib = cloud_add_attrib(cloud,
+		                                         names[c],
+		                                         ATTRIB_REAL,
+		                                         1);
+		if (attrib == NULL)
+			return 0;
+
+		channels[c] = attrib->data;
+	}
+
+	for (uint i = 0; i < cloud->numpts; i++) {
+		channels[0][i] = normals[3 * i];
+		channels[1][i] = normals[3 * i + 1];
+		channels[2][i] = normals[3 * i + 2];
+		channels[3][i] = cloud->curvature[i];
+	}
+
+	return 1;
+}
+
+void cloud_invalidate(struct cloud *cloud)
+{
+	pointarray_free(&cloud->array);
+	cloud_invalidate_index(cloud);
+}
+
+int cloud_reduce(struct cloud *cloud, struct simd_stats *stats)
+{
+	struct pointarray *array = cloud_pack(cloud);
+	if (array == NULL)
+		return 0;
+
+	simd_reduce(array, stats);
+
+	return 1;
+}
+
 struct vector3 *cloud_calc_centroid(struct cloud *cloud)
 {
+	struct simd_stats stats;
+
 	vector3_free(&cloud->centroid);
-	cloud->centroid = vector3_zero();
-	cloud->numpts = 0;
 
-	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		cloud->centroid->x += set->point->x;
-		cloud->centroid->y += set->point->y;
-		cloud->centroid->z += set->point->z;
-		
-		cloud->numpts++;
+	if (!cloud_reduce(cloud, &stats)) {
+		cloud->centroid = vector3_zero();
+		return cloud->centroid;
 	}
 
-	cloud->centroid->x /= cloud->numpts;
-	cloud->centroid->y /= cloud->numpts;
-	cloud->centroid->z /= cloud->numpts;
+	cloud->numpts = stats.numpts;
+	cloud->centroid = simd_stats_centroid(&stats);
 
 	return cloud->centroid;
 }
@@ -367,6 +1110,8 @@ void cloud_scale(struct cloud *cloud, real f)
 {
 	for (struct pointset *set = cloud->points; set != NULL; set = set->next)
 		vector3_scale(set->point, f);
+
+	cloud_invalidate(cloud);
 }
 
 void cloud_translate_vector_dir(struct cloud *cloud,
@@ -379,6 +1124,7 @@ void cloud_translate_vector_dir(struct cloud *cloud,
 		vector3_increase(set->point, t);
 	
 	vector3_free(&t);
+	cloud_invalidate(cloud);
 	cloud_calc_centroid(cloud);
 }
 
@@ -392,6 +1138,7 @@ void cloud_translate_vector(struct cloud *cloud, struct vector3 *dest)
 
 	vector3_free(&t);
 	vector3_free(&centroid);
+	cloud_invalidate(cloud);
 	cloud_calc_centroid(cloud);
 }
 
@@ -405,53 +1152,120 @@ void cloud_translate_real(struct cloud *cloud, real x, real y, real z)
 
 	vector3_free(&dest);
 	vector3_free(&t);
+	cloud_invalidate(cloud);
 	cloud_calc_centroid(cloud);
 }
 
 void cloud_transform(struct cloud *cloud, struct matrix* rt)
 {
-	struct matrix *cloud_mat = matrix_new(4, cloud->numpts);
-	if (cloud_mat == NULL) {
-		cloud_free(&cloud);
+	struct rigid3 rigid;
+
+	if (rigid3_from_matrix(rt, &rigid))
+		cloud_transform_rigid(cloud, &rigid);
+}
+
+static void cloud_rotate_normals(struct cloud *cloud, const struct mat3 *rot)
+{
+	const char *names[3] = {CLOUD_ATTRIB_NX, CLOUD_ATTRIB_NY, CLOUD_ATTRIB_NZ};
+	real *n[3];
+
+	for (int c = 0; c < 3; c++) {
+		struct attrib *attrib = cloud_get_attrib(cloud, names[c]);
+
+		if (attrib == NULL || attrib->type != ATTRIB_REAL ||
+		    attrib->width != 1)
+			return;
+
+		n[c] = attrib->data;
+	}
+
+	for (uint i = 0; i < cloud->numpts; i++) {
+		real x = n[0][i];
+		real y = n[1][i];
+		real z = n[2][i];
+
+		n[0][i] = rot->m[0][0] * x + rot->m[0][1] * y + rot->m[0][2] * z;
+		n[1][i] = rot->m[1][0] * x + rot->m[1][1] * y + rot->m[1][2] * z;
+		n[2][i] = rot->m[2][0] * x + rot->m[2][1] * y + rot->m[2][2] * z;
+	}
+}
+
+int cloud_transform_rigid(struct cloud *cloud, const struct rigid3 *rt)
+{
+	struct pointarray *array = cloud_pack(cloud);
+	if (array == NULL)
+		return 0;
+
+	simd_transform(array, rt);
+	cloud_invalidate_index(cloud);
+	cloud_rotate_normals(cloud, &rt->rot);
+
+	for (uint i = 0; i < array->numpts; i++) {
+		array->refs[i]->x = array->x[i];
+		array->refs[i]->y = array->y[i];
+		array->refs[i]->z = array->z[i];
+	}
+
+	return 1;
+}
+
+struct cloud_row {
+	struct vector3 *point;
+	uint row;
+};
+
+static int cloud_row_compare(const void *a, const void *b)
+{
+	uintptr_t pa = (uintptr_t)((const struct cloud_row *)a)->point;
+	uintptr_t pb = (uintptr_t)((const struct cloud_row *)b)->point;
+
+	return (pa > pb) - (pa < pb);
+}
+
+void cloud_sort(struct cloud *cloud, int axis)
+{
+	if (cloud->numattribs == 0 || cloud->numpts == 0) {
+		pointset_sort(cloud->points, axis);
+		cloud_invalidate(cloud);
 		return;
 	}
 
-	struct matrix *output_mat = matrix_new(4, cloud->numpts);
-	if (output_mat == NULL) {
-		matrix_free(&cloud_mat);
-		cloud_free(&cloud);
+	struct cloud_row *rows = malloc(cloud->numpts * sizeof(struct cloud_row));
+	uint *perm = malloc(cloud->numpts * sizeof(uint));
+
+	if (rows == NULL || perm == NULL) {
+		free(rows);
+		free(perm);
 		return;
 	}
-	
+
 	uint i = 0;
 	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		matrix_set(cloud_mat, 0, i, set->point->x);
-		matrix_set(cloud_mat, 1, i, set->point->y);
-		matrix_set(cloud_mat, 2, i, set->point->z);
-		matrix_set(cloud_mat, 3, i, 1.0);
-		
+		rows[i].point = set->point;
+		rows[i].row = i;
 		i++;
 	}
 
-	output_mat = algebra_mat_prod(rt, cloud_mat);
+	qsort(rows, cloud->numpts, sizeof(struct cloud_row), &cloud_row_compare);
+	pointset_sort(cloud->points, axis);
+	cloud_invalidate(cloud);
 
-	matrix_free(&cloud_mat);
-	
 	i = 0;
 	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		set->point->x = matrix_get(output_mat, 0, i);
-		set->point->y = matrix_get(output_mat, 1, i);
-		set->point->z = matrix_get(output_mat, 2, i);
-		
-		i++;
+		struct cloud_row key = {set->point, 0};
+		struct cloud_row *old = bsearch(&key,
+		                                rows,
+		                                cloud->numpts,
+		                                sizeof(struct cloud_row),
+		                                &cloud_row_compare);
+		perm[i++] = old->row;
 	}
 
-	matrix_free(&output_mat);
-}
+	for (uint a = 0; a < cloud->numattribs; a++)
+		attrib_permute(cloud->attribs[a], perm);
 
-void cloud_sort(struct cloud *cloud, int axis)
-{
-	pointset_sort(cloud->points, axis);
+	free(rows);
+	free(perm);
 }
 
 struct cloud *cloud_concat(struct cloud *c1, struct cloud *c2)
@@ -460,45 +1274,32 @@ struct cloud *cloud_concat(struct cloud *c1, struct cloud *c2)
 	if (cat == NULL)
 		return NULL;
 
+	if (!cloud_copy_attribs(cat, c1) || !cloud_copy_attribs(cat, c2)) {
+		cloud_free(&cat);
+		return NULL;
+	}
+
+	uint i = 0;
 	for (struct pointset *s1 = c1->points; s1 != NULL; s1 = s1->next)
-		cloud_insert_real(cat, s1->point->x, s1->point->y, s1->point->z);
+		cloud_insert_row(cat, c1, i++, s1->point);
 
+	i = 0;
 	for (struct pointset *s2 = c2->points; s2 != NULL; s2 = s2->next)
-		cloud_insert_real(cat, s2->point->x, s2->point->y, s2->point->z);
+		cloud_insert_row(cat, c2, i++, s2->point);
 
 	return cat;
 }
 
 struct vector3 *cloud_axis_size(struct cloud *cloud)
 {
-	if (cloud->numpts == 0)
-		return vector3_zero();
-	
-	real max_x = INFINITY;
-	real max_y = INFINITY;
-	real max_z = INFINITY;
-	real min_x = -INFINITY;
-	real min_y = -INFINITY;
-	real min_z = -INFINITY;
-
-	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		if (set->point->x > max_x)
-			max_x = set->point->x;
-		else if (set->point->x < min_x)
-			min_x = set->point->x;
+	struct simd_stats stats;
 
-		if (set->point->y > max_y)
-			max_y = set->point->y;
-		else if (set->point->y < min_y)
-			min_y = set->point->y;
-
-		if (set->point->z > max_z)
-			max_z = set->point->z;
-		else if (set->point->z < min_z)
-			min_z = set->point->z;
-	}
+	if (cloud->numpts == 0 || !cloud_reduce(cloud, &stats))
+		return vector3_zero();
 
-	return vector3_new(max_x - min_x, max_y - min_y, max_z - min_z);
+	return vector3_new(stats.max[0] - stats.min[0],
+	                   stats.max[1] - stats.min[1],
+	                   stats.max[2] - stats.min[2]);
 }
 
 real cloud_boundingbox_area(struct cloud *cloud)
@@ -526,11 +1327,12 @@ real cloud_boundingbox_volume(struct cloud *cloud)
 
 real cloud_function_volume(struct cloud *cloud)
 {
-	struct vector3 *centroid = cloud_get_centroid(cloud);
-	real vol = 0.0;
+	struct pointarray *array = cloud_pack(cloud);
+	if (array == NULL)
+		return 0.0;
 
-	for (struct pointset *set = cloud->points; set != NULL; set = set->next)
-		vol += vector3_distance(centroid, set->point);
+	struct vector3 *centroid = cloud_get_centroid(cloud);
+	real vol = simd_sum_distance(array, centroid);
 
 	vector3_free(&centroid);
 
@@ -542,11 +1344,19 @@ struct cloud *cloud_cut_radius(struct cloud *cloud, struct vector3 *p, real r)
 	struct cloud *sub = cloud_new();
 	if (sub == NULL)
 		return NULL;
+
+	if (!cloud_copy_attribs(sub, cloud)) {
+		cloud_free(&sub);
+		return NULL;
+	}
 	
 	real sq_r = r * r;
+	uint i = 0;
 	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
 		if (vector3_squared_distance(p, set->point) <= sq_r)
-			cloud_insert_real(sub, set->point->x, set->point->y, set->point->z);
+			cloud_insert_row(sub, cloud, i, set->point);
+
+		i++;
 	}
 
 	return sub;
@@ -568,9 +1378,17 @@ struct cloud *cloud_cut_plane(struct cloud *cloud, struct plane *plane)
 	if (sub == NULL)
 		return NULL;
 
+	if (!cloud_copy_attribs(sub, cloud)) {
+		cloud_free(&sub);
+		return NULL;
+	}
+
+	uint i = 0;
 	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
 		if (plane_on_direction(plane, set->point))
-			cloud_insert_real(sub, set->point->x, set->point->y, set->point->z);
+			cloud_insert_row(sub, cloud, i, set->point);
+
+		i++;
 	}
 	
 	return sub;
@@ -583,12 +1401,18 @@ int cloud_plane_partition(struct cloud *src,
 {
 	if (p1->numpts != 0 || p2->numpts != 0)
 		return 0;
+
+	if (!cloud_copy_attribs(p1, src) || !cloud_copy_attribs(p2, src))
+		return 0;
 	
+	uint i = 0;
 	for (struct pointset *set = src->points; set != NULL; set = set->next) {
 		if (plane_on_direction(plane, set->point))
-			cloud_insert_real(p1, set->point->x, set->point->y, set->point->z);
+			cloud_insert_row(p1, src, i, set->point);
 		else
-			cloud_insert_real(p2, set->point->x, set->point->y, set->point->z);
+			cloud_insert_row(p2, src, i, set->point);
+
+		i++;
 	}
 
 	return 1;
@@ -623,9 +1447,15 @@ struct cloud *cloud_cut_cylinder(struct cloud *cloud,
 	struct cloud *sub = cloud_new();
 	if (sub == NULL)
 		return NULL;
+
+	if (!cloud_copy_attribs(sub, cloud)) {
+		cloud_free(&sub);
+		return NULL;
+	}
 	
 	real dirl = vector3_length(dir);
 	real dist = 0.0;
+	uint i = 0;
 
 	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
 		struct vector3 *dot = vector3_sub(ref, set->point);
@@ -633,10 +1463,11 @@ struct cloud *cloud_cut_cylinder(struct cloud *cloud,
 
 		dist = vector3_length(cross) / dirl;
 		if (dist <= radius)
-			cloud_insert_vector3(sub, set->point);
+			cloud_insert_row(sub, cloud, i, set->point);
 
 		vector3_free(&dot);
 		vector3_free(&cross);
+		i++;
 	}
 
 	return sub;
@@ -650,12 +1481,20 @@ struct cloud *cloud_segment(struct cloud *cloud,
 	struct cloud *sub = cloud_new();
 	if (sub == NULL)
 		return NULL;
+
+	if (!cloud_copy_attribs(sub, cloud)) {
+		cloud_free(&sub);
+		return NULL;
+	}
 	
 	struct plane *plane = plane_new(dir, ref);
+	uint i = 0;
 
 	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
 		if (plane_distance2point(plane, set->point) <= epslon)
-			cloud_insert_real(sub, set->point->x, set->point->y, set->point->z);
+			cloud_insert_row(sub, cloud, i, set->point);
+
+		i++;
 	}
 	
 	plane_free(&plane);
@@ -728,109 +1567,61 @@ real cloud_nearest_neighbors_bruteforce(struct cloud* source,
 	return vector3_distance(*src_pt, *tgt_pt);
 }
 
-struct vector3 *cloud_min_x(struct cloud *cloud)
+static struct vector3 *cloud_extreme(struct cloud *cloud, int axis, int max)
 {
-	struct vector3 *v = NULL;
-	real min_x = -INFINITY;
-	
-	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		if (min_x > set->point->x) {
-			min_x = set->point->x;
-			v = set->point;
-		}
-	}
+	struct simd_stats stats;
 
-	return v;
+	if (!cloud_reduce(cloud, &stats) || stats.numpts == 0)
+		return NULL;
+
+	struct pointarray *array = cloud->array;
+	real *coords = axis == 0 ? array->x : (axis == 1 ? array->y : array->z);
+	real target = max ? stats.max[axis] : stats.min[axis];
+
+	for (uint i = 0; i < array->numpts; i++)
+		if (coords[i] == target)
+			return array->refs[i];
+
+	return NULL;
 }
 
-struct vector3 *cloud_min_y(struct cloud *cloud)
+struct vector3 *cloud_min_x(struct cloud *cloud)
 {
-	struct vector3 *v = NULL;
-	real min_y = -INFINITY;
-	
-	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		if (min_y > set->point->y) {
-			min_y = set->point->y;
-			v = set->point;
-		}
-	}
+	return cloud_extreme(cloud, 0, 0);
+}
 
-	return v;
+struct vector3 *cloud_min_y(struct cloud *cloud)
+{
+	return cloud_extreme(cloud, 1, 0);
 }
 
 struct vector3 *cloud_min_z(struct cloud *cloud)
 {
-	struct vector3 *v = NULL;
-	real min_z = -INFINITY;
-	
-	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		if (min_z > set->point->z) {
-			min_z = set->point->z;
-			v = set->point;
-		}
-	}
-
-	return v;
+	return cloud_extreme(cloud, 2, 0);
 }
 
 struct vector3 *cloud_max_x(struct cloud *cloud)
 {
-	struct vector3 *v = NULL;
-	real max_x = INFINITY;
-	
-	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		if (max_x < set->point->x) {
-			max_x = set->point->x;
-			v = set->point;
-		}
-	}
-
-	return v;
+	return cloud_extreme(cloud, 0, 1);
 }
 
 struct vector3 *cloud_max_y(struct cloud *cloud)
 {
-	struct vector3 *v = NULL;
-	real max_y = INFINITY;
-	
-	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		if (max_y < set->point->y) {
-			max_y = set->point->y;
-			v = set->point;
-		}
-	}
-
-	return v;
+	return cloud_extreme(cloud, 1, 1);
 }
 
 struct vector3 *cloud_max_z(struct cloud *cloud)
 {
-	struct vector3 *v = NULL;
-	real max_z = INFINITY;
-	
-	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		if (max_z < set->point->z) {
-			max_z = set->point->z;
-			v = set->point;
-		}
-	}
-
-	return v;
+	return cloud_extreme(cloud, 2, 1);
 }
 
 real cloud_max_distance(struct cloud *cloud, struct vector3 *p)
 {
-	real dist = INFINITY;
-	real temp = 0.0;
-
-	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
-		temp = vector3_squared_distance(p, set->point);
-
-		if (temp > dist)
-			dist = temp;
-	}
+	struct pointarray *array = cloud_pack(cloud);
+	if (array == NULL)
+		return 0.0;
 
-	return sqrt(dist);
+	return sqrt(simd_max_squared_distance(array, p));
 }
 
 real cloud_max_distance_from_centroid(struct cloud *cloud)
@@ -0,0 +1,180 @@
+#include <sys/stat.h>
+
+#include "../include/cloudcache.h"
+
+static time_t cloudcache_mtime(const char *path)
+{
+	struct stat st;
+
+	if (stat(path, &st) != 0)
+		return (time_t)-1;
+
+	return st.st_mtime;
+}
+
+static void cloudcache_unlink(struct cloudcache *cache,
+                              struct cloudcache_entry *entry)
+{
+	if (entry->prev != NULL)
+		entry->prev->next = entry->next;
+	else
+		cache->head = entry->next;
+
+	if (entry->next != NULL)
+		entry->next->prev = entry->prev;
+	else
+		cache->tail = entry->prev;
+
+	entry->prev = NULL;
+	entry->next = NULL;
+}
+
+static void cloudcache_push_front(struct cloudcache *cache,
+                                  struct cloudcache_entry *entry)
+{
+	entry->prev = NULL;
+	entry->next = cache->head;
+
+	if (cache->head != NULL)
+		cache->head->prev = entry;
+	else
+		cache->tail = entry;
+
+	cache->head = entry;
+}
+
+static void cloudcache_entry_free(struct cloudcache_entry **entry)
+{
+	if (*entry == NULL)
+		return;
+
+	cloud_free(&(*entry)->cloud);
+	free(*entry);
+	*entry = NULL;
+}
+
+static struct cloudcache_entry *cloudcache_find(struct cloudcache *cache,
+                                                const char *path)
+{
+	for (struct cloudcache_entry *e = cache->head; e != NULL; e = e->next)
+		if (!strcmp(e->path, path))
+			return e;
+
+	return NULL;
+}
+
+struct cloudcache *cloudcache_new(uint capacity)
+{
+	struct cloudcache *cache = malloc(sizeof(struct cloudcache));
+	if (cache == NULL)
+		return NULL;
+
+	cache->head = NULL;
+	cache->tail = NULL;
+	cache->size = 0;
+	cache->capacity = capacity > 0 ? capacity : CLOUDCACHE_CAPACITY;
+	cache->hits = 0;
+	cache->misses = 0;
+
+	return cache;
+}
+
+void cloudcache_free(struct cloudcache **cache)
+{
+	if (*cache == NULL)
+		return;
+
+	struct cloudcache_entry *e = (*cache)->head;
+	while (e != NULL) {
+		struct cloudcache_entry *next = e->next;
+		cloudcache_entry_free(&e);
+		e = next;
+	}
+
+	free(*cache);
+	*cache = NULL;
+}
+
+struct cloud *cloudcache_get(struct cloudcache *cache, const char *path)
+{
+	if (strlen(path) >= CLOUDCACHE_MAXPATH)
+		return NULL;
+
+	time_t mtime = cloudcache_mtime(path);
+	struct cloudcache_entry *entry = cloudcache_find(cache, path);
+
+	if (entry != NULL) {
+		cloudcache_unlink(cache, entry);
+
+		if (entry->mtime == mtime) {
+			cloudcache_push_front(cache, entry);
+			cache->hits++;
+			return entry->cloud;
+		}
+
+		cloudcache_entry_free(&entry);
+		cache->size--;
+	}
+
+	cache->misses++;
+
+	struct cloud *cloud = cloud_load(path);
+	if (cloud == NULL)
+		return NULL;
+
+	cloud_partitionate(cloud);
+
+	entry = malloc(sizeof(struct cloudcache_entry));
+	if (entry == NULL) {
+		cloud_free(&cloud);
+		return NULL;
+	}
+
+	strcpy(entry->path, path);
+	entry->mtime = mtime;
+	entry->cloud = cloud;
+
+	while (cache->size >= cache->capacity && cache->tail != NULL) {
+		struct cloudcache_entry *lru = cache->tail;
+		cloudcache_unlink(cache, lru);
+		cloudcache_entry_free(&lru);
+		cache->size--;
+	}
+
+	cloudcache_push_front(cache, entry);
+	cache->size++;
+
+	return cloud;
+}
+
+int cloudcache_drop(struct cloudcache *cache, const char *path)
+{
+	struct cloudcache_entry *entry = cloudcache_find(cache, path);
+	if (entry == NULL)
+		return 0;
+
+	cloudcache_unlink(cache, entry);
+	cloudcache_entry_free(&entry);
+	cache->size--;
+
+	return 1;
+}
+
+void cloudcache_debug(struct cloudcache *cache, FILE *output)
+{
+	if (cache == NULL) {
+		fprintf(output, "!!! cloudcache empty !!!\n");
+		return;
+	}
+
+	fprintf(output,
+	        "size: %u/%u | hits: %u | misses: %u\n",
+	        cache->size,
+	        cache->capacity,
+	        cache->hits,
+	        cache->misses);
+
+	for (struct cloudcache_entry *e = cache->head; e != NULL; e = e->next)
+		fprintf(output, "%s (%u points)\n", e->path, e->cloud->numpts);
+}
+
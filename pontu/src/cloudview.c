@@ -0,0 +1,62 @@
+#include "../include/cloudview.h"
+
+struct cloudview *cloudview_new(struct cloud *cloud, uint numids)
+{
+	struct cloudview *view = malloc(sizeof(struct cloudview));
+	if (view == NULL)
+		return NULL;
+
+	view->ids = malloc((numids + 1) * sizeof(uint));
+	if (view->ids == NULL) {
+		free(view);
+		return NULL;
+	}
+
+	view->cloud = cloud;
+	view->numids = numids;
+
+	return view;
+}
+
+void cloudview_free(struct cloudview **view)
+{
+	if (*view == NULL)
+		return;
+
+	free((*view)->ids);
+	free(*view);
+	*view = NULL;
+}
+
+struct vector3 *cloudview_point(struct cloudview *view, uint j)
+{
+	struct pointarray *array = cloud_pack(view->cloud);
+
+	if (array == NULL || j >= view->numids || view->ids[j] >= array->numpts)
+		return NULL;
+
+	return array->refs[view->ids[j]];
+}
+
+struct cloud *cloudview_materialize(struct cloudview *view)
+{
+	return cloud_select(view->cloud, view->ids, view->numids);
+}
+
+void cloudview_debug(struct cloudview *view, FILE *output)
+{
+	fprintf(output, "numids: %u of %u\n", view->numids, view->cloud->numpts);
+
+	for (uint j = 0; j < view->numids; j++) {
+		struct vector3 *p = cloudview_point(view, j);
+
+		if (p != NULL)
+			fprintf(output,
+			        "%u: %le %le %le\n",
+			        view->ids[j],
+			        p->x,
+			        p->y,
+			        p->z);
+	}
+}
+
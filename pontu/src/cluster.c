@@ -0,0 +1,314 @@
+#include "../include/cluster.h"
+
+struct cluster_job {
+	struct pointarray *array;
+	struct kdindex *index;
+	real radius;
+	atomic_uint *parent;
+	uint **ids;
+	uint *capacity;
+	atomic_int failed;
+};
+
+static uint cluster_find(atomic_uint *parent, uint i)
+{
+	while (1) {
+		uint p = atomic_load(&parent[i]);
+		if (p == i)
+			return i;
+
+		uint g = atomic_load(&parent[p]);
+		if (g != p)
+			atomic_compare_exchange_weak(&parent[i], &p, g);
+
+		i = g;
+	}
+}
+
+static void cluster_union(atomic_uint *parent, uint a, uint b)
+{
+	while (1) {
+		a = cluster_find(parent, a);
+		b = cluster_find(parent, b);
+
+		if (a == b)
+			return;
+
+		if (a < b) {
+			uint t = a;
+			a = b;
+			b = t;
+		}
+
+		uint expected = a;
+		if (atomic_compare_exchange_weak(&parent[a], &expected, b))
+			return;
+	}
+}
+
+static void cluster_point(uint i, uint thread, void *data)
+{
+	struct cluster_job *job = data;
+	struct pointarray *array = job->array;
+	real p[3] = {array->x[i], array->y[i], array->z[i]};
+	uint n = kdindex_radius(job->index,
+	                        p,
+	                        job->radius,
+	                        job->ids[thread],
+	                        NULL,
+	                        job->capacity[thread]);
+
+	if (n > job->capacity[thread]) {
+		uint *ids = realloc(job->ids[thread], n * sizeof(uint));
+		if (ids == NULL) {
+			atomic_store(&job->failed, 1);
+			return;
+		}
+
+		job->ids[thread] = ids;
+		job->capacity[thread] = n;
+		n = kdindex_radius(job->index, p, job->radius, ids, NULL, n);
+	}
+
+	uint *ids = job->ids[thread];
+
+	for (uint j = 0; j < n; j++)
+		if (ids[j] > i)
+			cluster_union(job->parent, i, ids[j]);
+}
+
+static int cluster_connect(struct cloud *cloud,
+                           real radius,
+                           atomic_uint *parent)
+{
+	struct kdindex *index = cloud_index(cloud);
+	if (index == NULL)
+		return 0;
+
+	uint numthreads = parallel_threads();
+	struct cluster_job job;
+
+	job.array = cloud->array;
+	job.index = index;
+	job.radius = radius;
+	job.parent = parent;
+	job.ids = calloc(numthreads, sizeof(uint *));
+	job.capacity = calloc(numthreads, sizeof(uint));
+	atomic_init(&job.failed, 0);
+
+	int ok = job.ids != NULL && job.capacity != NULL;
+
+	for (uint t = 0; ok && t < numthreads; t++) {
+		job.ids[t] = malloc(CLUSTER_NEIGHBORS * sizeof(uint));
+		job.capacity[t] = CLUSTER_NEIGHBORS;
+		ok = job.ids[t] != NULL;
+	}
+
+	if (ok) {
+		for (uint i = 0; i < cloud->numpts; i++)
+			atomic_init(&parent[i], i);
+
+		parallel_for(cloud->numpts, numthreads, &cluster_point, &job);
+		ok = !atomic_load(&job.failed);
+	}
+
+	for (uint t = 0; job.ids != NULL && t < numthreads; t++)
+		free(job.ids[t]);
+
+	free(job.ids);
+	free(job.capacity);
+
+	return ok;
+}
+
+static int cluster_compare(const void *a, const void *b)
+{
+	uint64_t i = *(const uint64_t *)a;
+	uint64_t j = *(const uint64_t *)b;
+
+	return (i > j) - (i < j);
+}
+
+static int cluster_label(struct cluster *clusters,
+                         atomic_uint *parent,
+                         uint minpts,
+                         uint maxpts)
+{
+	uint n = clusters->cloud->numpts;
+	uint *count = calloc(n + 1, sizeof(uint));
+	uint64_t *keys = malloc((n + 1) * sizeof(uint64_t));
+
+	if (count == NULL || keys == NULL) {
+		free(count);
+		free(keys);
+		return 0;
+	}
+
+	for (uint i = 0; i < n; i++) {
+		clusters->labels[i] = cluster_find(parent, i);
+		count[clusters->labels[i]]++;
+	}
+
+	uint numclusters = 0;
+
+	for (uint r = 0; r < n; r++) {
+		if (count[r] == 0 || count[r] < minpts ||
+		    (maxpts > 0 && count[r] > maxpts))
+			continue;
+
+		keys[numclusters++] = (uint64_t)(UINT_MAX - count[r]) << 32 | r;
+	}
+
+	qsort(keys, numclusters, sizeof(uint64_t), &cluster_compare);
+
+	clusters->sizes = malloc((numclusters + 1) * sizeof(uint));
+	if (clusters->sizes == NULL) {
+		free(count);
+		free(keys);
+		return 0;
+	}
+
+	for (uint c = 0; c < numclusters; c++)
+		clusters->sizes[c] = count[keys[c] & UINT_MAX];
+
+	for (uint r = 0; r < n; r++)
+		count[r] = CLUSTER_NONE;
+
+	for (uint c = 0; c < numclusters; c++)
+		count[keys[c] & UINT_MAX] = c;
+
+	for (uint i = 0; i < n; i++)
+		clusters->labels[i] = count[clusters->labels[i]];
+
+	clusters->numclusters = numclusters;
+
+	free(count);
+	free(keys);
+
+	return 1;
+}
+
+struct cluster *cluster_euclidean(struct cloud *cloud,
+                                  real radius,
+                                  uint minpts,
+                                  uint maxpts)
+{
+	PROFILE_SPAN(__func__);
+
+	struct cluster *clusters = malloc(sizeof(struct cluster));
+	if (clusters == NULL)
+		return NULL;
+
+	uint n = cloud->numpts;
+
+	clusters->cloud = cloud;
+	clusters->numclusters = 0;
+	clusters->labels = malloc((n + 1) * sizeof(uint));
+	clusters->sizes = NULL;
+
+	atomic_uint *parent = malloc((n + 1) * sizeof(atomic_uint));
+
+	if (clusters->labels == NULL || parent == NULL ||
+	    !cluster_connect(cloud, radius, parent) ||
+	    !cluster_label(clusters, parent, minpts, maxpts)) {
+		free(parent);
+		cluster_free(&clusters);
+		return NULL;
+	}
+
+	free(parent);
+
+	return clusters;
+}
+
+void cluster_free(struct cluster **clusters)
+{
+	if (*clusters == NULL)
+		return;
+
+	free((*clusters)->labels);
+	free((*clusters)->sizes);
+	free(*clusters);
+	*clusters = NULL;
+}
+
+struct cloudview *cluster_view(struct cluster *clusters, uint label)
+{
+	if (label >= clusters->numclusters)
+		return NULL;
+
+	struct cloudview *view = cloudview_new(clusters->cloud,
+	                                       clusters->sizes[label]);
+	if (view == NULL)
+		return NULL;
+
+	uint count = 0;
+
+	for (uint i = 0; i < clusters->cloud->numpts; i++)
+		if (clusters->labels[i] == label)
+			view->ids[count++] = i;
+
+	return view;
+}
+
+struct cloudview **cluster_views(struct cluster *clusters)
+{
+	uint numclusters = clusters->numclusters;
+	struct cloudview **views = calloc(numclusters + 1,
+	                                  sizeof(struct cloudview *));
+	if (views == NULL)
+		return NULL;
+
+	for (uint c = 0; c < numclusters; c++) {
+		views[c] = cloudview_new(clusters->cloud, clusters->sizes[c]);
+
+		if (views[c] == NULL) {
+			for (uint d = 0; d < c; d++)
+				cloudview_free(&views[d]);
+
+			free(views);
+			return NULL;
+		}
+
+		views[c]->numids = 0;
+	}
+
+	for (uint i = 0; i < clusters->cloud->numpts; i++) {
+		uint c = clusters->labels[i];
+
+		if (c != CLUSTER_NONE)
+			views[c]->ids[views[c]->numids++] = i;
+	}
+
+	return views;
+}
+
+struct cloud *cluster_largest(struct cloud *cloud, real radius)
+{
+	struct cluster *clusters = cluster_euclidean(cloud, radius, 1, 0);
+	if (clusters == NULL)
+		return NULL;
+
+	struct cloudview *view = cluster_view(clusters, 0);
+	struct cloud *sub = NULL;
+
+	if (view != NULL)
+		sub = cloudview_materialize(view);
+
+	cloudview_free(&view);
+	cluster_free(&clusters);
+
+	return sub;
+}
+
+void cluster_debug(struct cluster *clusters, FILE *output)
+{
+	fprintf(output,
+	        "numclusters: %u of %u points\n",
+	        clusters->numclusters,
+	        clusters->cloud->numpts);
+
+	for (uint c = 0; c < clusters->numclusters; c++)
+		fprintf(output, "cluster %u: %u points\n", c, clusters->sizes[c]);
+}
+
@@ -2,16 +2,18 @@
 
 struct dataframe *dataframe_new(uint rows, uint cols)
 {
-	struct dataframe *mat = malloc(sizeof(struct dataframe));
+	struct dataframe *mat = mem_alloc(MEM_DATAFRAME, sizeof(struct dataframe));
 	if (mat == NULL)
 		return NULL;
 
 	mat->rows = rows;
 	mat->cols = cols;
 	
-	mat->data = malloc(rows * cols * sizeof(real));
-	if (mat->data == NULL)
+	mat->data = mem_alloc(MEM_DATAFRAME, rows * cols * sizeof(real));
+	if (mat->data == NULL) {
+		mem_free(MEM_DATAFRAME, mat, sizeof(struct dataframe));
 		return NULL;
+	}
 
 	for (uint i = 0; i < rows; i++)
 		for (uint j = 0; j < cols; j++)
@@ -25,15 +27,20 @@ void dataframe_free(struct dataframe **mat)
 	if (*mat == NULL)
 		return;
 
-	free((*mat)->data);
+	mem_free(MEM_DATAFRAME,
+	         (*mat)->data,
+	         (*mat)->rows * (*mat)->cols * sizeof(real));
 	(*mat)->data = NULL;
-	free(*mat);
+	mem_free(MEM_DATAFRAME, *mat, sizeof(struct dataframe));
 	*mat = NULL;
 }
 
 int dataframe_add_row(struct dataframe *mat)
 {
-	real *row = realloc(mat->data, mat->cols * (mat->rows + 1) * sizeof(real));
+	real *row = mem_realloc(MEM_DATAFRAME,
+	                        mat->data,
+	                        mat->cols * mat->rows * sizeof(real),
+	                        mat->cols * (mat->rows + 1) * sizeof(real));
 
 	if (row != NULL) {
 		mat->data = row;
@@ -50,7 +57,8 @@ int dataframe_add_row(struct dataframe *mat)
 
 int dataframe_add_col(struct dataframe *mat)
 {
-	real *new_mat = malloc(mat->rows * (mat->cols + 1) * sizeof(real));
+	real *new_mat = mem_alloc(MEM_DATAFRAME,
+	                          mat->rows * (mat->cols + 1) * sizeof(real));
 	if (new_mat == NULL)
 		return 0;
 
@@ -63,7 +71,7 @@ int dataframe_add_col(struct dataframe *mat)
 			new_mat[(i * (mat->cols + 1)) + j] =
 			    mat->data[(i * mat->cols) + j];
 
-	free(mat->data);
+	mem_free(MEM_DATAFRAME, mat->data, mat->rows * mat->cols * sizeof(real));
 	
 	mat->data = new_mat;
 	mat->cols++;
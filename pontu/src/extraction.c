@@ -4,6 +4,9 @@ struct dataframe *extraction_plane(struct cloud *cloud,
 				                struct dataframe *(*mfunc) (struct cloud *),
 				                struct vector3 *norm)
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct cloud *par1 = cloud_new();
 	struct cloud *par2 = cloud_new();
 	struct vector3 *pt = cloud_get_centroid(cloud);
@@ -29,6 +32,9 @@ struct dataframe *extraction_recursive(struct cloud *cloud,
 				                    struct dataframe *(*mfunc) (struct cloud *),
 				                    struct vector3 *norm)
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct cloud *par1 = cloud_new();
 	struct cloud *par2 = cloud_new();
 	struct vector3 *pt = cloud_get_centroid(cloud);
@@ -78,24 +84,36 @@ struct dataframe *extraction_recursive(struct cloud *cloud,
 struct dataframe *extraction_sagittal(struct cloud *cloud,
 				                   struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	return extraction_recursive(cloud, mfunc, vector3_new(1, 0, 0));
 }
 
 struct dataframe *extraction_transversal(struct cloud *cloud,
 				                    struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	return extraction_recursive(cloud, mfunc, vector3_new(0, 1, 0));
 }
 
 struct dataframe *extraction_frontal(struct cloud *cloud,
 				                  struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	return extraction_recursive(cloud, mfunc, vector3_new(0, 0, 1));
 }
 
 struct dataframe *extraction_radial(struct cloud *cloud,
 				                 struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct vector3 *nosetip = cloud_point_faraway_bestfit(cloud);
 	real slice = 25.0 * 25.0;
 
@@ -138,6 +156,9 @@ struct dataframe *extraction_radial(struct cloud *cloud,
 struct dataframe *extraction_upper(struct cloud *cloud,
 				                struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct vector3 *norm = vector3_new(0, 1, 0);
 	struct vector3 *point = cloud_point_faraway_bestfit(cloud);
 	struct plane *plane = plane_new(norm, point);
@@ -155,6 +176,9 @@ struct dataframe *extraction_upper(struct cloud *cloud,
 struct dataframe *extraction_lower(struct cloud *cloud,
 				                struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct vector3 *norm = vector3_new(0, -1, 0);
 	struct vector3 *point = cloud_point_faraway_bestfit(cloud);
 	struct plane *plane = plane_new(norm, point);
@@ -172,6 +196,9 @@ struct dataframe *extraction_lower(struct cloud *cloud,
 struct dataframe *extraction_manhattan(struct cloud *cloud,
 				                    struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct vector3 *nosetip = cloud_point_faraway_bestfit(cloud);
 	struct cloud *nose = cloud_new();
 	real d = 0.0;
@@ -194,6 +221,9 @@ struct dataframe *extraction_manhattan(struct cloud *cloud,
 struct dataframe *extraction_4(struct cloud *cloud,
 			                struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct vector3 *norm_sagit = vector3_new(1, 0, 0);
 	struct vector3 *centroid = cloud_get_centroid(cloud);
 	struct plane *plane_sagit = plane_new(norm_sagit, centroid);
@@ -247,6 +277,9 @@ struct dataframe *extraction_4(struct cloud *cloud,
 struct dataframe *extraction_6(struct cloud *cloud,
 			                struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct vector3 *norm_sagit = vector3_new(1, 0, 0);
 	struct vector3 *centroid = cloud_get_centroid(cloud);
 	struct plane *plane_sagit = plane_new(norm_sagit, centroid);
@@ -308,6 +341,9 @@ struct dataframe *extraction_6(struct cloud *cloud,
 struct dataframe *extraction_7(struct cloud *cloud,
 			                struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct vector3 *norm_sagit = vector3_new(1, 0, 0);
 	struct vector3 *centroid = cloud_get_centroid(cloud);
 	struct plane *plane_sagit = plane_new(norm_sagit, centroid);
@@ -403,6 +439,9 @@ struct cloud *extraction_vshape_base(struct cloud *cloud)
 struct dataframe *extraction_vshape(struct cloud *cloud,
 				                 struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct cloud *seg = extraction_vshape_base(cloud);
 	struct dataframe *ans = (*mfunc) (seg);
 
@@ -414,6 +453,9 @@ struct dataframe *extraction_vshape(struct cloud *cloud,
 struct dataframe *extraction_vshape_f(struct cloud *cloud,
 				                   struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct cloud *seg = extraction_vshape_base(cloud);
 	struct dataframe *ans = extraction_frontal(seg, mfunc);
 
@@ -425,6 +467,9 @@ struct dataframe *extraction_vshape_f(struct cloud *cloud,
 struct dataframe *extraction_vshape_s(struct cloud *cloud,
 				                   struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct cloud *seg = extraction_vshape_base(cloud);
 	struct dataframe *ans = extraction_sagittal(seg, mfunc);
 
@@ -436,6 +481,9 @@ struct dataframe *extraction_vshape_s(struct cloud *cloud,
 struct dataframe *extraction_vshape_t(struct cloud *cloud,
 				                   struct dataframe *(*mfunc) (struct cloud *))
 {
+	PROFILE_SCOPE(PROFILE_CUT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct cloud *seg = extraction_vshape_base(cloud);
 	struct dataframe *ans = extraction_transversal(seg, mfunc);
 
@@ -0,0 +1,226 @@
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "../include/featcache.h"
+#include "../include/hu.h"
+#include "../include/simd.h"
+
+static void featcache_path(struct featcache *cache,
+                           uint64_t key,
+                           char *path,
+                           const char *suffix)
+{
+	snprintf(path,
+	         FEATCACHE_MAXPATH + FEATCACHE_MAXNAME,
+	         "%s/%016llx.df%s",
+	         cache->dir,
+	         (unsigned long long)key,
+	         suffix);
+}
+
+struct featcache *featcache_new(const char *dir)
+{
+	if (strlen(dir) >= FEATCACHE_MAXPATH)
+		return NULL;
+
+	if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+		return NULL;
+
+	struct featcache *cache = malloc(sizeof(struct featcache));
+	if (cache == NULL)
+		return NULL;
+
+	strcpy(cache->dir, dir);
+	cache->hits = 0;
+	cache->misses = 0;
+
+	return cache;
+}
+
+void featcache_free(struct featcache **cache)
+{
+	if (*cache == NULL)
+		return;
+
+	free(*cache);
+	*cache = NULL;
+}
+
+uint64_t featcache_hash_bytes(const void *data, size_t size, uint64_t seed)
+{
+	const unsigned char *bytes = data;
+	uint64_t hash = seed;
+
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= FEATCACHE_FNV_PRIME;
+	}
+
+	return hash;
+}
+
+int featcache_hash_file(const char *filename, uint64_t *hash)
+{
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL)
+		return 0;
+
+	unsigned char buffer[1 << 16];
+	size_t n = 0;
+
+	*hash = FEATCACHE_FNV_OFFSET;
+	while ((n = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		*hash = featcache_hash_bytes(buffer, n, *hash);
+
+	fclose(file);
+
+	return 1;
+}
+
+uint64_t featcache_hash_orders(struct momentcfg *cfg)
+{
+	char orders[512];
+
+	int n = snprintf(orders,
+	                 sizeof(orders),
+	                 "v%d hu%d,%d leg%d cheb%d,%d,%d sph%d,%d,%d "
+	                 "zk%d,%d harm%d,%d,%d",
+	                 FEATCACHE_VERSION,
+	                 HU_MOMENTS,
+	                 HU_SUPERSET_MOMENTS,
+	                 cfg->legendre,
+	                 cfg->chebyshev[0],
+	                 cfg->chebyshev[1],
+	                 cfg->chebyshev[2],
+	                 cfg->spheric[0],
+	                 cfg->spheric[1],
+	                 cfg->spheric[2],
+	                 cfg->zernike_ord,
+	                 cfg->zernike_rep,
+	                 cfg->harmon_ord,
+	                 cfg->harmon_rep,
+	                 cfg->harmon_spin);
+
+	return featcache_hash_bytes(orders, n, FEATCACHE_FNV_OFFSET);
+}
+
+uint64_t featcache_key(uint64_t cloud,
+                       const char *moment,
+                       const char *cut)
+{
+	uint64_t key = featcache_hash_bytes(&cloud,
+	                                    sizeof(uint64_t),
+	                                    FEATCACHE_FNV_OFFSET);
+
+	uint64_t orders = featcache_hash_orders(momentcfg_current());
+	int32_t level = simd_level();
+
+	key = featcache_hash_bytes(&orders, sizeof(uint64_t), key);
+	key = featcache_hash_bytes(&level, sizeof(int32_t), key);
+	key = featcache_hash_bytes(moment, strlen(moment) + 1, key);
+	key = featcache_hash_bytes(cut, strlen(cut) + 1, key);
+
+	return key;
+}
+
+struct dataframe *featcache_load(struct featcache *cache, uint64_t key)
+{
+	char path[FEATCACHE_MAXPATH + FEATCACHE_MAXNAME];
+	featcache_path(cache, key, path, "");
+
+	FILE *file = fopen(path, "rb");
+	if (file == NULL) {
+		cache->misses++;
+		return NULL;
+	}
+
+	char magic[4];
+	uint32_t rows = 0;
+	uint32_t cols = 0;
+
+	if (fread(magic, 1, 4, file) != 4 ||
+	    memcmp(magic, FEATCACHE_MAGIC, 4) ||
+	    fread(&rows, sizeof(uint32_t), 1, file) != 1 ||
+	    fread(&cols, sizeof(uint32_t), 1, file) != 1) {
+		fclose(file);
+		cache->misses++;
+		return NULL;
+	}
+
+	struct stat info;
+	uint64_t size = 4 + 2 * sizeof(uint32_t) +
+	                (uint64_t)rows * cols * sizeof(real);
+
+	if (fstat(fileno(file), &info) != 0 || (uint64_t)info.st_size != size) {
+		fclose(file);
+		cache->misses++;
+		return NULL;
+	}
+
+	struct dataframe *df = dataframe_new(rows, cols);
+	if (df == NULL) {
+		fclose(file);
+		return NULL;
+	}
+
+	if (fread(df->data, sizeof(real), rows * cols, file) != rows * cols) {
+		dataframe_free(&df);
+		fclose(file);
+		cache->misses++;
+		return NULL;
+	}
+
+	fclose(file);
+	cache->hits++;
+
+	return df;
+}
+
+int featcache_store(struct featcache *cache, uint64_t key, struct dataframe *df)
+{
+	if (df == NULL)
+		return 0;
+
+	char path[FEATCACHE_MAXPATH + FEATCACHE_MAXNAME];
+	char temp[FEATCACHE_MAXPATH + FEATCACHE_MAXNAME];
+	featcache_path(cache, key, path, "");
+	featcache_path(cache, key, temp, ".XXXXXX");
+
+	int fd = mkstemp(temp);
+	if (fd < 0)
+		return 0;
+
+	FILE *file = fdopen(fd, "wb");
+	if (file == NULL || fchmod(fd, 0644) != 0) {
+		if (file != NULL)
+			fclose(file);
+		else
+			close(fd);
+
+		remove(temp);
+		return 0;
+	}
+
+	uint32_t rows = df->rows;
+	uint32_t cols = df->cols;
+
+	int ok = fwrite(FEATCACHE_MAGIC, 1, 4, file) == 4 &&
+	         fwrite(&rows, sizeof(uint32_t), 1, file) == 1 &&
+	         fwrite(&cols, sizeof(uint32_t), 1, file) == 1 &&
+	         fwrite(df->data, sizeof(real), rows * cols, file) == rows * cols;
+
+	if (fclose(file) != 0 || !ok) {
+		remove(temp);
+		return 0;
+	}
+
+	if (rename(temp, path) != 0) {
+		remove(temp);
+		return 0;
+	}
+
+	return 1;
+}
+
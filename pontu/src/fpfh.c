@@ -0,0 +1,313 @@
+#include "../include/fpfh.h"
+
+struct fpfh_job {
+	struct pointarray *array;
+	struct kdindex *index;
+	real *normals;
+	uint k;
+	uint *ids;
+	real *dist;
+	real *spfh;
+	real *hist;
+};
+
+static uint fpfh_bin(real f, real min, real max)
+{
+	int bin = (int)floor(FPFH_SUBBINS * (f - min) / (max - min));
+
+	if (bin < 0)
+		return 0;
+
+	return bin >= FPFH_SUBBINS ? FPFH_SUBBINS - 1 : (uint)bin;
+}
+
+static int fpfh_pair(const real *p1,
+                     const real *n1,
+                     const real *p2,
+                     const real *n2,
+                     real *f)
+{
+	real d[3] = {p2[0] - p1[0], p2[1] - p1[1], p2[2] - p1[2]};
+	real len = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+
+	if (len == 0.0)
+		return 0;
+
+	const real *u = n1;
+	const real *w = n2;
+	real a1 = (n1[0] * d[0] + n1[1] * d[1] + n1[2] * d[2]) / len;
+	real a2 = (n2[0] * d[0] + n2[1] * d[1] + n2[2] * d[2]) / len;
+
+	f[2] = a1;
+
+	if (fabs(a1) < fabs(a2)) {
+		u = n2;
+		w = n1;
+		d[0] = -d[0];
+		d[1] = -d[1];
+		d[2] = -d[2];
+		f[2] = -a2;
+	}
+
+	real v[3] = {d[1] * u[2] - d[2] * u[1],
+	             d[2] * u[0] - d[0] * u[2],
+	             d[0] * u[1] - d[1] * u[0]};
+	real vlen = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+
+	if (vlen == 0.0)
+		return 0;
+
+	v[0] /= vlen;
+	v[1] /= vlen;
+	v[2] /= vlen;
+
+	real x[3] = {u[1] * v[2] - u[2] * v[1],
+	             u[2] * v[0] - u[0] * v[2],
+	             u[0] * v[1] - u[1] * v[0]};
+
+	f[0] = atan2(x[0] * w[0] + x[1] * w[1] + x[2] * w[2],
+	             u[0] * w[0] + u[1] * w[1] + u[2] * w[2]);
+	f[1] = v[0] * w[0] + v[1] * w[1] + v[2] * w[2];
+
+	return 1;
+}
+
+static void fpfh_spfh(uint i, uint thread, void *data)
+{
+	struct fpfh_job *job = data;
+	struct pointarray *array = job->array;
+	uint *ids = &job->ids[i * job->k];
+	real *dist = &job->dist[i * job->k];
+	real *spfh = &job->spfh[i * FPFH_BINS];
+	uint near[job->k + 1];
+	real sqdist[job->k + 1];
+	real p[3] = {array->x[i], array->y[i], array->z[i]};
+	uint count = 0;
+
+	uint found = kdindex_knn(job->index, p, job->k + 1, near, sqdist);
+
+	for (uint j = 0; j < found && count < job->k; j++) {
+		if (near[j] == i)
+			continue;
+
+		ids[count] = near[j];
+		dist[count] = sqrt(sqdist[j]);
+		count++;
+	}
+
+	for (uint j = count; j < job->k; j++) {
+		ids[j] = i;
+		dist[j] = 0.0;
+	}
+
+	for (uint b = 0; b < FPFH_BINS; b++)
+		spfh[b] = 0.0;
+
+	uint pairs = 0;
+	real f[3];
+
+	for (uint j = 0; j < count; j++) {
+		uint n = ids[j];
+		real q[3] = {array->x[n], array->y[n], array->z[n]};
+
+		if (!fpfh_pair(p, &job->normals[3 * i], q, &job->normals[3 * n], f))
+			continue;
+
+		spfh[fpfh_bin(f[0], -CALC_PI, CALC_PI)] += 1.0;
+		spfh[FPFH_SUBBINS + fpfh_bin(f[1], -1.0, 1.0)] += 1.0;
+		spfh[2 * FPFH_SUBBINS + fpfh_bin(f[2], -1.0, 1.0)] += 1.0;
+		pairs++;
+	}
+
+	if (pairs > 0)
+		for (uint b = 0; b < FPFH_BINS; b++)
+			spfh[b] *= 100.0 / pairs;
+
+	(void)thread;
+}
+
+static void fpfh_weigh(uint i, uint thread, void *data)
+{
+	struct fpfh_job *job = data;
+	uint *ids = &job->ids[i * job->k];
+	real *dist = &job->dist[i * job->k];
+	real *hist = &job->hist[i * FPFH_BINS];
+	real *spfh = &job->spfh[i * FPFH_BINS];
+
+	for (uint b = 0; b < FPFH_BINS; b++)
+		hist[b] = spfh[b];
+
+	for (uint j = 0; j < job->k; j++) {
+		if (dist[j] == 0.0)
+			continue;
+
+		real w = 1.0 / (job->k * dist[j]);
+		real *other = &job->spfh[ids[j] * FPFH_BINS];
+
+		for (uint b = 0; b < FPFH_BINS; b++)
+			hist[b] += w * other[b];
+	}
+
+	for (uint s = 0; s < 3; s++) {
+		real *sub = &hist[s * FPFH_SUBBINS];
+		real sum = 0.0;
+
+		for (uint b = 0; b < FPFH_SUBBINS; b++)
+			sum += sub[b];
+
+		if (sum > 0.0)
+			for (uint b = 0; b < FPFH_SUBBINS; b++)
+				sub[b] *= 100.0 / sum;
+	}
+
+	(void)thread;
+}
+
+struct fpfh *fpfh_new(struct cloud *cloud, uint k)
+{
+	if (k == 0)
+		return NULL;
+
+	real *cached = cloud_normals(cloud, CLOUD_NORMAL_K);
+	struct kdindex *index = cloud_index(cloud);
+	struct pointarray *array = cloud_pack(cloud);
+
+	if (cached == NULL || index == NULL || array == NULL)
+		return NULL;
+
+	uint n = array->numpts;
+	struct fpfh *fpfh = malloc(sizeof(struct fpfh));
+	if (fpfh == NULL)
+		return NULL;
+
+	struct fpfh_job job = {array, index, NULL, k, NULL, NULL, NULL, NULL};
+
+	fpfh->numpts = n;
+	fpfh->hist = malloc((FPFH_BINS * n + 1) * sizeof(real));
+	job.normals = malloc((3 * n + 1) * sizeof(real));
+	job.ids = malloc((k * n + 1) * sizeof(uint));
+	job.dist = malloc((k * n + 1) * sizeof(real));
+	job.spfh = malloc((FPFH_BINS * n + 1) * sizeof(real));
+	job.hist = fpfh->hist;
+
+	if (fpfh->hist == NULL || job.normals == NULL || job.ids == NULL ||
+	    job.dist == NULL || job.spfh == NULL) {
+		free(job.normals);
+		free(job.ids);
+		free(job.dist);
+		free(job.spfh);
+		fpfh_free(&fpfh);
+		return NULL;
+	}
+
+	real c[3] = {0.0, 0.0, 0.0};
+
+	for (uint i = 0; i < n; i++) {
+		c[0] += array->x[i] / n;
+		c[1] += array->y[i] / n;
+		c[2] += array->z[i] / n;
+	}
+
+	for (uint i = 0; i < n; i++) {
+		real *m = &cached[3 * i];
+		real dot = m[0] * (array->x[i] - c[0]) +
+		           m[1] * (array->y[i] - c[1]) +
+		           m[2] * (array->z[i] - c[2]);
+		real sign = dot < 0.0 ? -1.0 : 1.0;
+
+		for (int j = 0; j < 3; j++)
+			job.normals[3 * i + j] = sign * m[j];
+	}
+
+	PROFILE_SPAN(__func__);
+
+	parallel_for(n, 0, &fpfh_spfh, &job);
+	parallel_for(n, 0, &fpfh_weigh, &job);
+
+	free(job.normals);
+	free(job.ids);
+	free(job.dist);
+	free(job.spfh);
+
+	return fpfh;
+}
+
+void fpfh_free(struct fpfh **fpfh)
+{
+	if (*fpfh == NULL)
+		return;
+
+	free((*fpfh)->hist);
+	free(*fpfh);
+	*fpfh = NULL;
+}
+
+struct fpfh *fpfh_gather(struct fpfh *fpfh,
+                         struct cloud *cloud,
+                         struct cloud *keys)
+{
+	struct kdindex *index = cloud_index(cloud);
+	struct pointarray *array = cloud_pack(keys);
+
+	if (index == NULL || array == NULL || index->numpts != fpfh->numpts)
+		return NULL;
+
+	struct fpfh *out = malloc(sizeof(struct fpfh));
+	if (out == NULL)
+		return NULL;
+
+	out->numpts = array->numpts;
+	out->hist = malloc((FPFH_BINS * array->numpts + 1) * sizeof(real));
+
+	if (out->hist == NULL) {
+		fpfh_free(&out);
+		return NULL;
+	}
+
+	for (uint i = 0; i < array->numpts; i++) {
+		real p[3] = {array->x[i], array->y[i], array->z[i]};
+		uint j = kdindex_nearest(index, p, NULL);
+
+		memcpy(&out->hist[i * FPFH_BINS],
+		       &fpfh->hist[j * FPFH_BINS],
+		       FPFH_BINS * sizeof(real));
+	}
+
+	return out;
+}
+
+uint fpfh_nearest(struct fpfh *fpfh, const real *hist, real *dist)
+{
+	uint best = 0;
+	real min = INFINITY;
+
+	for (uint i = 0; i < fpfh->numpts; i++) {
+		real *other = &fpfh->hist[i * FPFH_BINS];
+		real d = 0.0;
+
+		for (uint b = 0; b < FPFH_BINS && d < min; b++)
+			d += (hist[b] - other[b]) * (hist[b] - other[b]);
+
+		if (d < min) {
+			min = d;
+			best = i;
+		}
+	}
+
+	if (dist != NULL)
+		*dist = min;
+
+	return best;
+}
+
+void fpfh_debug(struct fpfh *fpfh, uint i, FILE *output)
+{
+	real *hist = &fpfh->hist[i * FPFH_BINS];
+
+	for (uint b = 0; b < FPFH_BINS; b++)
+		fprintf(output,
+		        "%.2lf%c",
+		        hist[b],
+		        (b + 1) % FPFH_SUBBINS == 0 ? '\n' : ' ');
+}
+
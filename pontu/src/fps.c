@@ -0,0 +1,266 @@
+#include "../include/fps.h"
+
+struct fps_job {
+	struct parallel_team *team;
+	struct pointarray *array;
+	real *mind;
+	uint chunk;
+	uint numchunks;
+	uint *best;
+	struct vector3 p;
+};
+
+static void fps_update(uint c, uint thread, void *data)
+{
+	struct fps_job *job = data;
+	uint begin = c * job->chunk;
+	uint end = begin + job->chunk;
+
+	if (end > job->array->numpts)
+		end = job->array->numpts;
+
+	job->best[c] = simd_update_farthest(job->array,
+	                                    begin,
+	                                    end,
+	                                    &job->p,
+	                                    job->mind);
+
+	(void)thread;
+}
+
+static uint fps_next(struct fps_job *job)
+{
+	if (job->numchunks == 1)
+		fps_update(0, 0, job);
+	else
+		parallel_team_run(job->team, job->numchunks, &fps_update, job);
+
+	uint best = job->best[0];
+
+	for (uint c = 1; c < job->numchunks; c++)
+		if (job->mind[job->best[c]] > job->mind[best])
+			best = job->best[c];
+
+	return best;
+}
+
+uint fps_select(struct pointarray *array, uint k, uint *ids)
+{
+	PROFILE_SPAN(__func__);
+
+	uint n = array->numpts;
+
+	k = k > n ? n : k;
+	if (k == 0)
+		return 0;
+
+	uint numthreads = n >= FPS_PARALLEL_MIN ? parallel_threads() : 1;
+	uint chunk = (n + numthreads - 1) / numthreads;
+	size_t size = ((n * sizeof(real)) / POINTARRAY_ALIGN + 1) *
+	              POINTARRAY_ALIGN;
+
+	struct fps_job job;
+
+	job.array = array;
+	job.chunk = ((chunk + SIMD_BLOCK - 1) / SIMD_BLOCK) * SIMD_BLOCK;
+	job.numchunks = (n + job.chunk - 1) / job.chunk;
+	job.mind = aligned_alloc(POINTARRAY_ALIGN, size);
+	job.best = malloc(job.numchunks * sizeof(uint));
+	job.team = NULL;
+
+	if (job.numchunks > 1)
+		job.team = parallel_team_new(job.numchunks);
+
+	if (job.mind == NULL || job.best == NULL ||
+	    (job.numchunks > 1 && job.team == NULL)) {
+		parallel_team_free(&job.team);
+		free(job.mind);
+		free(job.best);
+		return 0;
+	}
+
+	struct simd_stats stats;
+	simd_reduce(array, &stats);
+
+	job.p.x = stats.sum[0] / n;
+	job.p.y = stats.sum[1] / n;
+	job.p.z = stats.sum[2] / n;
+
+	for (uint i = 0; i < n; i++)
+		job.mind[i] = INFINITY;
+
+	ids[0] = fps_next(&job);
+
+	for (uint i = 0; i < n; i++)
+		job.mind[i] = INFINITY;
+
+	for (uint s = 1; s < k; s++) {
+		uint last = ids[s - 1];
+
+		job.mind[last] = -1.0;
+		job.p.x = array->x[last];
+		job.p.y = array->y[last];
+		job.p.z = array->z[last];
+
+		ids[s] = fps_next(&job);
+	}
+
+	parallel_team_free(&job.team);
+	free(job.mind);
+	free(job.best);
+
+	return k;
+}
+
+static int fps_compare(const void *a, const void *b)
+{
+	uint i = *(const uint *)a;
+	uint j = *(const uint *)b;
+
+	return (i > j) - (i < j);
+}
+
+static uint fps_hash(struct pointarray *array,
+                     const real *min,
+                     real size,
+                     uint64_t *keys,
+                     uint *reps,
+                     uint bits,
+                     uint limit)
+{
+	uint count = 0;
+
+	gridhash_clear(keys, bits);
+
+	for (uint i = 0; i < array->numpts && count <= limit; i++) {
+		uint64_t key = gridhash_key(gridhash_cell(array->x[i], min[0], size),
+		                            gridhash_cell(array->y[i], min[1], size),
+		                            gridhash_cell(array->z[i], min[2], size));
+		uint64_t h = gridhash_slot(keys, bits, key);
+
+		if (keys[h] == GRIDHASH_EMPTY) {
+			keys[h] = key;
+			reps[h] = i;
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static uint *fps_buckets(struct pointarray *array, uint m, uint *numreps)
+{
+	struct simd_stats stats;
+	simd_reduce(array, &stats);
+
+	real extent = 0.0;
+	for (int a = 0; a < 3; a++)
+		extent = fmax(extent, stats.max[a] - stats.min[a]);
+
+	if (!(extent > 0.0))
+		return NULL;
+
+	uint bits = 1;
+	while ((1ULL << bits) < 16ULL * m)
+		bits++;
+
+	uint64_t *keys = malloc((1ULL << bits) * sizeof(uint64_t));
+	uint *reps = malloc((1ULL << bits) * sizeof(uint));
+
+	if (keys == NULL || reps == NULL) {
+		free(keys);
+		free(reps);
+		return NULL;
+	}
+
+	real size = extent / ceil(cbrt(m));
+	uint count = 0;
+
+	for (uint t = 0; t < FPS_APPROX_TRIES && count < m; t++, size /= 2.0)
+		count = fps_hash(array, stats.min, size, keys, reps, bits, 8 * m);
+
+	*numreps = 0;
+
+	if (count >= m && count <= 8 * m)
+		for (uint64_t h = 0; h < (1ULL << bits); h++)
+			if (keys[h] != GRIDHASH_EMPTY)
+				reps[(*numreps)++] = reps[h];
+
+	free(keys);
+
+	qsort(reps, *numreps, sizeof(uint), &fps_compare);
+
+	return reps;
+}
+
+uint fps_select_approx(struct pointarray *array, uint k, uint *ids)
+{
+	PROFILE_SPAN(__func__);
+
+	if (k == 0 || k >= array->numpts / FPS_APPROX_FACTOR)
+		return fps_select(array, k, ids);
+
+	uint numreps = 0;
+	uint *reps = fps_buckets(array, FPS_APPROX_FACTOR * k, &numreps);
+
+	if (reps == NULL || numreps < k) {
+		free(reps);
+		return fps_select(array, k, ids);
+	}
+
+	struct pointarray *sub = pointarray_new(numreps);
+	if (sub == NULL) {
+		free(reps);
+		return 0;
+	}
+
+	for (uint j = 0; j < numreps; j++) {
+		sub->x[j] = array->x[reps[j]];
+		sub->y[j] = array->y[reps[j]];
+		sub->z[j] = array->z[reps[j]];
+		sub->refs[j] = array->refs[reps[j]];
+	}
+
+	uint numids = fps_select(sub, k, ids);
+
+	for (uint s = 0; s < numids; s++)
+		ids[s] = reps[ids[s]];
+
+	pointarray_free(&sub);
+	free(reps);
+
+	return numids;
+}
+
+static struct cloud *fps_cloud(struct cloud *cloud, uint k, int approx)
+{
+	struct pointarray *array = cloud_pack(cloud);
+	if (array == NULL)
+		return NULL;
+
+	uint *ids = malloc((k + 1) * sizeof(uint));
+	if (ids == NULL)
+		return NULL;
+
+	uint numids = approx ? fps_select_approx(array, k, ids) :
+	                       fps_select(array, k, ids);
+	struct cloud *sub = NULL;
+
+	if (numids > 0 || array->numpts == 0 || k == 0)
+		sub = cloud_select(cloud, ids, numids);
+
+	free(ids);
+
+	return sub;
+}
+
+struct cloud *fps_sampling(struct cloud *cloud, uint k)
+{
+	return fps_cloud(cloud, k, 0);
+}
+
+struct cloud *fps_sampling_approx(struct cloud *cloud, uint k)
+{
+	return fps_cloud(cloud, k, 1);
+}
+
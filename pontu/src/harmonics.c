@@ -215,93 +215,114 @@ real harmonics_moment_full(int n, int m, int l, real r, struct cloud *cloud)
 
 struct dataframe *harmonics_cloud_moments_odd(struct cloud *cloud)
 {
-	int s = harmonics_nummoments(HARMON_ORD, HARMON_REP, HARMON_SPIN);
-	struct dataframe *results = dataframe_new(1, s);
-	real r = cloud_max_distance_from_centroid(cloud);
-	real moment = 0.0;
-	
-	int col = 0;
-	for (int n = 0; n <= HARMON_ORD; n++) {
-		for (int m = 0; m <= HARMON_REP; m++) {
-			for (int l = 0; l <= HARMON_SPIN; l++) {
-				if (harmonics_conditions(n, m, l)) {
-					moment = harmonics_moment_odd(n, m, l, r, cloud);
-					dataframe_set(results, 0, col, moment);
-					col++;
-				}
-			}
-		}
-	}
-
-	return results;
+	return harmonics_cloud_moments_cfg(cloud,
+	                                   momentcfg_current(),
+	                                   ZERNIKE_KIND_ODD);
 }
 
 struct dataframe *harmonics_cloud_moments_even(struct cloud *cloud)
 {
-	int s = harmonics_nummoments(HARMON_ORD, HARMON_REP, HARMON_SPIN);
-	struct dataframe *results = dataframe_new(1, s);
-	real r = cloud_max_distance_from_centroid(cloud);
-	real moment = 0.0;
-	
-	int col = 0;
-	for (int n = 0; n <= HARMON_ORD; n++) {
-		for (int m = 0; m <= HARMON_REP; m++) {
-			for (int l = 0; l <= HARMON_SPIN; l++) {
-				if (harmonics_conditions(n, m, l)) {
-					moment = harmonics_moment_even(n, m, l, r, cloud);
-					dataframe_set(results, 0, col, moment);
-					col++;
-				}
-			}
-		}
-	}
-
-	return results;
+	return harmonics_cloud_moments_cfg(cloud,
+	                                   momentcfg_current(),
+	                                   ZERNIKE_KIND_EVEN);
 }
 
 struct dataframe *harmonics_cloud_moments_mag(struct cloud *cloud)
 {
-	int s = harmonics_nummoments(HARMON_ORD, HARMON_REP, HARMON_SPIN);
-	struct dataframe *results = dataframe_new(1, s);
-	real r = cloud_max_distance_from_centroid(cloud);
-	real moment = 0.0;
-	
-	int col = 0;
-	for (int n = 0; n <= HARMON_ORD; n++) {
-		for (int m = 0; m <= HARMON_REP; m++) {
-			for (int l = 0; l <= HARMON_SPIN; l++) {
-				if (harmonics_conditions(n, m, l)) {
-					moment = harmonics_moment_mag(n, m, l, r, cloud);
-					dataframe_set(results, 0, col, moment);
-					col++;
-				}
-			}
-		}
-	}
-
-	return results;
+	return harmonics_cloud_moments_cfg(cloud,
+	                                   momentcfg_current(),
+	                                   ZERNIKE_KIND_MAG);
 }
 
 struct dataframe *harmonics_cloud_moments_full(struct cloud *cloud)
 {
-	int s = harmonics_nummoments(HARMON_ORD, HARMON_REP, HARMON_SPIN);
+	return harmonics_cloud_moments_cfg(cloud,
+	                                   momentcfg_current(),
+	                                   ZERNIKE_KIND_FULL);
+}
+
+struct dataframe *harmonics_cloud_moments_cfg(struct cloud *cloud,
+                                              struct momentcfg *cfg,
+                                              int kind)
+{
+	PROFILE_SCOPE(PROFILE_MOMENT);
+	PROFILE_POINTS(cloud->numpts);
+
+	int ord = cfg->harmon_ord;
+	int rep = cfg->harmon_rep;
+	int spin = cfg->harmon_spin;
+	if (ord < 0 || ord > MOMENTCFG_MAXORD ||
+	    rep < 0 || rep > MOMENTCFG_MAXORD ||
+	    spin < 0 || spin > MOMENTCFG_MAXORD)
+		return NULL;
+
+	struct zernike_radial *radial = zernike_radial_new(ord, rep);
+	if (radial == NULL)
+		return NULL;
+
+	int s = harmonics_nummoments(ord, rep, spin);
 	struct dataframe *results = dataframe_new(1, s);
+	real *radpoly = malloc(radial->numpairs * sizeof(real));
+	if (results == NULL || radpoly == NULL) {
+		dataframe_free(&results);
+		free(radpoly);
+		zernike_radial_free(&radial);
+		return NULL;
+	}
+
+	real norm[MOMENTCFG_MAXORD + 1][MOMENTCFG_MAXORD + 1];
+	real harmonic[MOMENTCFG_MAXORD + 1][MOMENTCFG_MAXORD + 1];
+
+	for (int m = 0; m <= rep; m++)
+		for (int l = 0; l <= spin && l <= m; l++)
+			norm[m][l] = harmonics_norm(m, l);
+
+	struct vector3 *centroid = cloud_get_centroid(cloud);
 	real r = cloud_max_distance_from_centroid(cloud);
-	real moment = 0.0;
-	
-	int col = 0;
-	for (int n = 0; n <= HARMON_ORD; n++) {
-		for (int m = 0; m <= HARMON_REP; m++) {
-			for (int l = 0; l <= HARMON_SPIN; l++) {
-				if (harmonics_conditions(n, m, l)) {
-					moment = harmonics_moment_full(n, m, l, r, cloud);
-					dataframe_set(results, 0, col, moment);
-					col++;
-				}
+
+	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
+		real cx = set->point->x - centroid->x;
+		real cy = set->point->y - centroid->y;
+		real cz = set->point->z - centroid->z;
+		real d = vector3_distance(centroid, set->point);
+		real costheta = cos(zernike_azimuth(cy, cx));
+		real phi = zernike_zenith(cz, r);
+
+		for (int m = 0; m <= rep; m++) {
+			for (int l = 0; l <= spin && l <= m; l++) {
+				real sh = norm[m][l] * harmonics_legendrepoly(m, l, costheta);
+
+				if (kind == ZERNIKE_KIND_ODD)
+					sh = sh * sin(l * phi);
+				else if (kind == ZERNIKE_KIND_EVEN)
+					sh = sh * cos(l * phi);
+				else if (kind == ZERNIKE_KIND_FULL)
+					sh = sh * (cos(l * phi) + sin(l * phi));
+
+				harmonic[m][l] = sh;
+			}
+		}
+
+		zernike_radial_eval(radial, d / r, radpoly);
+
+		int col = 0;
+		for (int i = 0; i < radial->numpairs; i++) {
+			int m = radial->pairs[i].m;
+
+			for (int l = 0; l <= spin && l <= m; l++) {
+				results->data[col] += radpoly[i] * harmonic[m][l];
+				col++;
 			}
 		}
 	}
 
+	for (int i = 0; i < s; i++)
+		results->data[i] = (3.0 * results->data[i]) / (4.0 * CALC_PI);
+
+	vector3_free(&centroid);
+	free(radpoly);
+	zernike_radial_free(&radial);
+
 	return results;
 }
 
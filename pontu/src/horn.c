@@ -0,0 +1,200 @@
+#include <string.h>
+
+#include "../include/horn.h"
+
+static void horn_rotate(real a[4][4], real v[4][4], int p, int q)
+{
+	if (a[p][q] == 0.0)
+		return;
+
+	real theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+	real t = 1.0 / (fabs(theta) + hypot(theta, 1.0));
+	if (theta < 0.0)
+		t = -t;
+
+	real c = 1.0 / sqrt(t * t + 1.0);
+	real s = t * c;
+
+	for (int k = 0; k < 4; k++) {
+		real akp = a[k][p];
+		real akq = a[k][q];
+		a[k][p] = c * akp - s * akq;
+		a[k][q] = s * akp + c * akq;
+	}
+
+	for (int k = 0; k < 4; k++) {
+		real apk = a[p][k];
+		real aqk = a[q][k];
+		a[p][k] = c * apk - s * aqk;
+		a[q][k] = s * apk + c * aqk;
+	}
+
+	a[p][q] = 0.0;
+	a[q][p] = 0.0;
+
+	for (int k = 0; k < 4; k++) {
+		real vkp = v[k][p];
+		real vkq = v[k][q];
+		v[k][p] = c * vkp - s * vkq;
+		v[k][q] = s * vkp + c * vkq;
+	}
+}
+
+void horn_reset(struct horn *horn)
+{
+	memset(horn, 0, sizeof(struct horn));
+}
+
+void horn_add(struct horn *horn,
+              struct vector3 *source,
+              struct vector3 *target,
+              real weight)
+{
+	if (!(weight > 0.0))
+		return;
+
+	real ds[3];
+	real dt[3];
+
+	horn->numpts++;
+	horn->weight += weight;
+
+	real f = weight / horn->weight;
+
+	for (int i = 0; i < 3; i++) {
+		ds[i] = source->coord[i] - horn->source[i];
+		horn->source[i] += f * ds[i];
+		horn->target[i] += f * (target->coord[i] - horn->target[i]);
+		dt[i] = target->coord[i] - horn->target[i];
+	}
+
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			horn->cov[i][j] += weight * ds[i] * dt[j];
+}
+
+int horn_eigen4(real a[4][4], real values[4], real vectors[4][4])
+{
+	real norm = 0.0;
+
+	for (int i = 0; i < 4; i++) {
+		for (int j = 0; j < 4; j++) {
+			vectors[i][j] = (i == j) ? 1.0 : 0.0;
+			norm += a[i][j] * a[i][j];
+		}
+	}
+
+	int converged = 0;
+
+	for (int sweep = 0; sweep < HORN_SWEEPS && !converged; sweep++) {
+		real off = 0.0;
+		for (int p = 0; p < 3; p++)
+			for (int q = p + 1; q < 4; q++)
+				off += a[p][q] * a[p][q];
+
+		if (off <= HORN_EPS * HORN_EPS * norm) {
+			converged = 1;
+			break;
+		}
+
+		for (int p = 0; p < 3; p++)
+			for (int q = p + 1; q < 4; q++)
+				horn_rotate(a, vectors, p, q);
+	}
+
+	for (int i = 0; i < 4; i++)
+		values[i] = a[i][i];
+
+	return converged;
+}
+
+int horn_solve(struct horn *horn, struct rigid3 *rt)
+{
+	real (*r)[3] = rt->rot.m;
+	real (*s)[3] = horn->cov;
+	real q[4] = {1.0, 0.0, 0.0, 0.0};
+
+	if (horn->weight > 0.0) {
+		real tr = s[0][0] + s[1][1] + s[2][2];
+		real n[4][4] = {
+			{tr,
+			 s[1][2] - s[2][1],
+			 s[2][0] - s[0][2],
+			 s[0][1] - s[1][0]},
+			{s[1][2] - s[2][1],
+			 2.0 * s[0][0] - tr,
+			 s[0][1] + s[1][0],
+			 s[0][2] + s[2][0]},
+			{s[2][0] - s[0][2],
+			 s[0][1] + s[1][0],
+			 2.0 * s[1][1] - tr,
+			 s[1][2] + s[2][1]},
+			{s[0][1] - s[1][0],
+			 s[0][2] + s[2][0],
+			 s[1][2] + s[2][1],
+			 2.0 * s[2][2] - tr}
+		};
+
+		real values[4];
+		real vectors[4][4];
+
+		horn_eigen4(n, values, vectors);
+
+		int max = 0;
+		for (int i = 1; i < 4; i++)
+			if (values[i] > values[max])
+				max = i;
+
+		real mag = 0.0;
+		for (int i = 0; i < 4; i++) {
+			q[i] = vectors[i][max];
+			mag += q[i] * q[i];
+		}
+
+		mag = sqrt(mag);
+		for (int i = 0; i < 4; i++)
+			q[i] /= mag;
+	}
+
+	r[0][0] = q[0] * q[0] + q[1] * q[1] - q[2] * q[2] - q[3] * q[3];
+	r[0][1] = 2.0 * (q[1] * q[2] - q[0] * q[3]);
+	r[0][2] = 2.0 * (q[1] * q[3] + q[0] * q[2]);
+	r[1][0] = 2.0 * (q[1] * q[2] + q[0] * q[3]);
+	r[1][1] = q[0] * q[0] + q[2] * q[2] - q[1] * q[1] - q[3] * q[3];
+	r[1][2] = 2.0 * (q[2] * q[3] - q[0] * q[1]);
+	r[2][0] = 2.0 * (q[1] * q[3] - q[0] * q[2]);
+	r[2][1] = 2.0 * (q[2] * q[3] + q[0] * q[1]);
+	r[2][2] = q[0] * q[0] + q[3] * q[3] - q[1] * q[1] - q[2] * q[2];
+
+	for (int i = 0; i < 3; i++)
+		rt->t[i] = horn->target[i] -
+		           r[i][0] * horn->source[0] -
+		           r[i][1] * horn->source[1] -
+		           r[i][2] * horn->source[2];
+
+	return horn->weight > 0.0;
+}
+
+void horn_debug(struct horn *horn, FILE *output)
+{
+	fprintf(output,
+	        "numpts: %u, weight: %le\n"
+	        "source: %le %le %le\n"
+	        "target: %le %le %le\n",
+	        horn->numpts,
+	        horn->weight,
+	        horn->source[0],
+	        horn->source[1],
+	        horn->source[2],
+	        horn->target[0],
+	        horn->target[1],
+	        horn->target[2]);
+
+	for (int i = 0; i < 3; i++)
+		fprintf(output,
+		        "%le %le %le\n",
+		        horn->cov[i][0],
+		        horn->cov[i][1],
+		        horn->cov[i][2]);
+}
+
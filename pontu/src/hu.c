@@ -48,6 +48,9 @@ real hu_refined_moment(int p, int q, int r, struct cloud *cloud)
 
 struct dataframe *hu_cloud_moments_hu1980(struct cloud *cloud)
 {
+	PROFILE_SCOPE(PROFILE_MOMENT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct dataframe *results = dataframe_new(1, 3);
 
 	real hu200 = hu_refined_moment(2, 0, 0, cloud);
@@ -73,6 +76,9 @@ struct dataframe *hu_cloud_moments_hu1980(struct cloud *cloud)
 
 struct dataframe *hu_cloud_raw_moments(struct cloud *cloud, int p, int q, int r)
 {
+	PROFILE_SCOPE(PROFILE_MOMENT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct dataframe *ans = dataframe_new(1, (p + 1) * (q + 1) * (r + 1));
 	
 	int col = 0;
@@ -93,6 +99,9 @@ struct dataframe *hu_cloud_raw_moments(struct cloud *cloud, int p, int q, int r)
 
 struct dataframe *hu_cloud_moments_hututu(struct cloud *cloud)
 {
+	PROFILE_SCOPE(PROFILE_MOMENT);
+	PROFILE_POINTS(cloud->numpts);
+
 	struct dataframe *results = dataframe_new(1, HU_MOMENTS);
 	real i1;
 	real i2;
@@ -0,0 +1,539 @@
+#include "../include/icp.h"
+
+static real icp_seconds()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int icp_solve6(real (*a)[6], real *b, real *x)
+{
+	real l[6][6];
+	real y[6];
+
+	for (int j = 0; j < 6; j++) {
+		real sum = a[j][j];
+		for (int k = 0; k < j; k++)
+			sum -= l[j][k] * l[j][k];
+
+		if (!(sum > ICP_EPS * a[j][j]))
+			return 0;
+
+		l[j][j] = sqrt(sum);
+
+		for (int i = j + 1; i < 6; i++) {
+			real v = a[i][j];
+			for (int k = 0; k < j; k++)
+				v -= l[i][k] * l[j][k];
+
+			l[i][j] = v / l[j][j];
+		}
+	}
+
+	for (int i = 0; i < 6; i++) {
+		real v = b[i];
+		for (int k = 0; k < i; k++)
+			v -= l[i][k] * y[k];
+
+		y[i] = v / l[i][i];
+	}
+
+	for (int i = 5; i >= 0; i--) {
+		real v = y[i];
+		for (int k = i + 1; k < 6; k++)
+			v -= l[k][i] * x[k];
+
+		x[i] = v / l[i][i];
+	}
+
+	return 1;
+}
+
+struct icp *icp_new(uint numpts, int metric)
+{
+	struct icp *icp = malloc(sizeof(struct icp));
+	if (icp == NULL)
+		return NULL;
+
+	icp->metric = metric;
+	icp->numpts = 0;
+	icp->pairs = NULL;
+	icp->dist = NULL;
+	icp->weights = NULL;
+	icp->work = NULL;
+	icp->order = NULL;
+	icp->moved = NULL;
+	icp->trim = 1.0;
+	icp->maxdist = 0.0;
+	icp->kernel = ICP_KERNEL_NONE;
+	icp->scale = 0.0;
+	icp->rt = rigid3_identity();
+	icp->stopped = 0;
+	icp->callback = NULL;
+	icp->data = NULL;
+
+	memset(&icp->stats, 0, sizeof(struct icp_iteration));
+
+	if (!icp_reserve(icp, numpts)) {
+		icp_free(&icp);
+		return NULL;
+	}
+
+	return icp;
+}
+
+void icp_free(struct icp **icp)
+{
+	if (*icp == NULL)
+		return;
+
+	free((*icp)->pairs);
+	free((*icp)->dist);
+	free((*icp)->weights);
+	free((*icp)->work);
+	free((*icp)->order);
+	free((*icp)->moved);
+	free(*icp);
+	*icp = NULL;
+}
+
+int icp_reserve(struct icp *icp, uint numpts)
+{
+	if (numpts <= icp->numpts && icp->pairs != NULL)
+		return 1;
+
+	uint *pairs = realloc(icp->pairs, (numpts + 1) * sizeof(uint));
+	if (pairs == NULL)
+		return 0;
+
+	icp->pairs = pairs;
+
+	real *dist = realloc(icp->dist, (numpts + 1) * sizeof(real));
+	if (dist == NULL)
+		return 0;
+
+	icp->dist = dist;
+
+	real *weights = realloc(icp->weights, (numpts + 1) * sizeof(real));
+	if (weights == NULL)
+		return 0;
+
+	icp->weights = weights;
+
+	real *work = realloc(icp->work, (numpts + 1) * sizeof(real));
+	if (work == NULL)
+		return 0;
+
+	icp->work = work;
+
+	uint *order = realloc(icp->order, (numpts + 1) * sizeof(uint));
+	if (order == NULL)
+		return 0;
+
+	icp->order = order;
+
+	real *moved = realloc(icp->moved, 3 * (numpts + 1) * sizeof(real));
+	if (moved == NULL)
+		return 0;
+
+	icp->moved = moved;
+	icp->numpts = numpts;
+
+	return 1;
+}
+
+void icp_set_callback(struct icp *icp, icp_callback callback, void *data)
+{
+	icp->callback = callback;
+	icp->data = data;
+}
+
+void icp_set_robust(struct icp *icp,
+                    real trim,
+                    real maxdist,
+                    int kernel,
+                    real scale)
+{
+	icp->trim = trim > 0.0 && trim < 1.0 ? trim : 1.0;
+	icp->maxdist = maxdist;
+	icp->kernel = kernel;
+	icp->scale = scale;
+}
+
+static real icp_select(struct icp *icp, uint n, uint nth)
+{
+	calc_select(icp->work, icp->order, 0, n, nth);
+
+	return icp->work[icp->order[nth]];
+}
+
+static void icp_match(struct icp *icp,
+                      struct pointarray *src,
+                      struct kdindex *index)
+{
+	PROFILE_SPAN(__func__);
+
+	struct vector3 v;
+
+	for (uint i = 0; i < src->numpts; i++) {
+		real *p = &icp->moved[3 * i];
+
+		v.x = src->x[i];
+		v.y = src->y[i];
+		v.z = src->z[i];
+		v = rigid3_apply(&icp->rt, &v);
+
+		p[0] = v.x;
+		p[1] = v.y;
+		p[2] = v.z;
+
+		icp->pairs[i] = kdindex_nearest(index, p, &icp->dist[i]);
+	}
+}
+
+static real icp_weigh(struct icp *icp, uint n, uint *numpairs)
+{
+	real *w = icp->weights;
+	real gate = icp->maxdist > 0.0 ? icp->maxdist : INFINITY;
+	uint m = 0;
+
+	for (uint i = 0; i < n; i++) {
+		real r = sqrt(icp->dist[i]);
+
+		w[i] = r <= gate ? 1.0 : 0.0;
+		if (w[i] > 0.0) {
+			icp->order[m] = m;
+			icp->work[m++] = r;
+		}
+	}
+
+	*numpairs = 0;
+
+	if (m == 0)
+		return INFINITY;
+
+	real cut = gate;
+	uint keep = m;
+
+	if (icp->trim < 1.0) {
+		keep = (uint)ceil(icp->trim * m);
+		keep = keep == 0 ? 1 : keep;
+
+		if (keep < m)
+			cut = icp_select(icp, m, keep - 1);
+	}
+
+	real c = 0.0;
+
+	if (icp->kernel != ICP_KERNEL_NONE) {
+		real sigma = icp->scale;
+
+		if (!(sigma > 0.0))
+			sigma = ICP_MAD * icp_select(icp, keep, keep / 2);
+
+		c = sigma * (icp->kernel == ICP_TUKEY ? ICP_TUKEY_K : ICP_HUBER_K);
+	}
+
+	real err = 0.0;
+
+	for (uint i = 0; i < n; i++) {
+		if (w[i] == 0.0)
+			continue;
+
+		real r = sqrt(icp->dist[i]);
+
+		if (r > cut) {
+			w[i] = 0.0;
+			continue;
+		}
+
+		if (c > 0.0 && icp->kernel == ICP_HUBER) {
+			w[i] = r <= c ? 1.0 : c / r;
+		} else if (c > 0.0 && icp->kernel == ICP_TUKEY) {
+			real u = r / c;
+			w[i] = u < 1.0 ? (1.0 - u * u) * (1.0 - u * u) : 0.0;
+		}
+
+		if (w[i] == 0.0)
+			continue;
+
+		err += r;
+		(*numpairs)++;
+	}
+
+	return *numpairs > 0 ? err / *numpairs : INFINITY;
+}
+
+static void icp_step(struct icp *icp,
+                     struct pointarray *src,
+                     struct pointarray *tgt,
+                     real *tnormals,
+                     real *snormals)
+{
+	struct horn horn;
+	struct vector3 v;
+	struct vector3 w;
+
+	horn_reset(&horn);
+
+	for (uint i = 0; i < src->numpts; i++) {
+		uint j = icp->pairs[i];
+
+		v.x = icp->moved[3 * i];
+		v.y = icp->moved[3 * i + 1];
+		v.z = icp->moved[3 * i + 2];
+		w.x = tgt->x[j];
+		w.y = tgt->y[j];
+		w.z = tgt->z[j];
+
+		horn_add(&horn, &v, &w, icp->weights[i]);
+	}
+
+	struct rigid3 step = rigid3_identity();
+
+	if (tnormals == NULL) {
+		horn_solve(&horn, &step);
+		icp->rt = rigid3_compose(&step, &icp->rt);
+		return;
+	}
+
+	real *cp = horn.source;
+	real *cq = snormals != NULL ? horn.target : horn.source;
+	real a[6][6] = {{0.0}};
+	real b[6] = {0.0};
+
+	for (uint i = 0; i < src->numpts; i++) {
+		if (!(icp->weights[i] > 0.0))
+			continue;
+
+		uint j = icp->pairs[i];
+		real *n = &tnormals[3 * j];
+		real *m = &icp->moved[3 * i];
+		real nn[3] = {n[0], n[1], n[2]};
+		real p[3];
+		real q[3];
+		real arm[3];
+
+		p[0] = m[0] - cp[0];
+		p[1] = m[1] - cp[1];
+		p[2] = m[2] - cp[2];
+		q[0] = tgt->x[j] - cq[0];
+		q[1] = tgt->y[j] - cq[1];
+		q[2] = tgt->z[j] - cq[2];
+
+		for (int c = 0; c < 3; c++)
+			arm[c] = p[c];
+
+		if (snormals != NULL) {
+			real *s = &snormals[3 * i];
+			real ns[3];
+
+			for (int c = 0; c < 3; c++)
+				ns[c] = icp->rt.rot.m[c][0] * s[0] +
+				        icp->rt.rot.m[c][1] * s[1] +
+				        icp->rt.rot.m[c][2] * s[2];
+
+			real dot = ns[0] * n[0] + ns[1] * n[1] + ns[2] * n[2];
+			real sign = dot < 0.0 ? -1.0 : 1.0;
+
+			for (int c = 0; c < 3; c++) {
+				nn[c] += sign * ns[c];
+				arm[c] += q[c];
+			}
+		}
+
+		real jac[6] = {arm[1] * nn[2] - arm[2] * nn[1],
+		               arm[2] * nn[0] - arm[0] * nn[2],
+		               arm[0] * nn[1] - arm[1] * nn[0],
+		               nn[0],
+		               nn[1],
+		               nn[2]};
+
+		real r = (p[0] - q[0]) * nn[0] +
+		         (p[1] - q[1]) * nn[1] +
+		         (p[2] - q[2]) * nn[2];
+
+		for (int u = 0; u < 6; u++) {
+			real wj = icp->weights[i] * jac[u];
+
+			for (int e = 0; e <= u; e++)
+				a[u][e] += wj * jac[e];
+
+			b[u] -= wj * r;
+		}
+	}
+
+	real x[6];
+
+	if (!icp_solve6(a, b, x)) {
+		horn_solve(&horn, &step);
+		icp->rt = rigid3_compose(&step, &icp->rt);
+		return;
+	}
+
+	struct rigid3 rot = rigid3_identity();
+	struct rigid3 move = rigid3_identity();
+
+	rot.rot = mat3_rotation(x);
+
+	for (int c = 0; c < 3; c++) {
+		step.t[c] = -cp[c];
+		move.t[c] = x[3 + c];
+	}
+
+	step = rigid3_compose(&rot, &step);
+	step = rigid3_compose(&move, &step);
+
+	if (snormals != NULL)
+		step = rigid3_compose(&rot, &step);
+
+	for (int c = 0; c < 3; c++)
+		step.t[c] += cq[c];
+
+	icp->rt = rigid3_compose(&step, &icp->rt);
+}
+
+static int icp_run_level(struct icp *icp,
+                         struct cloud *source,
+                         struct cloud *target,
+                         real t,
+                         uint k,
+                         uint level)
+{
+	real *tnormals = NULL;
+	real *snormals = NULL;
+
+	if (icp->metric != ICP_POINT) {
+		tnormals = cloud_normals(target, CLOUD_NORMAL_K);
+		if (tnormals == NULL)
+			return 0;
+	}
+
+	if (icp->metric == ICP_SYMMETRIC) {
+		snormals = cloud_normals(source, CLOUD_NORMAL_K);
+		if (snormals == NULL)
+			return 0;
+	}
+
+	struct kdindex *index = cloud_index(target);
+	struct pointarray *tgt = cloud_pack(target);
+	struct pointarray *src = cloud_pack(source);
+
+	if (index == NULL || tgt == NULL || src == NULL || src->numpts == 0 ||
+	    tgt->numpts == 0 || !icp_reserve(icp, src->numpts))
+		return 0;
+
+	struct icp_iteration *stats = &icp->stats;
+	real last = INFINITY;
+
+	icp->stopped = 0;
+	stats->level = level;
+	stats->numpts = src->numpts;
+
+	for (uint iter = 0; iter < k; iter++) {
+		PROFILE_SCOPE(PROFILE_ICP);
+		PROFILE_POINTS(src->numpts);
+
+		real begin = icp_seconds();
+		uint numpairs;
+
+		icp_match(icp, src, index);
+
+		real err = icp_weigh(icp, src->numpts, &numpairs);
+		real matched = icp_seconds();
+		int converged = numpairs == 0 || fabs(last - err) < t;
+
+		if (!converged)
+			icp_step(icp, src, tgt, tnormals, snormals);
+
+		stats->iter = iter;
+		stats->numpairs = numpairs;
+		stats->error = err;
+		stats->change = last - err;
+		stats->match = matched - begin;
+		stats->solve = icp_seconds() - matched;
+
+		last = err;
+
+		if (icp->callback != NULL && !icp->callback(stats, icp->data)) {
+			icp->stopped = 1;
+			break;
+		}
+
+		if (converged)
+			break;
+	}
+
+	return 1;
+}
+
+int icp_run(struct icp *icp,
+            struct cloud *source,
+            struct cloud *target,
+            real t,
+            uint k)
+{
+	return icp_run_level(icp, source, target, t, k, 0);
+}
+
+int icp_run_pyramid(struct icp *icp,
+                    struct pyramid *source,
+                    struct pyramid *target,
+                    real t,
+                    uint k)
+{
+	uint top = source->numlevels < target->numlevels ?
+	           source->numlevels : target->numlevels;
+
+	if (top == 0 || !icp_reserve(icp, source->levels[0]->numpts))
+		return 0;
+
+	for (uint l = top; l > 0; l--) {
+		real leaf = source->leafsizes[l - 1] > target->leafsizes[l - 1] ?
+		            source->leafsizes[l - 1] : target->leafsizes[l - 1];
+		real tol = leaf * ICP_LEVEL_TOL > t ? leaf * ICP_LEVEL_TOL : t;
+
+		if (!icp_run_level(icp,
+		                   source->levels[l - 1],
+		                   target->levels[l - 1],
+		                   tol,
+		                   k,
+		                   l - 1))
+			return 0;
+
+		if (icp->stopped)
+			break;
+	}
+
+	return 1;
+}
+
+void icp_debug(struct icp *icp, FILE *output)
+{
+	struct icp_iteration *stats = &icp->stats;
+
+	fprintf(output,
+	        "metric: %d | numpts: %u | trim: %lf | maxdist: %le | "
+	        "kernel: %d | scale: %le\n"
+	        "level %u, iter %u: %u pairs, error %le (change %le) | "
+	        "match %lfs | solve %lfs\n",
+	        icp->metric,
+	        icp->numpts,
+	        icp->trim,
+	        icp->maxdist,
+	        icp->kernel,
+	        icp->scale,
+	        stats->level,
+	        stats->iter,
+	        stats->numpairs,
+	        stats->error,
+	        stats->change,
+	        stats->match,
+	        stats->solve);
+
+	rigid3_debug(&icp->rt, output);
+}
+
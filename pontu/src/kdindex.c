@@ -0,0 +1,417 @@
+#include "../include/kdindex.h"
+
+static void kdindex_swap(uint *ids, uint a, uint b)
+{
+	uint tmp = ids[a];
+	ids[a] = ids[b];
+	ids[b] = tmp;
+}
+
+static real kdindex_distance(struct kdindex *index, uint i, const real *p)
+{
+	real dx = p[0] - index->x[i];
+	real dy = p[1] - index->y[i];
+	real dz = p[2] - index->z[i];
+
+	return dx * dx + dy * dy + dz * dz;
+}
+
+static real kdindex_box_distance(struct kdindex_node *node, const real *p)
+{
+	real d = 0.0;
+
+	for (int k = 0; k < 3; k++) {
+		real e = 0.0;
+
+		if (p[k] < node->min[k])
+			e = node->min[k] - p[k];
+		else if (p[k] > node->max[k])
+			e = p[k] - node->max[k];
+
+		d += e * e;
+	}
+
+	return d;
+}
+
+static uint kdindex_build(struct kdindex *index,
+                          const real **coord,
+                          uint begin,
+                          uint end)
+{
+	uint id = index->numnodes++;
+	struct kdindex_node *node = &index->nodes[id];
+
+	node->axis = -1;
+	node->split = 0.0;
+	node->begin = begin;
+	node->end = end;
+	node->left = KDINDEX_NONE;
+	node->right = KDINDEX_NONE;
+
+	int axis = -1;
+	real spread = 0.0;
+
+	for (int k = 0; k < 3; k++) {
+		real min = INFINITY;
+		real max = -INFINITY;
+
+		for (uint i = begin; i < end; i++) {
+			real v = coord[k][index->ids[i]];
+			min = v < min ? v : min;
+			max = v > max ? v : max;
+		}
+
+		node->min[k] = min;
+		node->max[k] = max;
+
+		if (max - min > spread) {
+			spread = max - min;
+			axis = k;
+		}
+	}
+
+	if (end - begin <= KDINDEX_LEAFSIZE || axis < 0)
+		return id;
+
+	uint mid = begin + (end - begin) / 2;
+	calc_select(coord[axis], index->ids, begin, end, mid);
+
+	node->axis = axis;
+	node->split = coord[axis][index->ids[mid]];
+
+	uint left = kdindex_build(index, coord, begin, mid);
+	uint right = kdindex_build(index, coord, mid, end);
+
+	index->nodes[id].left = left;
+	index->nodes[id].right = right;
+
+	return id;
+}
+
+static uint kdindex_maxnodes(uint n)
+{
+	return 2 * (n / (KDINDEX_LEAFSIZE / 2)) + 1;
+}
+
+struct kdindex *kdindex_new(struct pointarray *array)
+{
+	struct kdindex *index = mem_alloc(MEM_KDINDEX, sizeof(struct kdindex));
+	if (index == NULL)
+		return NULL;
+
+	uint n = array->numpts;
+	uint maxnodes = kdindex_maxnodes(n);
+
+	index->numpts = n;
+	index->numnodes = 0;
+	index->x = mem_alloc(MEM_KDINDEX, (n + 1) * sizeof(real));
+	index->y = mem_alloc(MEM_KDINDEX, (n + 1) * sizeof(real));
+	index->z = mem_alloc(MEM_KDINDEX, (n + 1) * sizeof(real));
+	index->ids = mem_alloc(MEM_KDINDEX, (n + 1) * sizeof(uint));
+	index->nodes = mem_alloc(MEM_KDINDEX,
+	                         maxnodes * sizeof(struct kdindex_node));
+
+	if (index->x == NULL || index->y == NULL || index->z == NULL ||
+	    index->ids == NULL || index->nodes == NULL) {
+		kdindex_free(&index);
+		return NULL;
+	}
+
+	if (n == 0)
+		return index;
+
+	const real *coord[3] = {array->x, array->y, array->z};
+
+	for (uint i = 0; i < n; i++)
+		index->ids[i] = i;
+
+	kdindex_build(index, coord, 0, n);
+
+	for (uint i = 0; i < n; i++) {
+		index->x[i] = array->x[index->ids[i]];
+		index->y[i] = array->y[index->ids[i]];
+		index->z[i] = array->z[index->ids[i]];
+	}
+
+	return index;
+}
+
+void kdindex_free(struct kdindex **index)
+{
+	if (*index == NULL)
+		return;
+
+	uint n = (*index)->numpts;
+
+	mem_free(MEM_KDINDEX, (*index)->x, (n + 1) * sizeof(real));
+	mem_free(MEM_KDINDEX, (*index)->y, (n + 1) * sizeof(real));
+	mem_free(MEM_KDINDEX, (*index)->z, (n + 1) * sizeof(real));
+	mem_free(MEM_KDINDEX, (*index)->ids, (n + 1) * sizeof(uint));
+	mem_free(MEM_KDINDEX,
+	         (*index)->nodes,
+	         kdindex_maxnodes(n) * sizeof(struct kdindex_node));
+	mem_free(MEM_KDINDEX, *index, sizeof(struct kdindex));
+	*index = NULL;
+}
+
+static void kdindex_nearest_node(struct kdindex *index,
+                                 uint id,
+                                 const real *p,
+                                 uint *best,
+                                 real *dist)
+{
+	struct kdindex_node *node = &index->nodes[id];
+
+	if (node->axis < 0) {
+		for (uint i = node->begin; i < node->end; i++) {
+			real d = kdindex_distance(index, i, p);
+			if (d < *dist) {
+				*dist = d;
+				*best = i;
+			}
+		}
+
+		return;
+	}
+
+	uint near = node->left;
+	uint far = node->right;
+	real dnear = kdindex_box_distance(&index->nodes[near], p);
+	real dfar = kdindex_box_distance(&index->nodes[far], p);
+
+	if (dfar < dnear) {
+		uint tmp = near;
+		near = far;
+		far = tmp;
+
+		real d = dnear;
+		dnear = dfar;
+		dfar = d;
+	}
+
+	if (dnear < *dist)
+		kdindex_nearest_node(index, near, p, best, dist);
+
+	if (dfar < *dist)
+		kdindex_nearest_node(index, far, p, best, dist);
+}
+
+uint kdindex_nearest(struct kdindex *index, const real *p, real *dist)
+{
+	PROFILE_QUERY(PROFILE_NN);
+	PROFILE_POINTS(1);
+
+	if (index->numpts == 0)
+		return KDINDEX_NONE;
+
+	uint best = 0;
+	real d = INFINITY;
+
+	kdindex_nearest_node(index, 0, p, &best, &d);
+
+	if (dist != NULL)
+		*dist = d;
+
+	return index->ids[best];
+}
+
+static void kdindex_heap_down(uint *ids, real *dist, uint size, uint i)
+{
+	while (1) {
+		uint largest = i;
+		uint l = 2 * i + 1;
+		uint r = 2 * i + 2;
+
+		if (l < size && dist[l] > dist[largest])
+			largest = l;
+
+		if (r < size && dist[r] > dist[largest])
+			largest = r;
+
+		if (largest == i)
+			return;
+
+		real d = dist[i];
+		dist[i] = dist[largest];
+		dist[largest] = d;
+		kdindex_swap(ids, i, largest);
+
+		i = largest;
+	}
+}
+
+static void kdindex_knn_node(struct kdindex *index,
+                             uint id,
+                             const real *p,
+                             uint k,
+                             uint *ids,
+                             real *dist,
+                             uint *count)
+{
+	struct kdindex_node *node = &index->nodes[id];
+
+	if (node->axis < 0) {
+		for (uint i = node->begin; i < node->end; i++) {
+			real d = kdindex_distance(index, i, p);
+
+			if (*count < k) {
+				uint c = (*count)++;
+				ids[c] = i;
+				dist[c] = d;
+
+				while (c > 0 && dist[(c - 1) / 2] < dist[c]) {
+					uint parent = (c - 1) / 2;
+					real tmp = dist[c];
+					dist[c] = dist[parent];
+					dist[parent] = tmp;
+					kdindex_swap(ids, c, parent);
+					c = parent;
+				}
+			} else if (d < dist[0]) {
+				ids[0] = i;
+				dist[0] = d;
+				kdindex_heap_down(ids, dist, k, 0);
+			}
+		}
+
+		return;
+	}
+
+	uint near = node->left;
+	uint far = node->right;
+	real dnear = kdindex_box_distance(&index->nodes[near], p);
+	real dfar = kdindex_box_distance(&index->nodes[far], p);
+
+	if (dfar < dnear) {
+		uint tmp = near;
+		near = far;
+		far = tmp;
+
+		real d = dnear;
+		dnear = dfar;
+		dfar = d;
+	}
+
+	if (*count < k || dnear < dist[0])
+		kdindex_knn_node(index, near, p, k, ids, dist, count);
+
+	if (*count < k || dfar < dist[0])
+		kdindex_knn_node(index, far, p, k, ids, dist, count);
+}
+
+uint kdindex_knn(struct kdindex *index,
+                 const real *p,
+                 uint k,
+                 uint *ids,
+                 real *dist)
+{
+	PROFILE_QUERY(PROFILE_NN);
+	PROFILE_POINTS(1);
+
+	if (index->numpts == 0 || k == 0)
+		return 0;
+
+	uint count = 0;
+
+	kdindex_knn_node(index, 0, p, k, ids, dist, &count);
+
+	for (uint size = count; size > 1; size--) {
+		real d = dist[0];
+		dist[0] = dist[size - 1];
+		dist[size - 1] = d;
+		kdindex_swap(ids, 0, size - 1);
+		kdindex_heap_down(ids, dist, size - 1, 0);
+	}
+
+	for (uint i = 0; i < count; i++)
+		ids[i] = index->ids[ids[i]];
+
+	return count;
+}
+
+static void kdindex_radius_node(struct kdindex *index,
+                                uint id,
+                                const real *p,
+                                real sqrad,
+                                uint *ids,
+                                real *dist,
+                                uint max,
+                                uint *count)
+{
+	struct kdindex_node *node = &index->nodes[id];
+
+	if (node->axis < 0) {
+		for (uint i = node->begin; i < node->end; i++) {
+			real d = kdindex_distance(index, i, p);
+
+			if (d <= sqrad) {
+				if (*count < max) {
+					ids[*count] = index->ids[i];
+					if (dist != NULL)
+						dist[*count] = d;
+				}
+
+				(*count)++;
+			}
+		}
+
+		return;
+	}
+
+	if (kdindex_box_distance(&index->nodes[node->left], p) <= sqrad)
+		kdindex_radius_node(index,
+		                    node->left,
+		                    p,
+		                    sqrad,
+		                    ids,
+		                    dist,
+		                    max,
+		                    count);
+
+	if (kdindex_box_distance(&index->nodes[node->right], p) <= sqrad)
+		kdindex_radius_node(index,
+		                    node->right,
+		                    p,
+		                    sqrad,
+		                    ids,
+		                    dist,
+		                    max,
+		                    count);
+}
+
+uint kdindex_radius(struct kdindex *index,
+                    const real *p,
+                    real radius,
+                    uint *ids,
+                    real *dist,
+                    uint max)
+{
+	PROFILE_QUERY(PROFILE_NN);
+	PROFILE_POINTS(1);
+
+	if (index->numpts == 0)
+		return 0;
+
+	uint count = 0;
+
+	kdindex_radius_node(index, 0, p, radius * radius, ids, dist, max, &count);
+
+	return count;
+}
+
+void kdindex_debug(struct kdindex *index, FILE *output)
+{
+	uint leaves = 0;
+
+	for (uint i = 0; i < index->numnodes; i++)
+		if (index->nodes[i].axis < 0)
+			leaves++;
+
+	fprintf(output,
+	        "numpts: %u | nodes: %u | leaves: %u\n",
+	        index->numpts,
+	        index->numnodes,
+	        leaves);
+}
+
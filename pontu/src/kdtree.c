@@ -5,13 +5,13 @@ struct kdtree *kdtree_new(struct pointset *points, uint numpts, int axis)
 	if (numpts == 0)
 		return NULL;
 	
-	struct kdtree *kdt = malloc(sizeof(struct kdtree));
+	struct kdtree *kdt = mem_alloc(MEM_KDTREE, sizeof(struct kdtree));
 	if (kdt == NULL)
 		return NULL;
 	
 	kdt->points = pointset_copy(points);
 	if (kdt->points == NULL) {
-		free(kdt);
+		mem_free(MEM_KDTREE, kdt, sizeof(struct kdtree));
 		return NULL;
 	}
 	
@@ -35,7 +35,7 @@ void kdtree_free(struct kdtree **kdt)
 	kdtree_free(&(*kdt)->left);
 	kdtree_free(&(*kdt)->right);
 	
-	free(*kdt);
+	mem_free(MEM_KDTREE, *kdt, sizeof(struct kdtree));
 	*kdt = NULL;
 }
 
@@ -46,6 +46,9 @@ void kdtree_partitionate(struct kdtree *kdt)
 	
 	if (kdt->numpts <= 1)
 		return;
+
+	PROFILE_SCOPE(PROFILE_PARTITION);
+	PROFILE_POINTS(kdt->numpts);
 	
 	uint numpts_left = 0;
 	uint numpts_right = 0;
@@ -123,6 +126,9 @@ void kdtree_closest_point(struct kdtree *node,
 struct vector3 *kdtree_nearest_neighbor(struct kdtree *kdt,
                                         struct vector3 *point)
 {
+	PROFILE_QUERY(PROFILE_NN);
+	PROFILE_POINTS(1);
+
 	real radius = 0.0f;
 	struct kdtree *node = kdtree_closest_node(kdt, point, &radius);
 	return node->median->point;
@@ -15,6 +15,18 @@ real legendre_poly(int n, real x)
 	       (n - 1) * legendre_poly(n - 2, x)) / (1.0 * n);
 }
 
+void legendre_poly_table(int n, real x, real *table)
+{
+	table[0] = 1.0;
+
+	if (n >= 1)
+		table[1] = x;
+
+	for (int i = 2; i <= n; i++)
+		table[i] = (((2 * i) - 1) * x * table[i - 1] -
+		           (i - 1) * table[i - 2]) / (1.0 * i);
+}
+
 real legendre_norm(int p, int q, int r, struct cloud *cloud)
 {
 	real num = ((2.0 * p) + 1) * ((2.0 * q) + 1) * ((2.0 * r) + 1);
@@ -52,24 +64,93 @@ real legendre_moment(int p, int q, int r, struct cloud *cloud)
 	return legendre_norm(p, q, r, cloud) * moment;
 }
 
+#define LEGENDRE_KERNEL(name, N)                                              \
+static void name(struct cloud *cloud,                                        \
+                 struct vector3 *centroid,                                   \
+                 int order,                                                  \
+                 real *moments)                                              \
+{                                                                             \
+	real px[MOMENTCFG_MAXORD + 1];                                            \
+	real py[MOMENTCFG_MAXORD + 1];                                            \
+	real pz[MOMENTCFG_MAXORD + 1];                                            \
+	                                                                          \
+	for (struct pointset *set = cloud->points; set != NULL; set = set->next) { \
+		real d = vector3_distance(set->point, centroid);                      \
+		uint col = 0;                                                         \
+		                                                                      \
+		legendre_poly_table(N, set->point->x - centroid->x, px);              \
+		legendre_poly_table(N, set->point->y - centroid->y, py);              \
+		legendre_poly_table(N, set->point->z - centroid->z, pz);              \
+		                                                                      \
+		MOMENTCFG_UNROLL                                                      \
+		for (int p = 0; p <= N; p++)                                          \
+			MOMENTCFG_UNROLL                                                  \
+			for (int q = 0; q <= N; q++)                                      \
+				MOMENTCFG_UNROLL                                              \
+				for (int r = 0; r <= N; r++)                                  \
+					moments[col++] += px[p] * py[q] * pz[r] * d;              \
+	}                                                                         \
+	                                                                          \
+	(void)order;                                                              \
+}
+
+LEGENDRE_KERNEL(legendre_kernel_1, 1)
+LEGENDRE_KERNEL(legendre_kernel_2, 2)
+LEGENDRE_KERNEL(legendre_kernel_3, 3)
+LEGENDRE_KERNEL(legendre_kernel_4, 4)
+LEGENDRE_KERNEL(legendre_kernel_n, order)
+
 struct dataframe *legendre_cloud_moments(struct cloud *cloud)
 {
-	struct dataframe *results = dataframe_new(1, LEGENDRE_MOMENTS);
+	return legendre_cloud_moments_cfg(cloud, momentcfg_current());
+}
 
-	int p = 0;
-	int q = 0;
-	int r = 0;
-	int col = 0;
+struct dataframe *legendre_cloud_moments_cfg(struct cloud *cloud,
+                                             struct momentcfg *cfg)
+{
+	PROFILE_SCOPE(PROFILE_MOMENT);
+	PROFILE_POINTS(cloud->numpts);
+
+	int n = cfg->legendre;
+	if (n < 0 || n > MOMENTCFG_MAXORD)
+		return NULL;
+
+	struct dataframe *results = dataframe_new(1, (n + 1) * (n + 1) * (n + 1));
+	if (results == NULL)
+		return NULL;
+
+	struct vector3 *centroid = cloud_get_centroid(cloud);
 
-	for (p = 0; p <= LEGENDRE_ORDER; p++) {
-		for (q = 0; q <= LEGENDRE_ORDER; q++) {
-			for (r = 0; r <= LEGENDRE_ORDER; r++) {
-				dataframe_set(results, 0, col, legendre_moment(p, q, r, cloud));
+	switch (n) {
+	case 1:
+		legendre_kernel_1(cloud, centroid, n, results->data);
+		break;
+	case 2:
+		legendre_kernel_2(cloud, centroid, n, results->data);
+		break;
+	case 3:
+		legendre_kernel_3(cloud, centroid, n, results->data);
+		break;
+	case 4:
+		legendre_kernel_4(cloud, centroid, n, results->data);
+		break;
+	default:
+		legendre_kernel_n(cloud, centroid, n, results->data);
+		break;
+	}
+
+	int col = 0;
+	for (int p = 0; p <= n; p++) {
+		for (int q = 0; q <= n; q++) {
+			for (int r = 0; r <= n; r++) {
+				results->data[col] *= legendre_norm(p, q, r, cloud);
 				col++;
 			}
 		}
 	}
 
+	vector3_free(&centroid);
+
 	return results;
 }
 
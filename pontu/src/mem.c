@@ -0,0 +1,284 @@
+#include "../include/mem.h"
+
+static const char *mem_names[MEM_NUMSUBSYSTEMS] = {"pointset",
+                                                   "vector3",
+                                                   "pointarray",
+                                                   "kdindex",
+                                                   "kdtree",
+                                                   "octree",
+                                                   "dataframe",
+                                                   "voxelgrid",
+                                                   "attrib"};
+
+static struct mem_stats mem_subsystems[MEM_NUMSUBSYSTEMS];
+
+static atomic_size_t mem_total_live;
+
+static atomic_size_t mem_total_peak;
+
+static atomic_size_t mem_limit;
+
+static void *mem_default_alloc(size_t size, size_t align, void *data)
+{
+	(void)data;
+
+	return align > 0 ? aligned_alloc(align, size) : malloc(size);
+}
+
+static void *mem_default_resize(void *ptr,
+                                size_t oldsize,
+                                size_t size,
+                                void *data)
+{
+	(void)oldsize;
+	(void)data;
+
+	return realloc(ptr, size);
+}
+
+static void mem_default_release(void *ptr, size_t size, void *data)
+{
+	(void)size;
+	(void)data;
+
+	free(ptr);
+}
+
+static const struct mem_allocator mem_default = {&mem_default_alloc,
+                                                 &mem_default_resize,
+                                                 &mem_default_release,
+                                                 NULL};
+
+static struct mem_allocator mem_allocator = {&mem_default_alloc,
+                                             &mem_default_resize,
+                                             &mem_default_release,
+                                             NULL};
+
+static void mem_raise(atomic_size_t *peak, size_t value)
+{
+	size_t current = atomic_load(peak);
+
+	while (value > current &&
+	       !atomic_compare_exchange_weak(peak, &current, value))
+		;
+}
+
+static int mem_reserve(int subsystem, size_t size)
+{
+	struct mem_stats *stats = &mem_subsystems[subsystem];
+	size_t limit = atomic_load(&mem_limit);
+	size_t total = atomic_fetch_add(&mem_total_live, size) + size;
+
+	if (limit > 0 && total > limit) {
+		atomic_fetch_sub(&mem_total_live, size);
+		atomic_fetch_add(&stats->failures, 1);
+		return 0;
+	}
+
+	mem_raise(&mem_total_peak, total);
+	mem_raise(&stats->peak, atomic_fetch_add(&stats->live, size) + size);
+
+	return 1;
+}
+
+static void mem_unreserve(int subsystem, size_t size)
+{
+	atomic_fetch_sub(&mem_total_live, size);
+	atomic_fetch_sub(&mem_subsystems[subsystem].live, size);
+}
+
+static void *mem_request(int subsystem, size_t size, size_t align)
+{
+	if (!mem_reserve(subsystem, size))
+		return NULL;
+
+	void *ptr = mem_allocator.alloc(size, align, mem_allocator.data);
+
+	if (ptr == NULL) {
+		mem_unreserve(subsystem, size);
+		atomic_fetch_add(&mem_subsystems[subsystem].failures, 1);
+		return NULL;
+	}
+
+	atomic_fetch_add(&mem_subsystems[subsystem].allocs, 1);
+	PROFILE_BYTES(size);
+
+	return ptr;
+}
+
+void *mem_alloc(int subsystem, size_t size)
+{
+	return mem_request(subsystem, size, 0);
+}
+
+void *mem_calloc(int subsystem, size_t num, size_t size)
+{
+	if (size > 0 && num > SIZE_MAX / size) {
+		atomic_fetch_add(&mem_subsystems[subsystem].failures, 1);
+		return NULL;
+	}
+
+	void *ptr = mem_request(subsystem, num * size, 0);
+
+	if (ptr != NULL)
+		memset(ptr, 0, num * size);
+
+	return ptr;
+}
+
+void *mem_aligned(int subsystem, size_t align, size_t size)
+{
+	return mem_request(subsystem, size, align);
+}
+
+void *mem_realloc(int subsystem, void *ptr, size_t oldsize, size_t size)
+{
+	if (ptr == NULL)
+		return mem_alloc(subsystem, size);
+
+	if (size > oldsize && !mem_reserve(subsystem, size - oldsize))
+		return NULL;
+
+	void *new = mem_allocator.resize(ptr, oldsize, size, mem_allocator.data);
+
+	if (new == NULL) {
+		if (size > oldsize)
+			mem_unreserve(subsystem, size - oldsize);
+
+		atomic_fetch_add(&mem_subsystems[subsystem].failures, 1);
+		return NULL;
+	}
+
+	if (size > oldsize)
+		PROFILE_BYTES(size - oldsize);
+	else
+		mem_unreserve(subsystem, oldsize - size);
+
+	return new;
+}
+
+void mem_free(int subsystem, void *ptr, size_t size)
+{
+	if (ptr == NULL)
+		return;
+
+	mem_allocator.release(ptr, size, mem_allocator.data);
+	mem_unreserve(subsystem, size);
+	atomic_fetch_add(&mem_subsystems[subsystem].frees, 1);
+}
+
+void mem_set_allocator(const struct mem_allocator *allocator)
+{
+	mem_allocator = allocator != NULL ? *allocator : mem_default;
+}
+
+void mem_set_limit(size_t bytes)
+{
+	atomic_store(&mem_limit, bytes);
+}
+
+struct mem_stats *mem_get(int subsystem)
+{
+	if (subsystem < 0 || subsystem >= MEM_NUMSUBSYSTEMS)
+		return NULL;
+
+	return &mem_subsystems[subsystem];
+}
+
+size_t mem_live()
+{
+	return atomic_load(&mem_total_live);
+}
+
+size_t mem_peak()
+{
+	return atomic_load(&mem_total_peak);
+}
+
+const char *mem_name(int subsystem)
+{
+	if (subsystem < 0 || subsystem >= MEM_NUMSUBSYSTEMS)
+		return NULL;
+
+	return mem_names[subsystem];
+}
+
+void mem_reset()
+{
+	for (int s = 0; s < MEM_NUMSUBSYSTEMS; s++) {
+		struct mem_stats *stats = &mem_subsystems[s];
+
+		atomic_store(&stats->peak, atomic_load(&stats->live));
+		atomic_store(&stats->allocs, 0);
+		atomic_store(&stats->frees, 0);
+		atomic_store(&stats->failures, 0);
+	}
+
+	atomic_store(&mem_total_peak, atomic_load(&mem_total_live));
+}
+
+void mem_report(FILE *output, int format)
+{
+	int first = 1;
+
+	if (format == MEM_JSON)
+		fprintf(output,
+		        "{\"live\": %lu, \"peak\": %lu, \"limit\": %lu, "
+		        "\"subsystems\": [",
+		        (unsigned long)mem_live(),
+		        (unsigned long)mem_peak(),
+		        (unsigned long)atomic_load(&mem_limit));
+	else
+		fprintf(output,
+		        "%-10s %14s %14s %12s %12s %8s\n",
+		        "subsystem",
+		        "live",
+		        "peak",
+		        "allocs",
+		        "frees",
+		        "failures");
+
+	for (int s = 0; s < MEM_NUMSUBSYSTEMS; s++) {
+		struct mem_stats *stats = &mem_subsystems[s];
+		uint64_t allocs = atomic_load(&stats->allocs);
+		uint64_t failures = atomic_load(&stats->failures);
+
+		if (allocs == 0 && failures == 0 && atomic_load(&stats->live) == 0)
+			continue;
+
+		if (format == MEM_JSON) {
+			fprintf(output,
+			        "%s{\"subsystem\": \"%s\", \"live\": %lu, "
+			        "\"peak\": %lu, \"allocs\": %lu, \"frees\": %lu, "
+			        "\"failures\": %lu}",
+			        first ? "" : ", ",
+			        mem_names[s],
+			        (unsigned long)atomic_load(&stats->live),
+			        (unsigned long)atomic_load(&stats->peak),
+			        (unsigned long)allocs,
+			        (unsigned long)atomic_load(&stats->frees),
+			        (unsigned long)failures);
+		} else {
+			fprintf(output,
+			        "%-10s %14lu %14lu %12lu %12lu %8lu\n",
+			        mem_names[s],
+			        (unsigned long)atomic_load(&stats->live),
+			        (unsigned long)atomic_load(&stats->peak),
+			        (unsigned long)allocs,
+			        (unsigned long)atomic_load(&stats->frees),
+			        (unsigned long)failures);
+		}
+
+		first = 0;
+	}
+
+	if (format == MEM_JSON)
+		fprintf(output, "]}\n");
+	else
+		fprintf(output,
+		        "%-10s %14lu %14lu\n",
+		        "total",
+		        (unsigned long)mem_live(),
+		        (unsigned long)mem_peak());
+}
+
@@ -0,0 +1,358 @@
+#include <string.h>
+
+#include "../include/momentacc.h"
+
+static uint momentacc_index(struct momentacc *acc, int p, int q, int r)
+{
+	int n = acc->order + 1;
+
+	return (((p * n) + q) * n) + r;
+}
+
+static void momentacc_powers(int order, real x, real *powers)
+{
+	powers[0] = 1.0;
+
+	for (int i = 1; i <= order; i++)
+		powers[i] = powers[i - 1] * x;
+}
+
+static void momentacc_update(struct momentacc *acc,
+                             struct vector3 *point,
+                             real sign)
+{
+	real px[MOMENTCFG_MAXORD + 1];
+	real py[MOMENTCFG_MAXORD + 1];
+	real pz[MOMENTCFG_MAXORD + 1];
+	int order = acc->order;
+
+	momentacc_powers(order, point->x - acc->origin[0], px);
+	momentacc_powers(order, point->y - acc->origin[1], py);
+	momentacc_powers(order, point->z - acc->origin[2], pz);
+
+	uint col = 0;
+	for (int p = 0; p <= order; p++) {
+		for (int q = 0; q <= order; q++) {
+			real pq = sign * px[p] * py[q];
+
+			for (int r = 0; r <= order; r++) {
+				acc->sums[col] += pq * pz[r];
+				col++;
+			}
+		}
+	}
+}
+
+static real momentacc_shifted(struct momentacc *acc,
+                              int p,
+                              int q,
+                              int r,
+                              real *shift)
+{
+	real dx[MOMENTCFG_MAXORD + 1];
+	real dy[MOMENTCFG_MAXORD + 1];
+	real dz[MOMENTCFG_MAXORD + 1];
+	int n = acc->order + 1;
+
+	momentacc_powers(p, shift[0], dx);
+	momentacc_powers(q, shift[1], dy);
+	momentacc_powers(r, shift[2], dz);
+
+	real moment = 0.0;
+	for (int i = 0; i <= p; i++) {
+		for (int j = 0; j <= q; j++) {
+			real ij = acc->binom[(p * n) + i] * dx[p - i] *
+			          acc->binom[(q * n) + j] * dy[q - j];
+
+			for (int k = 0; k <= r; k++) {
+				moment += ij *
+				          acc->binom[(r * n) + k] * dz[r - k] *
+				          acc->sums[momentacc_index(acc, i, j, k)];
+			}
+		}
+	}
+
+	return moment;
+}
+
+static void momentacc_center_shift(struct momentacc *acc, real *shift)
+{
+	real zero = acc->sums[0];
+
+	shift[0] = -acc->sums[momentacc_index(acc, 1, 0, 0)] / zero;
+	shift[1] = -acc->sums[momentacc_index(acc, 0, 1, 0)] / zero;
+	shift[2] = -acc->sums[momentacc_index(acc, 0, 0, 1)] / zero;
+}
+
+struct momentacc *momentacc_new(int order)
+{
+	if (order < 0 || order > MOMENTCFG_MAXORD)
+		return NULL;
+
+	struct momentacc *acc = malloc(sizeof(struct momentacc));
+	if (acc == NULL)
+		return NULL;
+
+	int n = order + 1;
+
+	acc->order = order;
+	acc->numpts = 0;
+	acc->origin[0] = 0.0;
+	acc->origin[1] = 0.0;
+	acc->origin[2] = 0.0;
+	acc->sums = calloc(n * n * n, sizeof(real));
+	acc->binom = calloc(n * n, sizeof(real));
+	acc->legendre = calloc(n * n, sizeof(real));
+
+	if (acc->sums == NULL || acc->binom == NULL || acc->legendre == NULL) {
+		momentacc_free(&acc);
+		return NULL;
+	}
+
+	for (int i = 0; i < n; i++) {
+		acc->binom[i * n] = 1.0;
+
+		for (int j = 1; j <= i; j++)
+			acc->binom[(i * n) + j] = acc->binom[((i - 1) * n) + j - 1] +
+			                          acc->binom[((i - 1) * n) + j];
+	}
+
+	acc->legendre[0] = 1.0;
+	if (order >= 1)
+		acc->legendre[n + 1] = 1.0;
+
+	for (int i = 2; i < n; i++) {
+		for (int j = 0; j <= i; j++) {
+			real a = j > 0 ? acc->legendre[((i - 1) * n) + j - 1] : 0.0;
+			real b = acc->legendre[((i - 2) * n) + j];
+
+			acc->legendre[(i * n) + j] = (((2 * i) - 1) * a - (i - 1) * b) /
+			                             (1.0 * i);
+		}
+	}
+
+	return acc;
+}
+
+void momentacc_free(struct momentacc **acc)
+{
+	if (*acc == NULL)
+		return;
+
+	free((*acc)->sums);
+	free((*acc)->binom);
+	free((*acc)->legendre);
+	free(*acc);
+	*acc = NULL;
+}
+
+void momentacc_reset(struct momentacc *acc)
+{
+	int n = acc->order + 1;
+
+	memset(acc->sums, 0, n * n * n * sizeof(real));
+	acc->numpts = 0;
+}
+
+void momentacc_add(struct momentacc *acc, struct vector3 *point)
+{
+	if (acc->numpts == 0) {
+		acc->origin[0] = point->x;
+		acc->origin[1] = point->y;
+		acc->origin[2] = point->z;
+	}
+
+	momentacc_update(acc, point, 1.0);
+	acc->numpts++;
+}
+
+void momentacc_remove(struct momentacc *acc, struct vector3 *point)
+{
+	if (acc->numpts == 0)
+		return;
+
+	acc->numpts--;
+
+	if (acc->numpts == 0)
+		momentacc_reset(acc);
+	else
+		momentacc_update(acc, point, -1.0);
+}
+
+void momentacc_add_cloud(struct momentacc *acc, struct cloud *cloud)
+{
+	for (struct pointset *set = cloud->points; set != NULL; set = set->next)
+		momentacc_add(acc, set->point);
+}
+
+void momentacc_remove_cloud(struct momentacc *acc, struct cloud *cloud)
+{
+	for (struct pointset *set = cloud->points; set != NULL; set = set->next)
+		momentacc_remove(acc, set->point);
+}
+
+void momentacc_add_view(struct momentacc *acc, struct cloudview *view)
+{
+	for (uint j = 0; j < view->numids; j++) {
+		struct vector3 *point = cloudview_point(view, j);
+
+		if (point != NULL)
+			momentacc_add(acc, point);
+	}
+}
+
+real momentacc_raw(struct momentacc *acc, int p, int q, int r)
+{
+	if (p < 0 || q < 0 || r < 0 ||
+	    p > acc->order || q > acc->order || r > acc->order)
+		return 0.0;
+
+	return momentacc_shifted(acc, p, q, r, acc->origin);
+}
+
+struct vector3 *momentacc_centroid(struct momentacc *acc)
+{
+	if (acc->numpts == 0 || acc->order < 1)
+		return NULL;
+
+	real shift[3];
+	momentacc_center_shift(acc, shift);
+
+	return vector3_new(acc->origin[0] - shift[0],
+	                   acc->origin[1] - shift[1],
+	                   acc->origin[2] - shift[2]);
+}
+
+real momentacc_central(struct momentacc *acc, int p, int q, int r)
+{
+	if (p < 0 || q < 0 || r < 0 ||
+	    p > acc->order || q > acc->order || r > acc->order)
+		return 0.0;
+
+	if (acc->numpts == 0 || acc->order < 1)
+		return acc->sums[momentacc_index(acc, p, q, r)];
+
+	real shift[3];
+	momentacc_center_shift(acc, shift);
+
+	return momentacc_shifted(acc, p, q, r, shift);
+}
+
+real momentacc_normalized(struct momentacc *acc, int p, int q, int r)
+{
+	real central = momentacc_central(acc, p, q, r);
+	real zero = acc->sums[0];
+
+	return central / pow(zero, ((p + q + r) / 3.0) + 1.0);
+}
+
+struct dataframe *momentacc_central_moments(struct momentacc *acc)
+{
+	int n = acc->order + 1;
+	struct dataframe *results = dataframe_new(1, n * n * n);
+	if (results == NULL)
+		return NULL;
+
+	real shift[3] = {0.0, 0.0, 0.0};
+	if (acc->numpts > 0 && acc->order >= 1)
+		momentacc_center_shift(acc, shift);
+
+	uint col = 0;
+	for (int p = 0; p < n; p++) {
+		for (int q = 0; q < n; q++) {
+			for (int r = 0; r < n; r++) {
+				results->data[col] = momentacc_shifted(acc, p, q, r, shift);
+				col++;
+			}
+		}
+	}
+
+	return results;
+}
+
+struct dataframe *momentacc_hu1980(struct momentacc *acc)
+{
+	if (acc->order < 2)
+		return NULL;
+
+	struct dataframe *results = dataframe_new(1, 3);
+	if (results == NULL)
+		return NULL;
+
+	real zero = pow(acc->sums[0], 3);
+	real hu200 = momentacc_central(acc, 2, 0, 0) / zero;
+	real hu020 = momentacc_central(acc, 0, 2, 0) / zero;
+	real hu002 = momentacc_central(acc, 0, 0, 2) / zero;
+	real hu110 = momentacc_central(acc, 1, 1, 0) / zero;
+	real hu101 = momentacc_central(acc, 1, 0, 1) / zero;
+	real hu011 = momentacc_central(acc, 0, 1, 1) / zero;
+
+	real j1 = hu200 + hu020 + hu002;
+	real j2 = (hu200 * hu020) + (hu200 * hu002) + (hu020 * hu002) -
+	          (hu110 * hu110) - (hu101 * hu101) - (hu011 * hu011);
+	real j3 = (hu200 * hu020 * hu002) + (2 * hu110 * hu101 * hu011) -
+	          (hu002 * hu110 * hu110) - (hu020 * hu101 * hu101) -
+	          (hu200 * hu011 * hu011);
+
+	dataframe_set(results, 0, 0, j1);
+	dataframe_set(results, 0, 1, j2);
+	dataframe_set(results, 0, 2, j3);
+
+	return results;
+}
+
+struct dataframe *momentacc_legendre_moments(struct momentacc *acc)
+{
+	struct dataframe *central = momentacc_central_moments(acc);
+	if (central == NULL)
+		return NULL;
+
+	int n = acc->order + 1;
+	struct dataframe *results = dataframe_new(1, n * n * n);
+	if (results == NULL) {
+		dataframe_free(&central);
+		return NULL;
+	}
+
+	real *a = acc->legendre;
+	uint col = 0;
+
+	for (int p = 0; p < n; p++) {
+		for (int q = 0; q < n; q++) {
+			for (int r = 0; r < n; r++) {
+				real moment = 0.0;
+
+				for (int i = 0; i <= p; i++)
+					for (int j = 0; j <= q; j++)
+						for (int k = 0; k <= r; k++)
+							moment += a[(p * n) + i] *
+							          a[(q * n) + j] *
+							          a[(r * n) + k] *
+							          central->data[momentacc_index(acc,
+							                                        i,
+							                                        j,
+							                                        k)];
+
+				real num = ((2.0 * p) + 1) * ((2.0 * q) + 1) * ((2.0 * r) + 1);
+				results->data[col] = (num / acc->numpts) * moment;
+				col++;
+			}
+		}
+	}
+
+	dataframe_free(&central);
+
+	return results;
+}
+
+void momentacc_debug(struct momentacc *acc, FILE *output)
+{
+	fprintf(output,
+	        "order: %d | points: %u | origin: %le %le %le\n",
+	        acc->order,
+	        acc->numpts,
+	        acc->origin[0],
+	        acc->origin[1],
+	        acc->origin[2]);
+}
+
@@ -0,0 +1,149 @@
+#include <string.h>
+
+#include "../include/momentcfg.h"
+#include "../include/legendre.h"
+#include "../include/chebyshev.h"
+#include "../include/spheric.h"
+#include "../include/zernike.h"
+#include "../include/harmonics.h"
+
+static struct momentcfg momentcfg_global = {
+	.legendre = LEGENDRE_ORDER,
+	.chebyshev = {CHEBYSHEV_ORDER_X, CHEBYSHEV_ORDER_Y, CHEBYSHEV_ORDER_Z},
+	.spheric = {SPHERIC_ORDER_X, SPHERIC_ORDER_Y, SPHERIC_ORDER_Z},
+	.zernike_ord = ZERNIKE_ORD,
+	.zernike_rep = ZERNIKE_REP,
+	.harmon_ord = HARMON_ORD,
+	.harmon_rep = HARMON_REP,
+	.harmon_spin = HARMON_SPIN
+};
+
+static int momentcfg_valid(int order)
+{
+	return order >= 0 && order <= MOMENTCFG_MAXORD;
+}
+
+static int momentcfg_parse_orders(const char *values, int *orders, int max)
+{
+	int n = sscanf(values, "%d:%d:%d", &orders[0], &orders[1], &orders[2]);
+	if (n < 1 || n > max)
+		return 0;
+
+	for (int i = n; i < max; i++)
+		orders[i] = orders[n - 1];
+
+	for (int i = 0; i < max; i++)
+		if (!momentcfg_valid(orders[i]))
+			return 0;
+
+	return n;
+}
+
+void momentcfg_default(struct momentcfg *cfg)
+{
+	cfg->legendre = LEGENDRE_ORDER;
+	cfg->chebyshev[0] = CHEBYSHEV_ORDER_X;
+	cfg->chebyshev[1] = CHEBYSHEV_ORDER_Y;
+	cfg->chebyshev[2] = CHEBYSHEV_ORDER_Z;
+	cfg->spheric[0] = SPHERIC_ORDER_X;
+	cfg->spheric[1] = SPHERIC_ORDER_Y;
+	cfg->spheric[2] = SPHERIC_ORDER_Z;
+	cfg->zernike_ord = ZERNIKE_ORD;
+	cfg->zernike_rep = ZERNIKE_REP;
+	cfg->harmon_ord = HARMON_ORD;
+	cfg->harmon_rep = HARMON_REP;
+	cfg->harmon_spin = HARMON_SPIN;
+}
+
+struct momentcfg *momentcfg_current()
+{
+	return &momentcfg_global;
+}
+
+void momentcfg_set(struct momentcfg *cfg)
+{
+	if (cfg == NULL)
+		momentcfg_default(&momentcfg_global);
+	else
+		momentcfg_global = *cfg;
+}
+
+int momentcfg_parse(struct momentcfg *cfg, const char *spec)
+{
+	char buffer[256];
+	if (strlen(spec) >= sizeof(buffer))
+		return 0;
+
+	strcpy(buffer, spec);
+
+	struct momentcfg parsed = *cfg;
+	int orders[3];
+	char *save = NULL;
+
+	for (char *item = strtok_r(buffer, MOMENTCFG_SEP, &save);
+	     item != NULL;
+	     item = strtok_r(NULL, MOMENTCFG_SEP, &save)) {
+		char *values = strchr(item, '=');
+		if (values == NULL)
+			return 0;
+
+		*values = '\0';
+		values++;
+
+		if (!strcmp(item, "legendre")) {
+			if (!momentcfg_parse_orders(values, orders, 1))
+				return 0;
+
+			parsed.legendre = orders[0];
+		} else if (!strcmp(item, "chebyshev")) {
+			if (!momentcfg_parse_orders(values, orders, 3))
+				return 0;
+
+			memcpy(parsed.chebyshev, orders, sizeof(orders));
+		} else if (!strcmp(item, "spheric")) {
+			if (!momentcfg_parse_orders(values, orders, 3))
+				return 0;
+
+			memcpy(parsed.spheric, orders, sizeof(orders));
+		} else if (!strcmp(item, "zernike")) {
+			if (!momentcfg_parse_orders(values, orders, 2))
+				return 0;
+
+			parsed.zernike_ord = orders[0];
+			parsed.zernike_rep = orders[1];
+		} else if (!strcmp(item, "harmonics")) {
+			if (!momentcfg_parse_orders(values, orders, 3))
+				return 0;
+
+			parsed.harmon_ord = orders[0];
+			parsed.harmon_rep = orders[1];
+			parsed.harmon_spin = orders[2];
+		} else {
+			return 0;
+		}
+	}
+
+	*cfg = parsed;
+
+	return 1;
+}
+
+void momentcfg_debug(struct momentcfg *cfg, FILE *output)
+{
+	fprintf(output,
+	        "legendre=%d,chebyshev=%d:%d:%d,spheric=%d:%d:%d,"
+	        "zernike=%d:%d,harmonics=%d:%d:%d\n",
+	        cfg->legendre,
+	        cfg->chebyshev[0],
+	        cfg->chebyshev[1],
+	        cfg->chebyshev[2],
+	        cfg->spheric[0],
+	        cfg->spheric[1],
+	        cfg->spheric[2],
+	        cfg->zernike_ord,
+	        cfg->zernike_rep,
+	        cfg->harmon_ord,
+	        cfg->harmon_rep,
+	        cfg->harmon_spin);
+}
+
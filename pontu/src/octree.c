@@ -5,13 +5,13 @@ struct octree *octree_new(struct pointset *points, uint numpts, int depth)
 	if (numpts == 0)
 		return NULL;
 	
-	struct octree *oct = malloc(sizeof(struct octree));
+	struct octree *oct = mem_alloc(MEM_OCTREE, sizeof(struct octree));
 	if (oct == NULL)
 		return NULL;
 	
 	oct->points = pointset_copy(points);
 	if (oct->points == NULL) {
-		free(oct);
+		mem_free(MEM_OCTREE, oct, sizeof(struct octree));
 		return NULL;
 	}
 	
@@ -49,7 +49,7 @@ void octree_free(struct octree **oct)
 	for (uint i = 0; i < 8; i++)
 		octree_free(&(*oct)->child[i]);
 	
-	free(*oct);
+	mem_free(MEM_OCTREE, *oct, sizeof(struct octree));
 	*oct = NULL;
 }
 
@@ -68,6 +68,9 @@ void octree_partitionate(struct octree *oct)
 {
 	if (oct == NULL || oct->depth <= 0 || oct->numpts <= 1)
 		return;
+
+	PROFILE_SCOPE(PROFILE_PARTITION);
+	PROFILE_POINTS(oct->numpts);
 	
 	struct pointset *points[8];
 	uint numpts[8];
@@ -114,6 +117,9 @@ struct vector3 *octree_closest(struct octree *oct, struct vector3 *p)
 
 struct vector3 *octree_nearest_neighbor(struct octree *oct, struct vector3 *p)
 {
+	PROFILE_QUERY(PROFILE_NN);
+	PROFILE_POINTS(1);
+
 	if (oct->depth <= 0) {
 		return octree_closest(oct, p);
 	} else {
@@ -0,0 +1,186 @@
+#include "../include/outlier.h"
+
+struct outlier_job {
+	struct pointarray *array;
+	struct kdindex *index;
+	uint k;
+	real radius;
+	uint minpts;
+	uint *ids;
+	real *dist;
+	real *mean;
+	char *keep;
+};
+
+static void outlier_knn_point(uint i, uint thread, void *data)
+{
+	struct outlier_job *job = data;
+	struct pointarray *array = job->array;
+	uint *ids = &job->ids[thread * (job->k + 1)];
+	real *dist = &job->dist[thread * (job->k + 1)];
+	real p[3] = {array->x[i], array->y[i], array->z[i]};
+	uint n = kdindex_knn(job->index, p, job->k + 1, ids, dist);
+	real sum = 0.0;
+
+	for (uint j = 1; j < n; j++)
+		sum += sqrt(dist[j]);
+
+	job->mean[i] = n > 1 ? sum / (n - 1) : 0.0;
+}
+
+static void outlier_radius_point(uint i, uint thread, void *data)
+{
+	struct outlier_job *job = data;
+	struct pointarray *array = job->array;
+	real p[3] = {array->x[i], array->y[i], array->z[i]};
+	uint n = kdindex_radius(job->index, p, job->radius, NULL, NULL, 0);
+
+	job->keep[i] = n > job->minpts;
+
+	(void)thread;
+}
+
+static struct cloudview *outlier_view(struct cloud *cloud, const char *keep)
+{
+	uint count = 0;
+
+	for (uint i = 0; i < cloud->numpts; i++)
+		count += keep[i];
+
+	struct cloudview *view = cloudview_new(cloud, count);
+	if (view == NULL)
+		return NULL;
+
+	count = 0;
+	for (uint i = 0; i < cloud->numpts; i++)
+		if (keep[i])
+			view->ids[count++] = i;
+
+	return view;
+}
+
+int outlier_mean_distances(struct cloud *cloud, uint k, real *dist)
+{
+	struct kdindex *index = cloud_index(cloud);
+	if (index == NULL || k == 0)
+		return 0;
+
+	uint numthreads = parallel_threads();
+	struct outlier_job job;
+
+	job.array = cloud->array;
+	job.index = index;
+	job.k = k;
+	job.ids = malloc(numthreads * (k + 1) * sizeof(uint));
+	job.dist = malloc(numthreads * (k + 1) * sizeof(real));
+	job.mean = dist;
+
+	if (job.ids == NULL || job.dist == NULL) {
+		free(job.ids);
+		free(job.dist);
+		return 0;
+	}
+
+	parallel_for(cloud->numpts, numthreads, &outlier_knn_point, &job);
+
+	free(job.ids);
+	free(job.dist);
+
+	return 1;
+}
+
+struct cloudview *outlier_statistical(struct cloud *cloud, uint k, real sigma)
+{
+	PROFILE_SPAN(__func__);
+
+	uint n = cloud->numpts;
+	real *mean = malloc((n + 1) * sizeof(real));
+	char *keep = malloc(n + 1);
+
+	if (mean == NULL || keep == NULL ||
+	    !outlier_mean_distances(cloud, k, mean)) {
+		free(mean);
+		free(keep);
+		return NULL;
+	}
+
+	real sum = 0.0;
+	real sumsq = 0.0;
+
+	for (uint i = 0; i < n; i++) {
+		sum += mean[i];
+		sumsq += mean[i] * mean[i];
+	}
+
+	real avg = n > 0 ? sum / n : 0.0;
+	real var = n > 1 ? (sumsq - sum * avg) / (n - 1) : 0.0;
+	real threshold = avg + sigma * sqrt(fmax(var, 0.0));
+
+	for (uint i = 0; i < n; i++)
+		keep[i] = mean[i] <= threshold;
+
+	struct cloudview *view = outlier_view(cloud, keep);
+
+	free(mean);
+	free(keep);
+
+	return view;
+}
+
+struct cloudview *outlier_radius(struct cloud *cloud, real radius, uint minpts)
+{
+	PROFILE_SPAN(__func__);
+
+	struct kdindex *index = cloud_index(cloud);
+	if (index == NULL)
+		return NULL;
+
+	struct outlier_job job;
+
+	job.array = cloud->array;
+	job.index = index;
+	job.radius = radius;
+	job.minpts = minpts;
+	job.keep = malloc(cloud->numpts + 1);
+
+	if (job.keep == NULL)
+		return NULL;
+
+	parallel_for(cloud->numpts,
+	             parallel_threads(),
+	             &outlier_radius_point,
+	             &job);
+
+	struct cloudview *view = outlier_view(cloud, job.keep);
+
+	free(job.keep);
+
+	return view;
+}
+
+static struct cloud *outlier_cloud(struct cloudview *view)
+{
+	if (view == NULL)
+		return NULL;
+
+	struct cloud *sub = cloudview_materialize(view);
+
+	cloudview_free(&view);
+
+	return sub;
+}
+
+struct cloud *outlier_filter_statistical(struct cloud *cloud,
+                                         uint k,
+                                         real sigma)
+{
+	return outlier_cloud(outlier_statistical(cloud, k, sigma));
+}
+
+struct cloud *outlier_filter_radius(struct cloud *cloud,
+                                    real radius,
+                                    uint minpts)
+{
+	return outlier_cloud(outlier_radius(cloud, radius, minpts));
+}
+
@@ -0,0 +1,196 @@
+#include "../include/parallel.h"
+
+static int parallel_work(void *arg)
+{
+	struct parallel_worker *worker = arg;
+	struct parallel_loop *loop = worker->loop;
+
+	PROFILE_SPAN("parallel_for");
+
+	for (uint i = atomic_fetch_add(&loop->next, 1);
+	     i < loop->n;
+	     i = atomic_fetch_add(&loop->next, 1))
+		loop->func(i, worker->thread, loop->data);
+
+	return 0;
+}
+
+uint parallel_threads()
+{
+	const char *env = getenv(PARALLEL_ENV);
+	long n = env != NULL ? atol(env) : sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (n < 1)
+		return 1;
+
+	return n > PARALLEL_MAXTHREADS ? PARALLEL_MAXTHREADS : (uint)n;
+}
+
+uint parallel_for(uint n, uint numthreads, parallel_func func, void *data)
+{
+	if (numthreads == 0)
+		numthreads = parallel_threads();
+
+	numthreads = numthreads > n ? n : numthreads;
+	numthreads = numthreads > PARALLEL_MAXTHREADS ? PARALLEL_MAXTHREADS :
+	                                                 numthreads;
+
+	struct parallel_loop loop = {n, 0, func, data};
+	struct parallel_worker workers[PARALLEL_MAXTHREADS];
+	thrd_t threads[PARALLEL_MAXTHREADS];
+	uint started = 1;
+
+	for (uint t = 1; t < numthreads; t++) {
+		workers[started].loop = &loop;
+		workers[started].team = NULL;
+		workers[started].thread = started;
+
+		if (thrd_create(&threads[started],
+		                parallel_work,
+		                &workers[started]) != thrd_success)
+			break;
+
+		started++;
+	}
+
+	workers[0].loop = &loop;
+	workers[0].team = NULL;
+	workers[0].thread = 0;
+	parallel_work(&workers[0]);
+
+	for (uint t = 1; t < started; t++)
+		thrd_join(threads[t], NULL);
+
+	return started;
+}
+
+static int parallel_team_work(void *arg)
+{
+	struct parallel_worker *worker = arg;
+	struct parallel_team *team = worker->team;
+	uint seen = 0;
+
+	mtx_lock(&team->lock);
+
+	while (1) {
+		while (team->generation == seen && !team->quit)
+			cnd_wait(&team->start, &team->lock);
+
+		if (team->quit)
+			break;
+
+		seen = team->generation;
+		mtx_unlock(&team->lock);
+
+		parallel_work(worker);
+
+		mtx_lock(&team->lock);
+		if (--team->pending == 0)
+			cnd_signal(&team->done);
+	}
+
+	mtx_unlock(&team->lock);
+
+	return 0;
+}
+
+struct parallel_team *parallel_team_new(uint numthreads)
+{
+	if (numthreads == 0)
+		numthreads = parallel_threads();
+
+	numthreads = numthreads > PARALLEL_MAXTHREADS ? PARALLEL_MAXTHREADS :
+	                                                 numthreads;
+
+	struct parallel_team *team = malloc(sizeof(struct parallel_team));
+	if (team == NULL)
+		return NULL;
+
+	team->numthreads = 1;
+	team->generation = 0;
+	team->pending = 0;
+	team->quit = 0;
+
+	if (mtx_init(&team->lock, mtx_plain) != thrd_success) {
+		free(team);
+		return NULL;
+	}
+
+	if (cnd_init(&team->start) != thrd_success) {
+		mtx_destroy(&team->lock);
+		free(team);
+		return NULL;
+	}
+
+	if (cnd_init(&team->done) != thrd_success) {
+		cnd_destroy(&team->start);
+		mtx_destroy(&team->lock);
+		free(team);
+		return NULL;
+	}
+
+	for (uint t = 0; t < numthreads; t++) {
+		team->workers[t].loop = &team->loop;
+		team->workers[t].team = team;
+		team->workers[t].thread = t;
+	}
+
+	for (uint t = 1; t < numthreads; t++) {
+		if (thrd_create(&team->threads[t],
+		                parallel_team_work,
+		                &team->workers[t]) != thrd_success)
+			break;
+
+		team->numthreads++;
+	}
+
+	return team;
+}
+
+void parallel_team_free(struct parallel_team **team)
+{
+	if (*team == NULL)
+		return;
+
+	mtx_lock(&(*team)->lock);
+	(*team)->quit = 1;
+	cnd_broadcast(&(*team)->start);
+	mtx_unlock(&(*team)->lock);
+
+	for (uint t = 1; t < (*team)->numthreads; t++)
+		thrd_join((*team)->threads[t], NULL);
+
+	cnd_destroy(&(*team)->done);
+	cnd_destroy(&(*team)->start);
+	mtx_destroy(&(*team)->lock);
+	free(*team);
+	*team = NULL;
+}
+
+void parallel_team_run(struct parallel_team *team,
+                       uint n,
+                       parallel_func func,
+                       void *data)
+{
+	mtx_lock(&team->lock);
+
+	team->loop.n = n;
+	atomic_store(&team->loop.next, 0);
+	team->loop.func = func;
+	team->loop.data = data;
+	team->pending = team->numthreads - 1;
+	team->generation++;
+	cnd_broadcast(&team->start);
+
+	mtx_unlock(&team->lock);
+
+	parallel_work(&team->workers[0]);
+
+	mtx_lock(&team->lock);
+
+	while (team->pending > 0)
+		cnd_wait(&team->done, &team->lock);
+
+	mtx_unlock(&team->lock);
+}
+
@@ -0,0 +1,402 @@
+#include "../include/planeseg.h"
+
+static int planeseg_sample(struct pointarray *array,
+                           uint n,
+                           uint64_t *state,
+                           real *coef)
+{
+	uint i = calc_rand64(state) % n;
+	uint j = calc_rand64(state) % n;
+	uint k = calc_rand64(state) % n;
+
+	if (i == j || i == k || j == k)
+		return 0;
+
+	real u[3] = {array->x[j] - array->x[i],
+	             array->y[j] - array->y[i],
+	             array->z[j] - array->z[i]};
+	real v[3] = {array->x[k] - array->x[i],
+	             array->y[k] - array->y[i],
+	             array->z[k] - array->z[i]};
+	real a = u[1] * v[2] - u[2] * v[1];
+	real b = u[2] * v[0] - u[0] * v[2];
+	real c = u[0] * v[1] - u[1] * v[0];
+	real len = calc_length3(a, b, c);
+
+	if (!(len > 0.0))
+		return 0;
+
+	coef[0] = a / len;
+	coef[1] = b / len;
+	coef[2] = c / len;
+	coef[3] = -(coef[0] * array->x[i] +
+	            coef[1] * array->y[i] +
+	            coef[2] * array->z[i]);
+
+	return 1;
+}
+
+static uint planeseg_count(struct pointarray *array,
+                           uint n,
+                           const real *coef,
+                           real threshold,
+                           uint best)
+{
+	uint count = 0;
+
+	for (uint begin = 0; begin < n; begin += PLANESEG_CHUNK) {
+		uint end = n - begin > PLANESEG_CHUNK ? begin + PLANESEG_CHUNK : n;
+
+		count += simd_count_plane(array, begin, end, coef, threshold);
+
+		if (count + (n - end) <= best)
+			break;
+	}
+
+	return count;
+}
+
+static uint planeseg_iterations(uint inliers, uint n)
+{
+	real w = (real)inliers / n;
+	real p = w * w * w;
+
+	if (p >= 1.0)
+		return 0;
+
+	real k = log(1.0 - PLANESEG_CONFIDENCE) / log1p(-p);
+
+	return k >= PLANESEG_MAXITER ? PLANESEG_MAXITER : (uint)ceil(k);
+}
+
+static uint planeseg_refine(struct pointarray *array,
+                            uint n,
+                            real threshold,
+                            real *coef,
+                            real *centroid)
+{
+	real t = threshold * threshold;
+	real mean[3] = {0.0, 0.0, 0.0};
+	uint count = 0;
+
+	for (uint i = 0; i < n; i++) {
+		real d = coef[0] * array->x[i] + coef[1] * array->y[i] +
+		         coef[2] * array->z[i] + coef[3];
+
+		if (d * d <= t) {
+			mean[0] += array->x[i];
+			mean[1] += array->y[i];
+			mean[2] += array->z[i];
+			count++;
+		}
+	}
+
+	if (count == 0)
+		return 0;
+
+	for (int a = 0; a < 3; a++)
+		centroid[a] = mean[a] / count;
+
+	if (count < 3)
+		return count;
+
+	struct mat3 cov = {{{0.0}}};
+
+	for (uint i = 0; i < n; i++) {
+		real d = coef[0] * array->x[i] + coef[1] * array->y[i] +
+		         coef[2] * array->z[i] + coef[3];
+
+		if (d * d > t)
+			continue;
+
+		real r[3] = {array->x[i] - centroid[0],
+		             array->y[i] - centroid[1],
+		             array->z[i] - centroid[2]};
+
+		for (int a = 0; a < 3; a++)
+			for (int b = a; b < 3; b++)
+				cov.m[a][b] += r[a] * r[b];
+	}
+
+	cov.m[1][0] = cov.m[0][1];
+	cov.m[2][0] = cov.m[0][2];
+	cov.m[2][1] = cov.m[1][2];
+
+	real values[3];
+	struct mat3 vectors;
+	real refined[4];
+
+	mat3_sym_eigen(&cov, values, &vectors);
+
+	refined[0] = vectors.m[0][0];
+	refined[1] = vectors.m[1][0];
+	refined[2] = vectors.m[2][0];
+	refined[3] = -(refined[0] * centroid[0] +
+	               refined[1] * centroid[1] +
+	               refined[2] * centroid[2]);
+
+	uint total = planeseg_count(array, n, refined, threshold, 0);
+
+	if (total >= count) {
+		for (int a = 0; a < 4; a++)
+			coef[a] = refined[a];
+
+		count = total;
+	}
+
+	return count;
+}
+
+static uint planeseg_fit(struct pointarray *array,
+                         uint n,
+                         real threshold,
+                         uint64_t *state,
+                         real *coef,
+                         real *centroid)
+{
+	uint best = 0;
+	uint needed = PLANESEG_MAXITER;
+	real hypothesis[4];
+
+	for (uint it = 0; it < needed; it++) {
+		if (!planeseg_sample(array, n, state, hypothesis))
+			continue;
+
+		uint count = planeseg_count(array, n, hypothesis, threshold, best);
+
+		if (count > best) {
+			best = count;
+			needed = planeseg_iterations(best, n);
+
+			for (int a = 0; a < 4; a++)
+				coef[a] = hypothesis[a];
+		}
+	}
+
+	if (best == 0)
+		return 0;
+
+	return planeseg_refine(array, n, threshold, coef, centroid);
+}
+
+static uint planeseg_split(struct pointarray *array,
+                           uint *pos,
+                           uint n,
+                           const real *coef,
+                           real threshold,
+                           struct cloudview *view)
+{
+	real t = threshold * threshold;
+	uint max = view->numids;
+	uint rest = 0;
+
+	view->numids = 0;
+
+	for (uint i = 0; i < n; i++) {
+		real d = coef[0] * array->x[i] + coef[1] * array->y[i] +
+		         coef[2] * array->z[i] + coef[3];
+
+		if (d * d <= t && view->numids < max) {
+			view->ids[view->numids++] = pos[i];
+		} else {
+			array->x[rest] = array->x[i];
+			array->y[rest] = array->y[i];
+			array->z[rest] = array->z[i];
+			pos[rest] = pos[i];
+			rest++;
+		}
+	}
+
+	return rest;
+}
+
+static struct plane *planeseg_new_plane(const real *coef, const real *centroid)
+{
+	struct vector3 *normal = vector3_new(coef[0], coef[1], coef[2]);
+	struct vector3 *point = vector3_new(centroid[0], centroid[1], centroid[2]);
+	struct plane *plane = NULL;
+
+	if (normal != NULL && point != NULL)
+		plane = plane_new(normal, point);
+
+	vector3_free(&normal);
+	vector3_free(&point);
+
+	return plane;
+}
+
+static int planeseg_peel(struct planeseg *seg,
+                         real threshold,
+                         uint minpts,
+                         uint maxplanes,
+                         uint64_t seed)
+{
+	struct pointarray *packed = cloud_pack(seg->cloud);
+	if (packed == NULL)
+		return 0;
+
+	uint n = packed->numpts;
+	struct pointarray *array = pointarray_new(n);
+	uint *pos = malloc((n + 1) * sizeof(uint));
+
+	if (array == NULL || pos == NULL) {
+		pointarray_free(&array);
+		free(pos);
+		return 0;
+	}
+
+	for (uint i = 0; i < n; i++) {
+		array->x[i] = packed->x[i];
+		array->y[i] = packed->y[i];
+		array->z[i] = packed->z[i];
+		pos[i] = i;
+	}
+
+	uint64_t state = seed;
+	int ok = 1;
+
+	while (seg->numplanes < maxplanes && n >= minpts) {
+		real coef[4];
+		real centroid[3];
+		uint count = planeseg_fit(array, n, threshold, &state, coef, centroid);
+
+		if (count < minpts)
+			break;
+
+		uint p = seg->numplanes;
+
+		seg->inliers[p] = cloudview_new(seg->cloud, count);
+		seg->planes[p] = planeseg_new_plane(coef, centroid);
+		seg->numplanes++;
+
+		if (seg->inliers[p] == NULL || seg->planes[p] == NULL) {
+			ok = 0;
+			break;
+		}
+
+		n = planeseg_split(array, pos, n, coef, threshold, seg->inliers[p]);
+	}
+
+	if (ok) {
+		seg->rest = cloudview_new(seg->cloud, n);
+		ok = seg->rest != NULL;
+	}
+
+	for (uint i = 0; ok && i < n; i++)
+		seg->rest->ids[i] = pos[i];
+
+	pointarray_free(&array);
+	free(pos);
+
+	return ok;
+}
+
+struct planeseg *planeseg_extract(struct cloud *cloud,
+                                  real threshold,
+                                  uint minpts,
+                                  uint maxplanes,
+                                  uint64_t seed)
+{
+	PROFILE_SPAN(__func__);
+
+	struct planeseg *seg = malloc(sizeof(struct planeseg));
+	if (seg == NULL)
+		return NULL;
+
+	seg->cloud = cloud;
+	seg->numplanes = 0;
+	seg->planes = calloc(maxplanes + 1, sizeof(struct plane *));
+	seg->inliers = calloc(maxplanes + 1, sizeof(struct cloudview *));
+	seg->rest = NULL;
+
+	minpts = minpts < 3 ? 3 : minpts;
+
+	if (seg->planes == NULL || seg->inliers == NULL ||
+	    !planeseg_peel(seg, threshold, minpts, maxplanes, seed)) {
+		planeseg_free(&seg);
+		return NULL;
+	}
+
+	return seg;
+}
+
+void planeseg_free(struct planeseg **seg)
+{
+	if (*seg == NULL)
+		return;
+
+	for (uint p = 0; p < (*seg)->numplanes; p++) {
+		plane_free(&(*seg)->planes[p]);
+		cloudview_free(&(*seg)->inliers[p]);
+	}
+
+	free((*seg)->planes);
+	free((*seg)->inliers);
+	cloudview_free(&(*seg)->rest);
+	free(*seg);
+	*seg = NULL;
+}
+
+struct cloudview *planeseg_largest(struct cloud *cloud,
+                                   real threshold,
+                                   uint64_t seed,
+                                   struct plane **plane)
+{
+	struct planeseg *seg = planeseg_extract(cloud, threshold, 3, 1, seed);
+	if (seg == NULL)
+		return NULL;
+
+	struct cloudview *view = NULL;
+
+	if (seg->numplanes > 0) {
+		view = seg->inliers[0];
+		seg->inliers[0] = NULL;
+
+		if (plane != NULL) {
+			*plane = seg->planes[0];
+			seg->planes[0] = NULL;
+		}
+	}
+
+	planeseg_free(&seg);
+
+	return view;
+}
+
+struct cloud *planeseg_strip(struct cloud *cloud,
+                             real threshold,
+                             uint minpts,
+                             uint maxplanes,
+                             uint64_t seed)
+{
+	struct planeseg *seg = planeseg_extract(cloud,
+	                                        threshold,
+	                                        minpts,
+	                                        maxplanes,
+	                                        seed);
+	if (seg == NULL)
+		return NULL;
+
+	struct cloud *sub = cloudview_materialize(seg->rest);
+
+	planeseg_free(&seg);
+
+	return sub;
+}
+
+void planeseg_debug(struct planeseg *seg, FILE *output)
+{
+	fprintf(output,
+	        "numplanes: %u of %u points\n",
+	        seg->numplanes,
+	        seg->cloud->numpts);
+
+	for (uint p = 0; p < seg->numplanes; p++) {
+		fprintf(output, "plane %u: %u inliers ", p, seg->inliers[p]->numids);
+		plane_debug(seg->planes[p], output);
+		fprintf(output, "\n");
+	}
+
+	fprintf(output, "rest: %u points\n", seg->rest->numids);
+}
+
@@ -0,0 +1,80 @@
+#include "../include/pointarray.h"
+
+static size_t pointarray_size(uint numpts)
+{
+	size_t size = numpts * sizeof(real);
+
+	return ((size / POINTARRAY_ALIGN) + 1) * POINTARRAY_ALIGN;
+}
+
+static real *pointarray_alloc(uint numpts)
+{
+	return mem_aligned(MEM_POINTARRAY,
+	                   POINTARRAY_ALIGN,
+	                   pointarray_size(numpts));
+}
+
+struct pointarray *pointarray_new(uint numpts)
+{
+	struct pointarray *array = mem_alloc(MEM_POINTARRAY,
+	                                     sizeof(struct pointarray));
+	if (array == NULL)
+		return NULL;
+
+	array->x = pointarray_alloc(numpts);
+	array->y = pointarray_alloc(numpts);
+	array->z = pointarray_alloc(numpts);
+	array->refs = mem_alloc(MEM_POINTARRAY,
+	                        (numpts + 1) * sizeof(struct vector3 *));
+	array->numpts = numpts;
+
+	if (array->x == NULL || array->y == NULL || array->z == NULL ||
+	    array->refs == NULL) {
+		pointarray_free(&array);
+		return NULL;
+	}
+
+	return array;
+}
+
+void pointarray_free(struct pointarray **array)
+{
+	if (*array == NULL)
+		return;
+
+	size_t size = pointarray_size((*array)->numpts);
+
+	mem_free(MEM_POINTARRAY, (*array)->x, size);
+	mem_free(MEM_POINTARRAY, (*array)->y, size);
+	mem_free(MEM_POINTARRAY, (*array)->z, size);
+	mem_free(MEM_POINTARRAY,
+	         (*array)->refs,
+	         ((*array)->numpts + 1) * sizeof(struct vector3 *));
+	mem_free(MEM_POINTARRAY, *array, sizeof(struct pointarray));
+	*array = NULL;
+}
+
+struct pointarray *pointarray_from_pointset(struct pointset *set)
+{
+	struct pointarray *array = pointarray_new(pointset_size(set));
+	if (array == NULL)
+		return NULL;
+
+	uint i = 0;
+	for (struct pointset *s = set; s != NULL; s = s->next) {
+		array->x[i] = s->point->x;
+		array->y[i] = s->point->y;
+		array->z[i] = s->point->z;
+		array->refs[i] = s->point;
+		i++;
+	}
+
+	return array;
+}
+
+void pointarray_debug(struct pointarray *array, FILE *output)
+{
+	for (uint i = 0; i < array->numpts; i++)
+		fprintf(output, "%le %le %le\n", array->x[i], array->y[i], array->z[i]);
+}
+
@@ -13,19 +13,21 @@ void pointset_free(struct pointset **set)
 	vector3_free(&(*set)->point);
 	pointset_free(&(*set)->next);
 	
-	free(*set);
+	mem_free(MEM_POINTSET, *set, sizeof(struct pointset));
 	*set = NULL;
 }
 
 struct vector3 *pointset_insert(struct pointset **set, real x, real y, real z)
 {
-	struct pointset *new = malloc(sizeof(struct pointset));
+	struct pointset *new = mem_alloc(MEM_POINTSET, sizeof(struct pointset));
 	if (new == NULL)
 		return NULL;
 	
 	new->point = vector3_new(x, y, z);
-	if (new->point == NULL)
+	if (new->point == NULL) {
+		mem_free(MEM_POINTSET, new, sizeof(struct pointset));
 		return NULL;
+	}
 	
 	new->next = *set;
 	new->prev = NULL;
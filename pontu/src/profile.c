@@ -0,0 +1,327 @@
+#include "../include/profile.h"
+
+static const char *profile_names[PROFILE_NUMSTAGES] = {"load",
+                                                       "partition",
+                                                       "nn",
+                                                       "moment",
+                                                       "cut",
+                                                       "icp",
+                                                       "other"};
+
+static struct profile_stage profile_stages[PROFILE_NUMSTAGES];
+
+static _Thread_local int profile_current = PROFILE_OTHER;
+
+static atomic_int profile_trace_on;
+
+static atomic_uint profile_trace_generation;
+
+static atomic_uint profile_trace_numthreads;
+
+static _Atomic(struct profile_trace *) profile_trace_list;
+
+static char *profile_trace_file;
+
+static uint64_t profile_trace_epoch;
+
+static _Thread_local struct profile_trace *profile_trace_own;
+
+static _Thread_local uint profile_trace_own_generation;
+
+static uint64_t profile_nanos()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static struct profile_trace *profile_trace_thread()
+{
+	uint generation = atomic_load(&profile_trace_generation);
+
+	if (profile_trace_own != NULL &&
+	    profile_trace_own_generation == generation)
+		return profile_trace_own;
+
+	struct profile_trace *trace = calloc(1, sizeof(struct profile_trace));
+	if (trace == NULL)
+		return NULL;
+
+	trace->thread = atomic_fetch_add(&profile_trace_numthreads, 1) + 1;
+	trace->next = atomic_load(&profile_trace_list);
+
+	while (!atomic_compare_exchange_weak(&profile_trace_list,
+	                                     &trace->next,
+	                                     trace))
+		;
+
+	profile_trace_own = trace;
+	profile_trace_own_generation = generation;
+
+	return trace;
+}
+
+static void profile_trace_record(struct profile_scope *scope, uint64_t end)
+{
+	struct profile_trace *trace = profile_trace_thread();
+	if (trace == NULL)
+		return;
+
+	if (trace->numevents == trace->capacity) {
+		uint32_t capacity = trace->capacity == 0 ? PROFILE_TRACE_MINEVENTS :
+		                                           2 * trace->capacity;
+		struct profile_event *events = NULL;
+
+		if (capacity <= PROFILE_TRACE_MAXEVENTS)
+			events = realloc(trace->events,
+			                 capacity * sizeof(struct profile_event));
+
+		if (events == NULL) {
+			trace->dropped++;
+			return;
+		}
+
+		trace->events = events;
+		trace->capacity = capacity;
+	}
+
+	struct profile_event *event = &trace->events[trace->numevents++];
+
+	event->name = scope->name;
+	event->stage = scope->stage;
+	event->start = scope->start;
+	event->duration = end - scope->start;
+}
+
+struct profile_scope profile_begin(int stage, const char *name)
+{
+	struct profile_scope scope;
+
+	scope.stage = stage;
+	scope.outer = profile_current;
+	scope.name = name;
+	scope.points = 0;
+	scope.start = profile_nanos();
+
+	if (stage != PROFILE_NONE)
+		profile_current = stage;
+
+	return scope;
+}
+
+void profile_end(struct profile_scope *scope)
+{
+	profile_current = scope->outer;
+
+	if (scope->name != NULL && atomic_load(&profile_trace_on))
+		profile_trace_record(scope, profile_nanos());
+
+	if (scope->stage == PROFILE_NONE || scope->outer == scope->stage)
+		return;
+
+	struct profile_stage *stage = &profile_stages[scope->stage];
+
+	atomic_fetch_add(&stage->calls, 1);
+	atomic_fetch_add(&stage->nanos, profile_nanos() - scope->start);
+	atomic_fetch_add(&stage->points, scope->points);
+}
+
+void profile_bytes(uint64_t bytes)
+{
+	atomic_fetch_add(&profile_stages[profile_current].bytes, bytes);
+}
+
+int profile_enabled()
+{
+#ifdef PONTU_PROFILE
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+const char *profile_name(int stage)
+{
+	if (stage < 0 || stage >= PROFILE_NUMSTAGES)
+		return NULL;
+
+	return profile_names[stage];
+}
+
+struct profile_stage *profile_get(int stage)
+{
+	if (stage < 0 || stage >= PROFILE_NUMSTAGES)
+		return NULL;
+
+	return &profile_stages[stage];
+}
+
+void profile_reset()
+{
+	for (int s = 0; s < PROFILE_NUMSTAGES; s++) {
+		atomic_store(&profile_stages[s].calls, 0);
+		atomic_store(&profile_stages[s].nanos, 0);
+		atomic_store(&profile_stages[s].points, 0);
+		atomic_store(&profile_stages[s].bytes, 0);
+	}
+}
+
+void profile_report(FILE *output, int format)
+{
+	int first = 1;
+
+	if (format == PROFILE_JSON)
+		fprintf(output, "{\"enabled\": %d, \"stages\": [", profile_enabled());
+	else
+		fprintf(output,
+		        "%-10s %10s %12s %12s %14s\n",
+		        "stage",
+		        "calls",
+		        "seconds",
+		        "points",
+		        "bytes");
+
+	for (int s = 0; s < PROFILE_NUMSTAGES; s++) {
+		uint64_t calls = atomic_load(&profile_stages[s].calls);
+		uint64_t nanos = atomic_load(&profile_stages[s].nanos);
+		uint64_t points = atomic_load(&profile_stages[s].points);
+		uint64_t bytes = atomic_load(&profile_stages[s].bytes);
+
+		if (calls == 0 && bytes == 0)
+			continue;
+
+		if (format == PROFILE_JSON) {
+			fprintf(output,
+			        "%s{\"stage\": \"%s\", \"calls\": %lu, "
+			        "\"seconds\": %.9f, \"points\": %lu, \"bytes\": %lu}",
+			        first ? "" : ", ",
+			        profile_names[s],
+			        (unsigned long)calls,
+			        nanos * 1e-9,
+			        (unsigned long)points,
+			        (unsigned long)bytes);
+		} else {
+			fprintf(output,
+			        "%-10s %10lu %12.6f %12lu %14lu\n",
+			        profile_names[s],
+			        (unsigned long)calls,
+			        nanos * 1e-9,
+			        (unsigned long)points,
+			        (unsigned long)bytes);
+		}
+
+		first = 0;
+	}
+
+	if (format == PROFILE_JSON)
+		fprintf(output, "]}\n");
+}
+
+int profile_trace_open(const char *filename)
+{
+	if (!profile_enabled() || profile_trace_file != NULL)
+		return 0;
+
+	profile_trace_file = malloc(strlen(filename) + 1);
+	if (profile_trace_file == NULL)
+		return 0;
+
+	strcpy(profile_trace_file, filename);
+	profile_trace_epoch = profile_nanos();
+	atomic_store(&profile_trace_on, 1);
+
+	return 1;
+}
+
+static void profile_trace_save(FILE *output, struct profile_trace *list)
+{
+	int first = 1;
+
+	fprintf(output, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+
+	for (struct profile_trace *t = list; t != NULL; t = t->next) {
+		fprintf(output,
+		        "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", "
+		        "\"pid\": 1, \"tid\": %u, "
+		        "\"args\": {\"name\": \"thread %u\", \"dropped\": %lu}}",
+		        first ? "" : ",",
+		        t->thread,
+		        t->thread,
+		        (unsigned long)t->dropped);
+
+		first = 0;
+
+		for (uint32_t e = 0; e < t->numevents; e++) {
+			struct profile_event *event = &t->events[e];
+			uint64_t start = event->start > profile_trace_epoch ?
+			                 event->start - profile_trace_epoch : 0;
+
+			fprintf(output,
+			        ",\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", "
+			        "\"ts\": %.3f, \"dur\": %.3f, \"pid\": 1, \"tid\": %u}",
+			        event->name,
+			        event->stage == PROFILE_NONE ? "span" :
+			                                       profile_names[event->stage],
+			        start * 1e-3,
+			        event->duration * 1e-3,
+			        t->thread);
+		}
+	}
+
+	fprintf(output, "\n]}\n");
+}
+
+int profile_trace_close()
+{
+	if (profile_trace_file == NULL)
+		return 0;
+
+	atomic_store(&profile_trace_on, 0);
+	atomic_fetch_add(&profile_trace_generation, 1);
+
+	struct profile_trace *list = atomic_exchange(&profile_trace_list, NULL);
+	FILE *output = fopen(profile_trace_file, "w");
+
+	if (output != NULL) {
+		profile_trace_save(output, list);
+		fclose(output);
+	}
+
+	while (list != NULL) {
+		struct profile_trace *next = list->next;
+		free(list->events);
+		free(list);
+		list = next;
+	}
+
+	free(profile_trace_file);
+	profile_trace_file = NULL;
+	atomic_store(&profile_trace_numthreads, 0);
+
+	return output != NULL;
+}
+
+int profile_tracing()
+{
+	return atomic_load(&profile_trace_on);
+}
+
+#ifdef PONTU_PROFILE
+
+static void profile_trace_exit()
+{
+	profile_trace_close();
+}
+
+__attribute__((constructor)) static void profile_trace_env()
+{
+	const char *filename = getenv(PROFILE_TRACE_ENV);
+
+	if (filename != NULL && *filename != '\0' &&
+	    profile_trace_open(filename))
+		atexit(&profile_trace_exit);
+}
+
+#endif
+
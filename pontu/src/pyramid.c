@@ -0,0 +1,76 @@
+#include "../include/pyramid.h"
+
+struct pyramid *pyramid_new(struct cloud *cloud, uint numlevels, real leafsize)
+{
+	if (numlevels == 0)
+		return NULL;
+
+	if (leafsize <= 0.0) {
+		struct simd_stats stats;
+		if (!cloud_reduce(cloud, &stats) || stats.numpts == 0)
+			return NULL;
+
+		leafsize = calc_length3(stats.max[0] - stats.min[0],
+		                        stats.max[1] - stats.min[1],
+		                        stats.max[2] - stats.min[2]);
+		leafsize /= PYRAMID_RESOLUTION;
+
+		if (leafsize <= 0.0)
+			return NULL;
+	}
+
+	struct pyramid *pyr = malloc(sizeof(struct pyramid));
+	if (pyr == NULL)
+		return NULL;
+
+	pyr->numlevels = numlevels;
+	pyr->leafsizes = calloc(numlevels, sizeof(real));
+	pyr->levels = calloc(numlevels, sizeof(struct cloud *));
+
+	if (pyr->leafsizes == NULL || pyr->levels == NULL) {
+		pyramid_free(&pyr);
+		return NULL;
+	}
+
+	pyr->levels[0] = cloud;
+
+	for (uint i = 1; i < numlevels; i++) {
+		pyr->leafsizes[i] = leafsize;
+		pyr->levels[i] = voxelgrid_sampling(pyr->levels[i - 1], leafsize);
+
+		if (pyr->levels[i] == NULL) {
+			pyramid_free(&pyr);
+			return NULL;
+		}
+
+		leafsize *= 2.0;
+	}
+
+	return pyr;
+}
+
+void pyramid_free(struct pyramid **pyr)
+{
+	if (*pyr == NULL)
+		return;
+
+	if ((*pyr)->levels != NULL)
+		for (uint i = 1; i < (*pyr)->numlevels; i++)
+			cloud_free(&(*pyr)->levels[i]);
+
+	free((*pyr)->leafsizes);
+	free((*pyr)->levels);
+	free(*pyr);
+	*pyr = NULL;
+}
+
+void pyramid_debug(struct pyramid *pyr, FILE *output)
+{
+	for (uint i = 0; i < pyr->numlevels; i++)
+		fprintf(output,
+		        "level %u: leafsize %le | numpts %u\n",
+		        i,
+		        pyr->leafsizes[i],
+		        pyr->levels[i]->numpts);
+}
+
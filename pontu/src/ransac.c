@@ -0,0 +1,222 @@
+#include "../include/ransac.h"
+
+struct ransac_job {
+	struct fpfh *from;
+	struct fpfh *to;
+	uint *nearest;
+};
+
+static void ransac_match(uint i, uint thread, void *data)
+{
+	struct ransac_job *job = data;
+
+	job->nearest[i] = fpfh_nearest(job->to,
+	                               &job->from->hist[i * FPFH_BINS],
+	                               NULL);
+
+	(void)thread;
+}
+
+static real ransac_distance(struct pointarray *a, uint i, uint j)
+{
+	real dx = a->x[i] - a->x[j];
+	real dy = a->y[i] - a->y[j];
+	real dz = a->z[i] - a->z[j];
+
+	return sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+static uint ransac_count(struct pointarray *src,
+                         struct pointarray *tgt,
+                         uint *pairs,
+                         uint numpairs,
+                         struct rigid3 *rt,
+                         real sqthreshold,
+                         uint *inliers)
+{
+	uint count = 0;
+
+	for (uint i = 0; i < numpairs; i++) {
+		uint s = pairs[2 * i];
+		uint t = pairs[2 * i + 1];
+		struct vector3 v = {{{src->x[s], src->y[s], src->z[s]}}};
+
+		v = rigid3_apply(rt, &v);
+
+		real dx = v.x - tgt->x[t];
+		real dy = v.y - tgt->y[t];
+		real dz = v.z - tgt->z[t];
+
+		if (dx * dx + dy * dy + dz * dz < sqthreshold) {
+			if (inliers != NULL)
+				inliers[count] = i;
+
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static void ransac_solve(struct pointarray *src,
+                         struct pointarray *tgt,
+                         uint *pairs,
+                         uint *sample,
+                         uint size,
+                         struct rigid3 *rt)
+{
+	struct horn horn;
+
+	horn_reset(&horn);
+
+	for (uint i = 0; i < size; i++) {
+		uint s = pairs[2 * sample[i]];
+		uint t = pairs[2 * sample[i] + 1];
+		struct vector3 v = {{{src->x[s], src->y[s], src->z[s]}}};
+		struct vector3 w = {{{tgt->x[t], tgt->y[t], tgt->z[t]}}};
+
+		horn_add(&horn, &v, &w, 1.0);
+	}
+
+	horn_solve(&horn, rt);
+}
+
+uint ransac_align(struct cloud *source,
+                  struct cloud *target,
+                  struct fpfh *fs,
+                  struct fpfh *ft,
+                  real threshold,
+                  uint iterations,
+                  uint64_t seed,
+                  struct rigid3 *rt)
+{
+	*rt = rigid3_identity();
+
+	struct pointarray *src = cloud_pack(source);
+	struct pointarray *tgt = cloud_pack(target);
+
+	if (src == NULL || tgt == NULL || fs->numpts != src->numpts ||
+	    ft->numpts != tgt->numpts || src->numpts < 3 || tgt->numpts < 3)
+		return 0;
+
+	uint *forward = malloc(src->numpts * sizeof(uint));
+	uint *backward = malloc(tgt->numpts * sizeof(uint));
+	uint *pairs = malloc(2 * src->numpts * sizeof(uint));
+	uint *inliers = malloc(src->numpts * sizeof(uint));
+
+	if (forward == NULL || backward == NULL ||
+	    pairs == NULL || inliers == NULL) {
+		free(forward);
+		free(backward);
+		free(pairs);
+		free(inliers);
+		return 0;
+	}
+
+	struct ransac_job job = {fs, ft, forward};
+	parallel_for(src->numpts, 0, &ransac_match, &job);
+
+	job.from = ft;
+	job.to = fs;
+	job.nearest = backward;
+	parallel_for(tgt->numpts, 0, &ransac_match, &job);
+
+	uint numpairs = 0;
+
+	for (uint i = 0; i < src->numpts; i++) {
+		if (backward[forward[i]] == i) {
+			pairs[2 * numpairs] = i;
+			pairs[2 * numpairs + 1] = forward[i];
+			numpairs++;
+		}
+	}
+
+	if (numpairs < RANSAC_MINPAIRS) {
+		for (numpairs = 0; numpairs < src->numpts; numpairs++) {
+			pairs[2 * numpairs] = numpairs;
+			pairs[2 * numpairs + 1] = forward[numpairs];
+		}
+	}
+
+	uint64_t state = seed;
+	real sqthreshold = threshold * threshold;
+	uint best = 0;
+	struct rigid3 hyp;
+
+	for (uint iter = 0; iter < iterations; iter++) {
+		uint sample[3];
+
+		sample[0] = calc_rand64(&state) % numpairs;
+		sample[1] = calc_rand64(&state) % numpairs;
+		sample[2] = calc_rand64(&state) % numpairs;
+
+		if (sample[0] == sample[1] || sample[0] == sample[2] ||
+		    sample[1] == sample[2])
+			continue;
+
+		int similar = 1;
+
+		for (int e = 0; e < 3 && similar; e++) {
+			uint a = sample[e];
+			uint b = sample[(e + 1) % 3];
+			real ds = ransac_distance(src, pairs[2 * a], pairs[2 * b]);
+			real dt = ransac_distance(tgt,
+			                          pairs[2 * a + 1],
+			                          pairs[2 * b + 1]);
+
+			similar = ds > 0.0 && dt > 0.0 &&
+			          (ds < dt ? ds / dt : dt / ds) >= RANSAC_EDGE;
+		}
+
+		if (!similar)
+			continue;
+
+		ransac_solve(src, tgt, pairs, sample, 3, &hyp);
+
+		uint count = ransac_count(src,
+		                          tgt,
+		                          pairs,
+		                          numpairs,
+		                          &hyp,
+		                          sqthreshold,
+		                          NULL);
+
+		if (count > best) {
+			best = count;
+			*rt = hyp;
+		}
+	}
+
+	if (best >= 3) {
+		uint count = ransac_count(src,
+		                          tgt,
+		                          pairs,
+		                          numpairs,
+		                          rt,
+		                          sqthreshold,
+		                          inliers);
+
+		ransac_solve(src, tgt, pairs, inliers, count, &hyp);
+
+		uint refined = ransac_count(src,
+		                            tgt,
+		                            pairs,
+		                            numpairs,
+		                            &hyp,
+		                            sqthreshold,
+		                            NULL);
+
+		if (refined >= best) {
+			best = refined;
+			*rt = hyp;
+		}
+	}
+
+	free(forward);
+	free(backward);
+	free(pairs);
+	free(inliers);
+
+	return best;
+}
+
@@ -34,183 +34,45 @@ struct cloud *registration_closest_points_tree(struct cloud *source,
     return closest_points;
 }
 
-struct matrix *registration_align(struct cloud *source, struct cloud *target)
+int registration_align_rigid(struct cloud *source,
+                             struct cloud *target,
+                             real *weights,
+                             struct rigid3 *rt)
 {
-    cloud_calc_centroid(source);
-    cloud_calc_centroid(target);
-
-    struct matrix *source_aux = matrix_new(3, 1);
-    struct matrix *target_aux = matrix_new(1, 3);
-
-    matrix_set(source_aux, 0, 0, source->centroid->x);
-    matrix_set(source_aux, 1, 0, source->centroid->y);
-    matrix_set(source_aux, 2, 0, source->centroid->z);
-
-    matrix_set(target_aux, 0, 0, target->centroid->x);
-    matrix_set(target_aux, 0, 1, target->centroid->y);
-    matrix_set(target_aux, 0, 2, target->centroid->z);
-
-    struct matrix *centroid_prod = algebra_mat_prod(source_aux, target_aux);
-    struct matrix *s = matrix_new(3, 3);
+	struct horn horn;
+	
+	horn_reset(&horn);
 	
 	struct pointset *src = source->points;
 	struct pointset *tgt = target->points;
 	
-    while (src != NULL && tgt != NULL) {
-        matrix_set(s, 0, 0,
-                   matrix_get(s, 0, 0) +
-                   src->point->x * tgt->point->x - 
-                   matrix_get(centroid_prod, 0, 0));
-
-        matrix_set(s, 0, 1,
-                   matrix_get(s, 0, 1) +
-                   src->point->x * tgt->point->y - 
-                   matrix_get(centroid_prod, 0, 1));
-
-        matrix_set(s, 0, 2,
-                   matrix_get(s, 0, 2) +
-                   src->point->x * tgt->point->z - 
-                   matrix_get(centroid_prod, 0, 2));
-
-        matrix_set(s, 1, 0,
-                   matrix_get(s, 1, 0) +
-                   src->point->y * tgt->point->x - 
-                   matrix_get(centroid_prod, 1, 0));
-
-        matrix_set(s, 1, 1,
-                   matrix_get(s, 1, 1) +
-                   src->point->y * tgt->point->y - 
-                   matrix_get(centroid_prod, 1, 1));
-
-        matrix_set(s, 1, 2,
-                   matrix_get(s, 1, 2) +
-                   src->point->y * tgt->point->z - 
-                   matrix_get(centroid_prod, 1, 2));
-
-        matrix_set(s, 2, 0,
-                   matrix_get(s, 2, 0) +
-                   src->point->z * tgt->point->x - 
-                   matrix_get(centroid_prod, 2, 0));
-
-        matrix_set(s, 2, 1,
-                   matrix_get(s, 2, 1) +
-                   src->point->z * tgt->point->y - 
-                   matrix_get(centroid_prod, 2, 1));
-
-        matrix_set(s, 2, 2,
-                   matrix_get(s, 2, 2) +
-                   src->point->z * tgt->point->z - 
-                   matrix_get(centroid_prod, 2, 2));
+	for (uint i = 0; src != NULL && tgt != NULL; i++) {
+		horn_add(&horn,
+		         src->point,
+		         tgt->point,
+		         weights == NULL ? 1.0 : weights[i]);
 		
 		src = src->next;
 		tgt = tgt->next;
-    }
+	}
+	
+	return horn_solve(&horn, rt);
+}
 
-    s = algebra_mat_vs_scalar(s, 1.0/((double)source->numpts));
-    
-    struct matrix *a = algebra_mat_sub(s, algebra_mat_transpose(s));
-    struct matrix *q = matrix_new(4, 4);
-
-    real tr_s = algebra_mat_trace(s);
-
-    matrix_set(q, 0, 0, tr_s);
-    matrix_set(q, 0, 1, matrix_get(a, 1, 2));
-    matrix_set(q, 0, 2, matrix_get(a, 2, 0));
-    matrix_set(q, 0, 3, matrix_get(a, 0, 1));
-    matrix_set(q, 1, 0, matrix_get(a, 1, 2));
-    matrix_set(q, 2, 0, matrix_get(a, 2, 0));
-    matrix_set(q, 3, 0, matrix_get(a, 0, 1));
-
-    matrix_set(q, 1, 1, matrix_get(s, 0, 0) * 2.0 - tr_s);
-    matrix_set(q, 2, 2, matrix_get(s, 1, 1) * 2.0 - tr_s);
-    matrix_set(q, 3, 3, matrix_get(s, 2, 2) * 2.0 - tr_s);
-
-    matrix_set(q, 1, 2, matrix_get(s, 0, 1) + matrix_get(s, 1, 0));
-    matrix_set(q, 1, 3, matrix_get(s, 0, 2) + matrix_get(s, 2, 0));
-    matrix_set(q, 2, 3, matrix_get(s, 1, 2) + matrix_get(s, 2, 1));
-
-    matrix_set(q, 2, 1, matrix_get(q, 1, 2));
-    matrix_set(q, 3, 1, matrix_get(q, 1, 3));
-    matrix_set(q, 3, 2, matrix_get(q, 2, 3));
-
-    struct matrix *eig_val = algebra_mat_eigen_val(q);
-    struct matrix *eig_vec = algebra_mat_eigen_vec(q, eig_val);
-
-    uint max_eig_idx = 0;
-    real eig_aux = creal(matrix_get(eig_val, 0, 0));
-    for (uint i = 0; i < eig_val->rows; i++) {
-        if (eig_aux < creal(matrix_get(eig_val, i, 0))) {
-            eig_aux = creal(matrix_get(eig_val, i, 0));
-            max_eig_idx = i;
-        }
-    }
+struct matrix *registration_align_weighted(struct cloud *source,
+                                          struct cloud *target,
+                                          real *weights)
+{
+	struct rigid3 rt;
+	
+	registration_align_rigid(source, target, weights, &rt);
+	
+	return rigid3_to_matrix(&rt);
+}
 
-    struct matrix *r = matrix_new(3, 3);
-
-    real q0 = creal(matrix_get(eig_vec, 0, max_eig_idx));
-    real q1 = creal(matrix_get(eig_vec, 1, max_eig_idx));
-    real q2 = creal(matrix_get(eig_vec, 2, max_eig_idx));
-    real q3 = creal(matrix_get(eig_vec, 3, max_eig_idx));
-
-    real mag = sqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
-
-    q0 /= mag;
-    q1 /= mag;
-    q2 /= mag;
-    q3 /= mag;
-
-    matrix_set(r, 0, 0, q0 * q0 + q1 * q1 - q2 * q2 - q3 * q3);
-    matrix_set(r, 0, 1, 2.0 * (q1 * q2 - q0 * q3));
-    matrix_set(r, 0, 2, 2.0 * (q1 * q3 + q0 * q2));
-    matrix_set(r, 1, 0, 2.0 * (q1 * q2 + q0 * q3));
-    matrix_set(r, 1, 1, q0 * q0 + q2 * q2 - q1 * q1 - q3 * q3);
-    matrix_set(r, 1, 2, 2.0 * (q2 * q3 - q0 * q1));
-    matrix_set(r, 2, 0, 2.0 * (q1 * q3 - q0 * q2));
-    matrix_set(r, 2, 1, 2.0 * (q2 * q3 + q0 * q1));
-    matrix_set(r, 2, 2, q0 * q0 + q3 * q3 - q1 * q1 - q2 * q2);
-
-    matrix_free(&target_aux);
-    target_aux = matrix_new(3, 1);
-    matrix_set(target_aux, 0, 0, target->centroid->x);
-    matrix_set(target_aux, 1, 0, target->centroid->y);
-    matrix_set(target_aux, 2, 0, target->centroid->z);
-
-    struct matrix *t = algebra_mat_sub(target_aux,
-                                        algebra_mat_prod(r, source_aux));
-    struct matrix *rt = matrix_new(4, 4);
-
-    matrix_set(rt, 0, 0, creal(matrix_get(r, 0, 0)));
-    matrix_set(rt, 0, 1, creal(matrix_get(r, 0, 1)));
-    matrix_set(rt, 0, 2, creal(matrix_get(r, 0, 2)));
-    matrix_set(rt, 1, 0, creal(matrix_get(r, 1, 0)));
-    matrix_set(rt, 1, 1, creal(matrix_get(r, 1, 1)));
-    matrix_set(rt, 1, 2, creal(matrix_get(r, 1, 2)));
-    matrix_set(rt, 2, 0, creal(matrix_get(r, 2, 0)));
-    matrix_set(rt, 2, 1, creal(matrix_get(r, 2, 1)));
-    matrix_set(rt, 2, 2, creal(matrix_get(r, 2, 2)));
-
-    matrix_set(rt, 0, 3, creal(matrix_get(t, 0, 0)));
-    matrix_set(rt, 1, 3, creal(matrix_get(t, 1, 0)));
-    matrix_set(rt, 2, 3, creal(matrix_get(t, 2, 0)));
-
-    matrix_set(rt, 3, 0, 0.0);
-    matrix_set(rt, 3, 1, 0.0);
-    matrix_set(rt, 3, 2, 0.0);
-    matrix_set(rt, 3, 3, 1.0);
-
-
-    matrix_free(&t);
-    matrix_free(&target_aux);
-    matrix_free(&source_aux);
-    matrix_free(&r);
-    matrix_free(&eig_val);
-    matrix_free(&eig_vec);
-    matrix_free(&q);
-    matrix_free(&a);
-    matrix_free(&s);
-    matrix_free(&centroid_prod);
-
-    return rt;
+struct matrix *registration_align(struct cloud *source, struct cloud *target)
+{
+	return registration_align_weighted(source, target, NULL);
 }
 
 struct matrix *registration_icp(struct cloud *source,
@@ -234,29 +96,17 @@ struct matrix *registration_icp(struct cloud *source,
         return NULL;
     }
 
-    struct matrix *rt = registration_align(source, eq_points);
-    if (rt == NULL) {
-        cloud_free(&eq_points);
-        cloud_free(aligned);
-        return NULL;
-    }
+    struct rigid3 rt;
+    struct rigid3 rt_final;
 
-    struct matrix *rt_final = matrix_copy(rt);
-    if (rt_final == NULL) {
-        cloud_free(&eq_points);
-        cloud_free(aligned);
-        matrix_free(&rt);
-        return NULL;
-    }
+    registration_align_rigid(source, eq_points, NULL, &rt);
+    rt_final = rt;
 
     real err, dif_err;
     
-    cloud_transform(*aligned, rt);
-
-    if (*aligned == NULL) {
+    if (!cloud_transform_rigid(*aligned, &rt)) {
         cloud_free(&eq_points);
-        matrix_free(&rt);
-        matrix_free(&rt_final);
+        cloud_free(aligned);
         return NULL;
     }
 
@@ -264,8 +114,6 @@ struct matrix *registration_icp(struct cloud *source,
     if (dif_err == -1) {
         cloud_free(&eq_points);
         cloud_free(aligned);
-        matrix_free(&rt);
-        matrix_free(&rt_final);
         return NULL;
     }
 
@@ -275,8 +123,6 @@ struct matrix *registration_icp(struct cloud *source,
     eq_points = (*closest)(*aligned, target);
     if (eq_points == NULL) {
         cloud_free(aligned);
-        matrix_free(&rt);
-        matrix_free(&rt_final);
         return NULL;
     }
 
@@ -284,46 +130,25 @@ struct matrix *registration_icp(struct cloud *source,
     if (err == -1) {
         cloud_free(&eq_points);
         cloud_free(aligned);
-        matrix_free(&rt);
-        matrix_free(&rt_final);
         return NULL;
     }
 
     dif_err -= err;
-
-    struct matrix* aux;
 	
     for (uint i = 0; i < k; i++) {
+        PROFILE_SCOPE(PROFILE_ICP);
+        PROFILE_POINTS((*aligned)->numpts);
+
         if (fabs(dif_err) < t) {
             break;
         }
 
-        rt = registration_align(*aligned, eq_points);
+        registration_align_rigid(*aligned, eq_points, NULL, &rt);
+        rt_final = rigid3_compose(&rt, &rt_final);
 
-        if (rt == NULL) {
+        if (!cloud_transform_rigid(*aligned, &rt)) {
             cloud_free(&eq_points);
             cloud_free(aligned);
-            matrix_free(&rt_final);
-            return NULL;
-        }
-
-        aux = algebra_mat_prod(rt, rt_final);
-        if (rt_final == NULL) {
-            cloud_free(&eq_points);
-            cloud_free(aligned);
-            matrix_free(&rt);
-            return NULL;
-        }
-
-        matrix_free(&rt_final);
-        rt_final = aux;
-
-        cloud_transform(*aligned, rt);
-
-        if (*aligned == NULL) {
-            cloud_free(&eq_points);
-            matrix_free(&rt);
-            matrix_free(&rt_final);
             return NULL;
         }
 
@@ -335,8 +160,6 @@ struct matrix *registration_icp(struct cloud *source,
         eq_points = (*closest)(*aligned, target);
         if (eq_points == NULL) {
             cloud_free(aligned);
-            matrix_free(&rt);
-            matrix_free(&rt_final);
             return NULL;
         }
 
@@ -344,8 +167,6 @@ struct matrix *registration_icp(struct cloud *source,
         if (err == -1) {
             cloud_free(&eq_points);
             cloud_free(aligned);
-            matrix_free(&rt);
-            matrix_free(&rt_final);
             return NULL;
         }
 
@@ -353,8 +174,118 @@ struct matrix *registration_icp(struct cloud *source,
     }
 	
     cloud_free(&eq_points);
-    matrix_free(&rt);
 
-    return rt_final;
+    return rigid3_to_matrix(&rt_final);
+}
+
+static struct matrix *registration_icp_output(struct cloud *source,
+                                              struct cloud **aligned,
+                                              struct rigid3 *rt)
+{
+	cloud_free(aligned);
+	*aligned = cloud_copy(source);
+
+	if (*aligned == NULL || !cloud_transform_rigid(*aligned, rt)) {
+		cloud_free(aligned);
+		return NULL;
+	}
+
+	return rigid3_to_matrix(rt);
+}
+
+struct matrix *registration_icp_plane(struct cloud *source,
+                                      struct cloud *target,
+                                      struct cloud **aligned,
+                                      real t,
+                                      uint k,
+                                      int metric)
+{
+	struct icp *icp = icp_new(source->numpts, metric);
+	if (icp == NULL)
+		return NULL;
+
+	struct matrix *rt = NULL;
+
+	if (icp_run(icp, source, target, t, k))
+		rt = registration_icp_output(source, aligned, &icp->rt);
+
+	icp_free(&icp);
+
+	return rt;
+}
+
+struct matrix *registration_icp_pyramid(struct pyramid *source,
+                                        struct pyramid *target,
+                                        struct cloud **aligned,
+                                        real t,
+                                        uint k,
+                                        int metric)
+{
+	struct icp *icp = icp_new(source->levels[0]->numpts, metric);
+	if (icp == NULL)
+		return NULL;
+
+	struct matrix *rt = NULL;
+
+	if (icp_run_pyramid(icp, source, target, t, k))
+		rt = registration_icp_output(source->levels[0], aligned, &icp->rt);
+
+	icp_free(&icp);
+
+	return rt;
+}
+
+struct matrix *registration_icp_global(struct cloud *source,
+                                       struct cloud *target,
+                                       struct cloud **aligned,
+                                       real t,
+                                       uint k,
+                                       int metric,
+                                       uint64_t seed)
+{
+	struct pyramid *ps = pyramid_new(source, REGISTRATION_GLOBAL_LEVELS, 0.0);
+	if (ps == NULL)
+		return NULL;
+
+	real leaf = ps->leafsizes[1];
+	struct pyramid *pt = pyramid_new(target, REGISTRATION_GLOBAL_LEVELS, leaf);
+	struct fpfh *full = fpfh_new(source, FPFH_K);
+	struct fpfh *fs = NULL;
+	struct fpfh *ft = NULL;
+	struct icp *icp = icp_new(source->numpts, metric);
+	struct matrix *rt = NULL;
+
+	if (full != NULL)
+		fs = fpfh_gather(full, source, ps->levels[1]);
+
+	fpfh_free(&full);
+	full = fpfh_new(target, FPFH_K);
+
+	if (full != NULL && pt != NULL)
+		ft = fpfh_gather(full, target, pt->levels[1]);
+
+	fpfh_free(&full);
+
+	if (fs != NULL && ft != NULL && icp != NULL) {
+		ransac_align(ps->levels[1],
+		             pt->levels[1],
+		             fs,
+		             ft,
+		             REGISTRATION_GLOBAL_INLIER * leaf,
+		             RANSAC_ITERATIONS,
+		             seed,
+		             &icp->rt);
+
+		if (icp_run_pyramid(icp, ps, pt, t, k))
+			rt = registration_icp_output(source, aligned, &icp->rt);
+	}
+
+	icp_free(&icp);
+	fpfh_free(&fs);
+	fpfh_free(&ft);
+	pyramid_free(&ps);
+	pyramid_free(&pt);
+
+	return rt;
 }
 
@@ -0,0 +1,309 @@
+#include "../include/rigid.h"
+
+static void rigid_cross(const real *a, const real *b, real *c)
+{
+	c[0] = a[1] * b[2] - a[2] * b[1];
+	c[1] = a[2] * b[0] - a[0] * b[2];
+	c[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static real rigid_dot(const real *a, const real *b)
+{
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void mat3_sym_vector(real (*m)[3], real value, real *v)
+{
+	real r[3][3];
+	real c[3][3];
+
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			r[i][j] = m[i][j] - (i == j ? value : 0.0);
+
+	rigid_cross(r[0], r[1], c[0]);
+	rigid_cross(r[0], r[2], c[1]);
+	rigid_cross(r[1], r[2], c[2]);
+
+	int best = 0;
+	real norm = rigid_dot(c[0], c[0]);
+
+	for (int i = 1; i < 3; i++) {
+		real d = rigid_dot(c[i], c[i]);
+		if (d > norm) {
+			norm = d;
+			best = i;
+		}
+	}
+
+	if (norm == 0.0) {
+		v[0] = 1.0;
+		v[1] = 0.0;
+		v[2] = 0.0;
+		return;
+	}
+
+	norm = sqrt(norm);
+	for (int i = 0; i < 3; i++)
+		v[i] = c[best][i] / norm;
+}
+
+static void mat3_sym_second(real (*m)[3], real value, const real *v, real *out)
+{
+	real u[3];
+	real w[3];
+	real mu[3];
+	real mw[3];
+
+	if (fabs(v[0]) > fabs(v[1])) {
+		real f = 1.0 / sqrt(v[0] * v[0] + v[2] * v[2]);
+		u[0] = -v[2] * f;
+		u[1] = 0.0;
+		u[2] = v[0] * f;
+	} else {
+		real f = 1.0 / sqrt(v[1] * v[1] + v[2] * v[2]);
+		u[0] = 0.0;
+		u[1] = v[2] * f;
+		u[2] = -v[1] * f;
+	}
+
+	rigid_cross(v, u, w);
+
+	for (int i = 0; i < 3; i++) {
+		mu[i] = rigid_dot(m[i], u) - value * u[i];
+		mw[i] = rigid_dot(m[i], w) - value * w[i];
+	}
+
+	real a = rigid_dot(u, mu);
+	real b = rigid_dot(u, mw);
+	real c = rigid_dot(w, mw);
+	real x = 1.0;
+	real y = 0.0;
+
+	if (a * a + b * b >= b * b + c * c) {
+		if (a != 0.0 || b != 0.0) {
+			x = b;
+			y = -a;
+		}
+	} else {
+		x = c;
+		y = -b;
+	}
+
+	real norm = sqrt(x * x + y * y);
+	for (int i = 0; i < 3; i++)
+		out[i] = (x * u[i] + y * w[i]) / norm;
+}
+
+struct mat3 mat3_rotation(const real *w)
+{
+	real theta = sqrt(rigid_dot(w, w));
+	real f = theta > 0.0 ? sin(0.5 * theta) / theta : 0.5;
+	real q[4] = {cos(0.5 * theta), f * w[0], f * w[1], f * w[2]};
+	struct mat3 r;
+
+	r.m[0][0] = q[0] * q[0] + q[1] * q[1] - q[2] * q[2] - q[3] * q[3];
+	r.m[0][1] = 2.0 * (q[1] * q[2] - q[0] * q[3]);
+	r.m[0][2] = 2.0 * (q[1] * q[3] + q[0] * q[2]);
+	r.m[1][0] = 2.0 * (q[1] * q[2] + q[0] * q[3]);
+	r.m[1][1] = q[0] * q[0] + q[2] * q[2] - q[1] * q[1] - q[3] * q[3];
+	r.m[1][2] = 2.0 * (q[2] * q[3] - q[0] * q[1]);
+	r.m[2][0] = 2.0 * (q[1] * q[3] - q[0] * q[2]);
+	r.m[2][1] = 2.0 * (q[2] * q[3] + q[0] * q[1]);
+	r.m[2][2] = q[0] * q[0] + q[3] * q[3] - q[1] * q[1] - q[2] * q[2];
+
+	return r;
+}
+
+void mat3_sym_eigen(const struct mat3 *a, real *values, struct mat3 *vectors)
+{
+	real scale = 0.0;
+
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			scale = fabs(a->m[i][j]) > scale ? fabs(a->m[i][j]) : scale;
+
+	*vectors = mat3_identity();
+
+	if (scale == 0.0) {
+		values[0] = values[1] = values[2] = 0.0;
+		return;
+	}
+
+	real m[3][3];
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			m[i][j] = a->m[i][j] / scale;
+
+	real off = m[0][1] * m[0][1] + m[0][2] * m[0][2] + m[1][2] * m[1][2];
+	real v[3][3];
+
+	if (off == 0.0) {
+		int order[3] = {0, 1, 2};
+
+		for (int i = 0; i < 2; i++) {
+			for (int j = i + 1; j < 3; j++) {
+				if (m[order[j]][order[j]] < m[order[i]][order[i]]) {
+					int tmp = order[i];
+					order[i] = order[j];
+					order[j] = tmp;
+				}
+			}
+		}
+
+		for (int j = 0; j < 3; j++) {
+			values[j] = a->m[order[j]][order[j]];
+			for (int i = 0; i < 3; i++)
+				vectors->m[i][j] = (i == order[j]) ? 1.0 : 0.0;
+		}
+
+		return;
+	}
+
+	real q = (m[0][0] + m[1][1] + m[2][2]) / 3.0;
+	real d[3] = {m[0][0] - q, m[1][1] - q, m[2][2] - q};
+	real p = sqrt((d[0] * d[0] + d[1] * d[1] + d[2] * d[2] + 2.0 * off) / 6.0);
+
+	struct mat3 b;
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			b.m[i][j] = (m[i][j] - (i == j ? q : 0.0)) / p;
+
+	real r = mat3_det(&b) / 2.0;
+	r = r < -1.0 ? -1.0 : (r > 1.0 ? 1.0 : r);
+
+	real phi = acos(r) / 3.0;
+	real l[3];
+
+	l[2] = q + 2.0 * p * cos(phi);
+	l[0] = q + 2.0 * p * cos(phi + (2.0 * CALC_PI / 3.0));
+	l[1] = 3.0 * q - l[0] - l[2];
+
+	if (l[2] - l[1] >= l[1] - l[0]) {
+		mat3_sym_vector(m, l[2], v[2]);
+		mat3_sym_second(m, l[1], v[2], v[1]);
+		rigid_cross(v[1], v[2], v[0]);
+	} else {
+		mat3_sym_vector(m, l[0], v[0]);
+		mat3_sym_second(m, l[1], v[0], v[1]);
+		rigid_cross(v[0], v[1], v[2]);
+	}
+
+	for (int j = 0; j < 3; j++) {
+		values[j] = l[j] * scale;
+		for (int i = 0; i < 3; i++)
+			vectors->m[i][j] = v[j][i];
+	}
+}
+
+int mat4_inverse(const struct mat4 *a, struct mat4 *inv)
+{
+	const real *m = &a->m[0][0];
+	real c[16];
+
+	c[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] -
+	       m[9] * m[6] * m[15] + m[9] * m[7] * m[14] +
+	       m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+	c[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] +
+	       m[8] * m[6] * m[15] - m[8] * m[7] * m[14] -
+	       m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+	c[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] -
+	       m[8] * m[5] * m[15] + m[8] * m[7] * m[13] +
+	       m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+	c[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] +
+	        m[8] * m[5] * m[14] - m[8] * m[6] * m[13] -
+	        m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+	c[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] +
+	       m[9] * m[2] * m[15] - m[9] * m[3] * m[14] -
+	       m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+	c[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] -
+	       m[8] * m[2] * m[15] + m[8] * m[3] * m[14] +
+	       m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+	c[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] +
+	       m[8] * m[1] * m[15] - m[8] * m[3] * m[13] -
+	       m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+	c[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] -
+	        m[8] * m[1] * m[14] + m[8] * m[2] * m[13] +
+	        m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+	c[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] -
+	       m[5] * m[2] * m[15] + m[5] * m[3] * m[14] +
+	       m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+	c[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] +
+	       m[4] * m[2] * m[15] - m[4] * m[3] * m[14] -
+	       m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+	c[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] -
+	        m[4] * m[1] * m[15] + m[4] * m[3] * m[13] +
+	        m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+	c[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] +
+	        m[4] * m[1] * m[14] - m[4] * m[2] * m[13] -
+	        m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+	c[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] +
+	       m[5] * m[2] * m[11] - m[5] * m[3] * m[10] -
+	       m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+	c[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] -
+	       m[4] * m[2] * m[11] + m[4] * m[3] * m[10] +
+	       m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+	c[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] +
+	        m[4] * m[1] * m[11] - m[4] * m[3] * m[9] -
+	        m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+	c[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] -
+	        m[4] * m[1] * m[10] + m[4] * m[2] * m[9] +
+	        m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+	real det = m[0] * c[0] + m[1] * c[4] + m[2] * c[8] + m[3] * c[12];
+	if (det == 0.0)
+		return 0;
+
+	det = 1.0 / det;
+
+	for (int i = 0; i < 16; i++)
+		inv->m[i / 4][i % 4] = c[i] * det;
+
+	return 1;
+}
+
+int rigid3_from_matrix(struct matrix *mat, struct rigid3 *rt)
+{
+	if (mat == NULL || mat->rows < 3 || mat->cols < 4)
+		return 0;
+
+	for (uint i = 0; i < 3; i++) {
+		for (uint j = 0; j < 3; j++)
+			rt->rot.m[i][j] = creal(matrix_get(mat, i, j));
+
+		rt->t[i] = creal(matrix_get(mat, i, 3));
+	}
+
+	return 1;
+}
+
+struct matrix *rigid3_to_matrix(const struct rigid3 *rt)
+{
+	struct matrix *mat = matrix_new(4, 4);
+	if (mat == NULL)
+		return NULL;
+
+	for (uint i = 0; i < 3; i++) {
+		for (uint j = 0; j < 3; j++)
+			matrix_set(mat, i, j, rt->rot.m[i][j]);
+
+		matrix_set(mat, i, 3, rt->t[i]);
+		matrix_set(mat, 3, i, 0.0);
+	}
+
+	matrix_set(mat, 3, 3, 1.0);
+
+	return mat;
+}
+
+void rigid3_debug(const struct rigid3 *rt, FILE *output)
+{
+	for (int i = 0; i < 3; i++)
+		fprintf(output,
+		        "%lf %lf %lf | %lf\n",
+		        rt->rot.m[i][0],
+		        rt->rot.m[i][1],
+		        rt->rot.m[i][2],
+		        rt->t[i]);
+}
+
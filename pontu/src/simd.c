@@ -0,0 +1,779 @@
+#include <string.h>
+#include <threads.h>
+
+#include "../include/simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86
+#endif
+
+typedef void (*simd_reduce_func)(struct pointarray *, struct simd_stats *);
+typedef real (*simd_distance_func)(struct pointarray *, real, real, real);
+typedef void (*simd_transform_func)(struct pointarray *,
+                                    const struct rigid3 *);
+typedef uint (*simd_farthest_func)(struct pointarray *,
+                                   uint,
+                                   uint,
+                                   real,
+                                   real,
+                                   real,
+                                   real *);
+typedef uint (*simd_plane_func)(struct pointarray *,
+                                uint,
+                                uint,
+                                const real *,
+                                real);
+
+struct simd_dispatch {
+	int level;
+	int supported;
+	simd_reduce_func reduce;
+	simd_distance_func maxdist;
+	simd_distance_func sumdist;
+	simd_transform_func transform;
+	simd_farthest_func farthest;
+	simd_plane_func plane;
+};
+
+static struct simd_dispatch simd_table;
+static once_flag simd_once = ONCE_FLAG_INIT;
+
+static void simd_stats_init(struct pointarray *array, struct simd_stats *stats)
+{
+	stats->numpts = array->numpts;
+
+	for (int k = 0; k < 3; k++) {
+		stats->min[k] = INFINITY;
+		stats->max[k] = -INFINITY;
+		stats->sum[k] = 0.0;
+		stats->origin[k] = 0.0;
+	}
+
+	for (int k = 0; k < 6; k++)
+		stats->moment[k] = 0.0;
+
+	if (array->numpts > 0) {
+		stats->origin[0] = array->x[0];
+		stats->origin[1] = array->y[0];
+		stats->origin[2] = array->z[0];
+	}
+}
+
+static void simd_reduce_range(struct pointarray *array,
+                              uint begin,
+                              uint end,
+                              struct simd_stats *stats)
+{
+	for (uint i = begin; i < end; i++) {
+		real x = array->x[i];
+		real y = array->y[i];
+		real z = array->z[i];
+
+		stats->min[0] = x < stats->min[0] ? x : stats->min[0];
+		stats->min[1] = y < stats->min[1] ? y : stats->min[1];
+		stats->min[2] = z < stats->min[2] ? z : stats->min[2];
+		stats->max[0] = x > stats->max[0] ? x : stats->max[0];
+		stats->max[1] = y > stats->max[1] ? y : stats->max[1];
+		stats->max[2] = z > stats->max[2] ? z : stats->max[2];
+
+		stats->sum[0] += x;
+		stats->sum[1] += y;
+		stats->sum[2] += z;
+
+		real dx = x - stats->origin[0];
+		real dy = y - stats->origin[1];
+		real dz = z - stats->origin[2];
+
+		stats->moment[0] += dx * dx;
+		stats->moment[1] += dx * dy;
+		stats->moment[2] += dx * dz;
+		stats->moment[3] += dy * dy;
+		stats->moment[4] += dy * dz;
+		stats->moment[5] += dz * dz;
+	}
+}
+
+static real simd_maxdist_range(struct pointarray *array,
+                               uint begin,
+                               uint end,
+                               real px,
+                               real py,
+                               real pz,
+                               real max)
+{
+	for (uint i = begin; i < end; i++) {
+		real d = calc_squared_length3(px - array->x[i],
+		                              py - array->y[i],
+		                              pz - array->z[i]);
+		if (d > max)
+			max = d;
+	}
+
+	return max;
+}
+
+static real simd_sumdist_range(struct pointarray *array,
+                               uint begin,
+                               uint end,
+                               real px,
+                               real py,
+                               real pz,
+                               real sum)
+{
+	for (uint i = begin; i < end; i++)
+		sum += calc_length3(px - array->x[i],
+		                    py - array->y[i],
+		                    pz - array->z[i]);
+
+	return sum;
+}
+
+static void simd_transform_range(struct pointarray *array,
+                                 uint begin,
+                                 uint end,
+                                 const struct rigid3 *rt)
+{
+	const real (*r)[3] = rt->rot.m;
+
+	for (uint i = begin; i < end; i++) {
+		real x = array->x[i];
+		real y = array->y[i];
+		real z = array->z[i];
+
+		array->x[i] = r[0][0] * x + r[0][1] * y + r[0][2] * z + rt->t[0];
+		array->y[i] = r[1][0] * x + r[1][1] * y + r[1][2] * z + rt->t[1];
+		array->z[i] = r[2][0] * x + r[2][1] * y + r[2][2] * z + rt->t[2];
+	}
+}
+
+static uint simd_farthest_range(struct pointarray *array,
+                                uint begin,
+                                uint mid,
+                                uint end,
+                                real px,
+                                real py,
+                                real pz,
+                                real *mind,
+                                real max)
+{
+	for (uint i = mid; i < end; i++) {
+		real d = calc_squared_length3(px - array->x[i],
+		                              py - array->y[i],
+		                              pz - array->z[i]);
+		if (d < mind[i])
+			mind[i] = d;
+
+		if (mind[i] > max)
+			max = mind[i];
+	}
+
+	for (uint i = begin; i < end; i++)
+		if (mind[i] == max)
+			return i;
+
+	return begin;
+}
+
+static uint simd_plane_range(struct pointarray *array,
+                             uint begin,
+                             uint end,
+                             const real *coef,
+                             real threshold,
+                             uint count)
+{
+	real t = threshold * threshold;
+
+	for (uint i = begin; i < end; i++) {
+		real d = coef[0] * array->x[i] + coef[1] * array->y[i] +
+		         coef[2] * array->z[i] + coef[3];
+
+		count += d * d <= t;
+	}
+
+	return count;
+}
+
+static void simd_reduce_scalar(struct pointarray *array,
+                               struct simd_stats *stats)
+{
+	simd_stats_init(array, stats);
+	simd_reduce_range(array, 0, array->numpts, stats);
+}
+
+static real simd_maxdist_scalar(struct pointarray *array,
+                                real px,
+                                real py,
+                                real pz)
+{
+	return simd_maxdist_range(array, 0, array->numpts, px, py, pz, 0.0);
+}
+
+static real simd_sumdist_scalar(struct pointarray *array,
+                                real px,
+                                real py,
+                                real pz)
+{
+	return simd_sumdist_range(array, 0, array->numpts, px, py, pz, 0.0);
+}
+
+static void simd_transform_scalar(struct pointarray *array,
+                                  const struct rigid3 *rt)
+{
+	simd_transform_range(array, 0, array->numpts, rt);
+}
+
+static uint simd_farthest_scalar(struct pointarray *array,
+                                 uint begin,
+                                 uint end,
+                                 real px,
+                                 real py,
+                                 real pz,
+                                 real *mind)
+{
+	return simd_farthest_range(array,
+	                           begin,
+	                           begin,
+	                           end,
+	                           px,
+	                           py,
+	                           pz,
+	                           mind,
+	                           -1.0);
+}
+
+static uint simd_plane_scalar(struct pointarray *array,
+                              uint begin,
+                              uint end,
+                              const real *coef,
+                              real threshold)
+{
+	return simd_plane_range(array, begin, end, coef, threshold, 0);
+}
+
+#ifdef SIMD_X86
+
+#define SIMD_HREDUCE(v, out, op)                                              \
+	do {                                                                      \
+		real lane[SIMD_WIDTH];                                                \
+		SIMD_STOREU(lane, v);                                                 \
+		for (int l = 0; l < SIMD_WIDTH; l++)                                  \
+			out = op(out, lane[l]);                                           \
+	} while (0)
+
+#define SIMD_PLUS(a, b) ((a) + (b))
+
+#define SIMD_TARGET(isa)                                                      \
+	__attribute__((target(isa), optimize("fp-contract=off")))
+
+#define SIMD_KERNELS(suffix, isa)                                             \
+SIMD_TARGET(isa)                                                              \
+static void simd_reduce_##suffix(struct pointarray *array,                    \
+                                 struct simd_stats *stats)                    \
+{                                                                             \
+	simd_stats_init(array, stats);                                            \
+	uint n = array->numpts - (array->numpts % SIMD_WIDTH);                    \
+	                                                                          \
+	SIMD_VEC ox = SIMD_SET1(stats->origin[0]);                                \
+	SIMD_VEC oy = SIMD_SET1(stats->origin[1]);                                \
+	SIMD_VEC oz = SIMD_SET1(stats->origin[2]);                                \
+	SIMD_VEC minx = SIMD_SET1(INFINITY);                                      \
+	SIMD_VEC miny = minx;                                                     \
+	SIMD_VEC minz = minx;                                                     \
+	SIMD_VEC maxx = SIMD_SET1(-INFINITY);                                     \
+	SIMD_VEC maxy = maxx;                                                     \
+	SIMD_VEC maxz = maxx;                                                     \
+	SIMD_VEC sumx = SIMD_SET1(0.0);                                           \
+	SIMD_VEC sumy = sumx;                                                     \
+	SIMD_VEC sumz = sumx;                                                     \
+	SIMD_VEC mxx = sumx;                                                      \
+	SIMD_VEC mxy = sumx;                                                      \
+	SIMD_VEC mxz = sumx;                                                      \
+	SIMD_VEC myy = sumx;                                                      \
+	SIMD_VEC myz = sumx;                                                      \
+	SIMD_VEC mzz = sumx;                                                      \
+	                                                                          \
+	for (uint i = 0; i < n; i += SIMD_WIDTH) {                                \
+		SIMD_VEC x = SIMD_LOAD(array->x + i);                                 \
+		SIMD_VEC y = SIMD_LOAD(array->y + i);                                 \
+		SIMD_VEC z = SIMD_LOAD(array->z + i);                                 \
+		                                                                      \
+		minx = SIMD_MIN(minx, x);                                             \
+		miny = SIMD_MIN(miny, y);                                             \
+		minz = SIMD_MIN(minz, z);                                             \
+		maxx = SIMD_MAX(maxx, x);                                             \
+		maxy = SIMD_MAX(maxy, y);                                             \
+		maxz = SIMD_MAX(maxz, z);                                             \
+		                                                                      \
+		sumx = SIMD_ADD(sumx, x);                                             \
+		sumy = SIMD_ADD(sumy, y);                                             \
+		sumz = SIMD_ADD(sumz, z);                                             \
+		                                                                      \
+		SIMD_VEC dx = SIMD_SUB(x, ox);                                        \
+		SIMD_VEC dy = SIMD_SUB(y, oy);                                        \
+		SIMD_VEC dz = SIMD_SUB(z, oz);                                        \
+		                                                                      \
+		mxx = SIMD_ADD(mxx, SIMD_MUL(dx, dx));                                \
+		mxy = SIMD_ADD(mxy, SIMD_MUL(dx, dy));                                \
+		mxz = SIMD_ADD(mxz, SIMD_MUL(dx, dz));                                \
+		myy = SIMD_ADD(myy, SIMD_MUL(dy, dy));                                \
+		myz = SIMD_ADD(myz, SIMD_MUL(dy, dz));                                \
+		mzz = SIMD_ADD(mzz, SIMD_MUL(dz, dz));                                \
+	}                                                                         \
+	                                                                          \
+	SIMD_HREDUCE(minx, stats->min[0], fmin);                                  \
+	SIMD_HREDUCE(miny, stats->min[1], fmin);                                  \
+	SIMD_HREDUCE(minz, stats->min[2], fmin);                                  \
+	SIMD_HREDUCE(maxx, stats->max[0], fmax);                                  \
+	SIMD_HREDUCE(maxy, stats->max[1], fmax);                                  \
+	SIMD_HREDUCE(maxz, stats->max[2], fmax);                                  \
+	SIMD_HREDUCE(sumx, stats->sum[0], SIMD_PLUS);                             \
+	SIMD_HREDUCE(sumy, stats->sum[1], SIMD_PLUS);                             \
+	SIMD_HREDUCE(sumz, stats->sum[2], SIMD_PLUS);                             \
+	SIMD_HREDUCE(mxx, stats->moment[0], SIMD_PLUS);                           \
+	SIMD_HREDUCE(mxy, stats->moment[1], SIMD_PLUS);                           \
+	SIMD_HREDUCE(mxz, stats->moment[2], SIMD_PLUS);                           \
+	SIMD_HREDUCE(myy, stats->moment[3], SIMD_PLUS);                           \
+	SIMD_HREDUCE(myz, stats->moment[4], SIMD_PLUS);                           \
+	SIMD_HREDUCE(mzz, stats->moment[5], SIMD_PLUS);                           \
+	                                                                          \
+	simd_reduce_range(array, n, array->numpts, stats);                        \
+}                                                                             \
+                                                                              \
+SIMD_TARGET(isa)                                                              \
+static real simd_maxdist_##suffix(struct pointarray *array,                   \
+                                  real px,                                    \
+                                  real py,                                    \
+                                  real pz)                                    \
+{                                                                             \
+	uint n = array->numpts - (array->numpts % SIMD_WIDTH);                    \
+	SIMD_VEC vx = SIMD_SET1(px);                                              \
+	SIMD_VEC vy = SIMD_SET1(py);                                              \
+	SIMD_VEC vz = SIMD_SET1(pz);                                              \
+	SIMD_VEC best = SIMD_SET1(0.0);                                           \
+	                                                                          \
+	for (uint i = 0; i < n; i += SIMD_WIDTH) {                                \
+		SIMD_VEC dx = SIMD_SUB(vx, SIMD_LOAD(array->x + i));                  \
+		SIMD_VEC dy = SIMD_SUB(vy, SIMD_LOAD(array->y + i));                  \
+		SIMD_VEC dz = SIMD_SUB(vz, SIMD_LOAD(array->z + i));                  \
+		SIMD_VEC d = SIMD_ADD(SIMD_ADD(SIMD_MUL(dx, dx), SIMD_MUL(dy, dy)),   \
+		                      SIMD_MUL(dz, dz));                              \
+		best = SIMD_MAX(best, d);                                             \
+	}                                                                         \
+	                                                                          \
+	real max = 0.0;                                                           \
+	SIMD_HREDUCE(best, max, fmax);                                            \
+	                                                                          \
+	return simd_maxdist_range(array, n, array->numpts, px, py, pz, max);      \
+}                                                                             \
+                                                                              \
+SIMD_TARGET(isa)                                                              \
+static real simd_sumdist_##suffix(struct pointarray *array,                   \
+                                  real px,                                    \
+                                  real py,                                    \
+                                  real pz)                                    \
+{                                                                             \
+	uint n = array->numpts - (array->numpts % SIMD_WIDTH);                    \
+	SIMD_VEC vx = SIMD_SET1(px);                                              \
+	SIMD_VEC vy = SIMD_SET1(py);                                              \
+	SIMD_VEC vz = SIMD_SET1(pz);                                              \
+	SIMD_VEC acc = SIMD_SET1(0.0);                                            \
+	                                                                          \
+	for (uint i = 0; i < n; i += SIMD_WIDTH) {                                \
+		SIMD_VEC dx = SIMD_SUB(vx, SIMD_LOAD(array->x + i));                  \
+		SIMD_VEC dy = SIMD_SUB(vy, SIMD_LOAD(array->y + i));                  \
+		SIMD_VEC dz = SIMD_SUB(vz, SIMD_LOAD(array->z + i));                  \
+		SIMD_VEC d = SIMD_ADD(SIMD_ADD(SIMD_MUL(dx, dx), SIMD_MUL(dy, dy)),   \
+		                      SIMD_MUL(dz, dz));                              \
+		acc = SIMD_ADD(acc, SIMD_SQRT(d));                                    \
+	}                                                                         \
+	                                                                          \
+	real sum = 0.0;                                                           \
+	SIMD_HREDUCE(acc, sum, SIMD_PLUS);                                        \
+	                                                                          \
+	return simd_sumdist_range(array, n, array->numpts, px, py, pz, sum);      \
+}                                                                             \
+                                                                              \
+SIMD_TARGET(isa)                                                              \
+static void simd_transform_##suffix(struct pointarray *array,                 \
+                                    const struct rigid3 *rt)                  \
+{                                                                             \
+	uint n = array->numpts - (array->numpts % SIMD_WIDTH);                    \
+	SIMD_VEC r[3][3];                                                         \
+	SIMD_VEC t[3];                                                            \
+	                                                                          \
+	for (int a = 0; a < 3; a++) {                                             \
+		for (int b = 0; b < 3; b++)                                           \
+			r[a][b] = SIMD_SET1(rt->rot.m[a][b]);                             \
+		                                                                      \
+		t[a] = SIMD_SET1(rt->t[a]);                                           \
+	}                                                                         \
+	                                                                          \
+	for (uint i = 0; i < n; i += SIMD_WIDTH) {                                \
+		SIMD_VEC x = SIMD_LOAD(array->x + i);                                 \
+		SIMD_VEC y = SIMD_LOAD(array->y + i);                                 \
+		SIMD_VEC z = SIMD_LOAD(array->z + i);                                 \
+		SIMD_VEC out[3];                                                      \
+		                                                                      \
+		for (int a = 0; a < 3; a++)                                           \
+			out[a] = SIMD_ADD(SIMD_ADD(SIMD_ADD(SIMD_MUL(r[a][0], x),         \
+			                                    SIMD_MUL(r[a][1], y)),        \
+			                           SIMD_MUL(r[a][2], z)),                 \
+			                  t[a]);                                          \
+		                                                                      \
+		SIMD_STORE(array->x + i, out[0]);                                     \
+		SIMD_STORE(array->y + i, out[1]);                                     \
+		SIMD_STORE(array->z + i, out[2]);                                     \
+	}                                                                         \
+	                                                                          \
+	simd_transform_range(array, n, array->numpts, rt);                        \
+}                                                                             \
+                                                                              \
+SIMD_TARGET(isa)                                                              \
+static uint simd_farthest_##suffix(struct pointarray *array,                  \
+                                   uint begin,                                \
+                                   uint end,                                  \
+                                   real px,                                   \
+                                   real py,                                   \
+                                   real pz,                                   \
+                                   real *mind)                                \
+{                                                                             \
+	uint n = end - ((end - begin) % SIMD_WIDTH);                              \
+	SIMD_VEC vx = SIMD_SET1(px);                                              \
+	SIMD_VEC vy = SIMD_SET1(py);                                              \
+	SIMD_VEC vz = SIMD_SET1(pz);                                              \
+	SIMD_VEC best = SIMD_SET1(-1.0);                                          \
+	                                                                          \
+	for (uint i = begin; i < n; i += SIMD_WIDTH) {                            \
+		SIMD_VEC dx = SIMD_SUB(vx, SIMD_LOAD(array->x + i));                  \
+		SIMD_VEC dy = SIMD_SUB(vy, SIMD_LOAD(array->y + i));                  \
+		SIMD_VEC dz = SIMD_SUB(vz, SIMD_LOAD(array->z + i));                  \
+		SIMD_VEC d = SIMD_ADD(SIMD_ADD(SIMD_MUL(dx, dx), SIMD_MUL(dy, dy)),   \
+		                      SIMD_MUL(dz, dz));                              \
+		SIMD_VEC m = SIMD_MIN(SIMD_LOAD(mind + i), d);                        \
+		SIMD_STORE(mind + i, m);                                              \
+		best = SIMD_MAX(best, m);                                             \
+	}                                                                         \
+	                                                                          \
+	real max = -1.0;                                                          \
+	SIMD_HREDUCE(best, max, fmax);                                            \
+	                                                                          \
+	return simd_farthest_range(array, begin, n, end, px, py, pz, mind, max);  \
+}                                                                             \
+                                                                              \
+SIMD_TARGET(isa)                                                              \
+static uint simd_plane_##suffix(struct pointarray *array,                     \
+                                uint begin,                                   \
+                                uint end,                                     \
+                                const real *coef,                             \
+                                real threshold)                               \
+{                                                                             \
+	uint n = end - ((end - begin) % SIMD_WIDTH);                              \
+	uint count = 0;                                                           \
+	SIMD_VEC va = SIMD_SET1(coef[0]);                                         \
+	SIMD_VEC vb = SIMD_SET1(coef[1]);                                         \
+	SIMD_VEC vc = SIMD_SET1(coef[2]);                                         \
+	SIMD_VEC vd = SIMD_SET1(coef[3]);                                         \
+	SIMD_VEC vt = SIMD_SET1(threshold * threshold);                           \
+	                                                                          \
+	for (uint i = begin; i < n; i += SIMD_WIDTH) {                            \
+		SIMD_VEC ax = SIMD_MUL(va, SIMD_LOAD(array->x + i));                  \
+		SIMD_VEC by = SIMD_MUL(vb, SIMD_LOAD(array->y + i));                  \
+		SIMD_VEC cz = SIMD_MUL(vc, SIMD_LOAD(array->z + i));                  \
+		SIMD_VEC d = SIMD_ADD(SIMD_ADD(SIMD_ADD(ax, by), cz), vd);            \
+		count += SIMD_COUNTLE(SIMD_MUL(d, d), vt);                            \
+	}                                                                         \
+	                                                                          \
+	return simd_plane_range(array, n, end, coef, threshold, count);           \
+}
+
+#define SIMD_VEC __m128d
+#define SIMD_WIDTH 2
+#define SIMD_LOAD _mm_load_pd
+#define SIMD_STORE _mm_store_pd
+#define SIMD_STOREU _mm_storeu_pd
+#define SIMD_SET1 _mm_set1_pd
+#define SIMD_ADD _mm_add_pd
+#define SIMD_SUB _mm_sub_pd
+#define SIMD_MUL _mm_mul_pd
+#define SIMD_MIN _mm_min_pd
+#define SIMD_MAX _mm_max_pd
+#define SIMD_SQRT _mm_sqrt_pd
+#define SIMD_COUNTLE(a, b) \
+	__builtin_popcount(_mm_movemask_pd(_mm_cmple_pd(a, b)))
+SIMD_KERNELS(sse2, "sse2")
+#undef SIMD_VEC
+#undef SIMD_WIDTH
+#undef SIMD_LOAD
+#undef SIMD_STORE
+#undef SIMD_STOREU
+#undef SIMD_SET1
+#undef SIMD_ADD
+#undef SIMD_SUB
+#undef SIMD_MUL
+#undef SIMD_MIN
+#undef SIMD_MAX
+#undef SIMD_SQRT
+#undef SIMD_COUNTLE
+
+#define SIMD_VEC __m256d
+#define SIMD_WIDTH 4
+#define SIMD_LOAD _mm256_load_pd
+#define SIMD_STORE _mm256_store_pd
+#define SIMD_STOREU _mm256_storeu_pd
+#define SIMD_SET1 _mm256_set1_pd
+#define SIMD_ADD _mm256_add_pd
+#define SIMD_SUB _mm256_sub_pd
+#define SIMD_MUL _mm256_mul_pd
+#define SIMD_MIN _mm256_min_pd
+#define SIMD_MAX _mm256_max_pd
+#define SIMD_SQRT _mm256_sqrt_pd
+#define SIMD_COUNTLE(a, b) \
+	__builtin_popcount(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_LE_OQ)))
+SIMD_KERNELS(avx2, "avx2")
+#undef SIMD_VEC
+#undef SIMD_WIDTH
+#undef SIMD_LOAD
+#undef SIMD_STORE
+#undef SIMD_STOREU
+#undef SIMD_SET1
+#undef SIMD_ADD
+#undef SIMD_SUB
+#undef SIMD_MUL
+#undef SIMD_MIN
+#undef SIMD_MAX
+#undef SIMD_SQRT
+#undef SIMD_COUNTLE
+
+#define SIMD_VEC __m512d
+#define SIMD_WIDTH 8
+#define SIMD_LOAD _mm512_load_pd
+#define SIMD_STORE _mm512_store_pd
+#define SIMD_STOREU _mm512_storeu_pd
+#define SIMD_SET1 _mm512_set1_pd
+#define SIMD_ADD _mm512_add_pd
+#define SIMD_SUB _mm512_sub_pd
+#define SIMD_MUL _mm512_mul_pd
+#define SIMD_MIN _mm512_min_pd
+#define SIMD_MAX _mm512_max_pd
+#define SIMD_SQRT _mm512_sqrt_pd
+#define SIMD_COUNTLE(a, b) \
+	__builtin_popcount(_mm512_cmp_pd_mask(a, b, _CMP_LE_OQ))
+SIMD_KERNELS(avx512, "avx512f")
+#undef SIMD_VEC
+#undef SIMD_WIDTH
+#undef SIMD_LOAD
+#undef SIMD_STORE
+#undef SIMD_STOREU
+#undef SIMD_SET1
+#undef SIMD_ADD
+#undef SIMD_SUB
+#undef SIMD_MUL
+#undef SIMD_MIN
+#undef SIMD_MAX
+#undef SIMD_SQRT
+#undef SIMD_COUNTLE
+
+#endif // SIMD_X86
+
+static int simd_detect()
+{
+#ifdef SIMD_X86
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx512f"))
+		return SIMD_AVX512;
+
+	if (__builtin_cpu_supports("avx2"))
+		return SIMD_AVX2;
+
+	if (__builtin_cpu_supports("sse2"))
+		return SIMD_SSE2;
+#endif
+
+	return SIMD_SCALAR;
+}
+
+static void simd_bind(int level)
+{
+	if (level > simd_table.supported)
+		level = simd_table.supported;
+
+	if (level < SIMD_SCALAR)
+		level = SIMD_SCALAR;
+
+	simd_table.level = level;
+	simd_table.reduce = simd_reduce_scalar;
+	simd_table.maxdist = simd_maxdist_scalar;
+	simd_table.sumdist = simd_sumdist_scalar;
+	simd_table.transform = simd_transform_scalar;
+	simd_table.farthest = simd_farthest_scalar;
+	simd_table.plane = simd_plane_scalar;
+
+#ifdef SIMD_X86
+	if (level == SIMD_SSE2) {
+		simd_table.reduce = simd_reduce_sse2;
+		simd_table.maxdist = simd_maxdist_sse2;
+		simd_table.sumdist = simd_sumdist_sse2;
+		simd_table.transform = simd_transform_sse2;
+		simd_table.farthest = simd_farthest_sse2;
+		simd_table.plane = simd_plane_sse2;
+	} else if (level == SIMD_AVX2) {
+		simd_table.reduce = simd_reduce_avx2;
+		simd_table.maxdist = simd_maxdist_avx2;
+		simd_table.sumdist = simd_sumdist_avx2;
+		simd_table.transform = simd_transform_avx2;
+		simd_table.farthest = simd_farthest_avx2;
+		simd_table.plane = simd_plane_avx2;
+	} else if (level == SIMD_AVX512) {
+		simd_table.reduce = simd_reduce_avx512;
+		simd_table.maxdist = simd_maxdist_avx512;
+		simd_table.sumdist = simd_sumdist_avx512;
+		simd_table.transform = simd_transform_avx512;
+		simd_table.farthest = simd_farthest_avx512;
+		simd_table.plane = simd_plane_avx512;
+	}
+#endif
+}
+
+static void simd_init()
+{
+	simd_table.supported = simd_detect();
+
+	int level = simd_table.supported;
+	const char *env = getenv(SIMD_ENV);
+
+	if (env != NULL)
+		for (int l = SIMD_SCALAR; l <= SIMD_AVX512; l++)
+			if (!strcmp(env, simd_name(l)))
+				level = l;
+
+	simd_bind(level);
+}
+
+int simd_level()
+{
+	call_once(&simd_once, simd_init);
+
+	return simd_table.level;
+}
+
+int simd_set_level(int level)
+{
+	call_once(&simd_once, simd_init);
+	simd_bind(level);
+
+	return simd_table.level;
+}
+
+const char *simd_name(int level)
+{
+	switch (level) {
+	case SIMD_SSE2:
+		return "sse2";
+	case SIMD_AVX2:
+		return "avx2";
+	case SIMD_AVX512:
+		return "avx512";
+	default:
+		return "scalar";
+	}
+}
+
+void simd_reduce(struct pointarray *array, struct simd_stats *stats)
+{
+	call_once(&simd_once, simd_init);
+	simd_table.reduce(array, stats);
+}
+
+real simd_max_squared_distance(struct pointarray *array, struct vector3 *p)
+{
+	call_once(&simd_once, simd_init);
+
+	return simd_table.maxdist(array, p->x, p->y, p->z);
+}
+
+real simd_sum_distance(struct pointarray *array, struct vector3 *p)
+{
+	call_once(&simd_once, simd_init);
+
+	return simd_table.sumdist(array, p->x, p->y, p->z);
+}
+
+void simd_transform(struct pointarray *array, const struct rigid3 *rt)
+{
+	call_once(&simd_once, simd_init);
+	simd_table.transform(array, rt);
+}
+
+uint simd_update_farthest(struct pointarray *array,
+                          uint begin,
+                          uint end,
+                          struct vector3 *p,
+                          real *mind)
+{
+	call_once(&simd_once, simd_init);
+
+	if (begin >= end)
+		return begin;
+
+	return simd_table.farthest(array, begin, end, p->x, p->y, p->z, mind);
+}
+
+uint simd_count_plane(struct pointarray *array,
+                      uint begin,
+                      uint end,
+                      const real *coef,
+                      real threshold)
+{
+	call_once(&simd_once, simd_init);
+
+	if (begin >= end)
+		return 0;
+
+	return simd_table.plane(array, begin, end, coef, threshold);
+}
+
+struct vector3 *simd_stats_centroid(struct simd_stats *stats)
+{
+	return vector3_new(stats->sum[0] / stats->numpts,
+	                   stats->sum[1] / stats->numpts,
+	                   stats->sum[2] / stats->numpts);
+}
+
+void simd_stats_covariance(struct simd_stats *stats, real *cov)
+{
+	real n = stats->numpts;
+	real d[3];
+
+	for (int k = 0; k < 3; k++)
+		d[k] = stats->sum[k] - (n * stats->origin[k]);
+
+	cov[0] = (stats->moment[0] - ((d[0] * d[0]) / n)) / n;
+	cov[1] = (stats->moment[1] - ((d[0] * d[1]) / n)) / n;
+	cov[2] = (stats->moment[2] - ((d[0] * d[2]) / n)) / n;
+	cov[3] = (stats->moment[3] - ((d[1] * d[1]) / n)) / n;
+	cov[4] = (stats->moment[4] - ((d[1] * d[2]) / n)) / n;
+	cov[5] = (stats->moment[5] - ((d[2] * d[2]) / n)) / n;
+}
+
+void simd_stats_debug(struct simd_stats *stats, FILE *output)
+{
+	fprintf(output,
+	        "simd: %s | points: %u\n"
+	        "min: %le %le %le\n"
+	        "max: %le %le %le\n"
+	        "sum: %le %le %le\n",
+	        simd_name(simd_level()),
+	        stats->numpts,
+	        stats->min[0],
+	        stats->min[1],
+	        stats->min[2],
+	        stats->max[0],
+	        stats->max[1],
+	        stats->max[2],
+	        stats->sum[0],
+	        stats->sum[1],
+	        stats->sum[2]);
+}
+
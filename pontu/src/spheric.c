@@ -5,6 +5,12 @@ real spheric_quad(real x, real y, real z, int p, int q, int r)
 	return sqrt(pow(x, 2 * p) + pow(y, 2 * q) + pow(z, 2 * r));
 }
 
+void spheric_pow_table(int n, real x, real *table)
+{
+	for (int i = 0; i <= n; i++)
+		table[i] = pow(x, i);
+}
+
 real spheric_moment(int p, int q, int r, struct cloud *cloud)
 {
 	struct vector3 *centroid = cloud_get_centroid(cloud);
@@ -37,27 +43,94 @@ real spheric_normalized_moment(int p, int q, int r, struct cloud *cloud)
 	return central / pow(zero, ((p + q + r) / 3.0) + 1.0);
 }
 
+#define SPHERIC_KERNEL(name, NX, NY, NZ)                                      \
+static void name(struct cloud *cloud,                                        \
+                 struct vector3 *centroid,                                   \
+                 int *order,                                                 \
+                 real *moments)                                              \
+{                                                                             \
+	real px[2 * MOMENTCFG_MAXORD + 1];                                        \
+	real py[2 * MOMENTCFG_MAXORD + 1];                                        \
+	real pz[2 * MOMENTCFG_MAXORD + 1];                                        \
+	                                                                          \
+	for (struct pointset *set = cloud->points; set != NULL; set = set->next) { \
+		uint col = 0;                                                         \
+		                                                                      \
+		spheric_pow_table(2 * NX, set->point->x - centroid->x, px);           \
+		spheric_pow_table(2 * NY, set->point->y - centroid->y, py);           \
+		spheric_pow_table(2 * NZ, set->point->z - centroid->z, pz);           \
+		                                                                      \
+		MOMENTCFG_UNROLL                                                      \
+		for (int p = 0; p <= NX; p++)                                         \
+			MOMENTCFG_UNROLL                                                  \
+			for (int q = 0; q <= NY; q++)                                     \
+				MOMENTCFG_UNROLL                                              \
+				for (int r = 0; r <= NZ; r++)                                 \
+					moments[col++] += px[p] * py[q] * pz[r] *                 \
+					                  sqrt(px[2 * p] + py[2 * q] + pz[2 * r]); \
+	}                                                                         \
+	                                                                          \
+	(void)order;                                                              \
+}
+
+SPHERIC_KERNEL(spheric_kernel_1, 1, 1, 1)
+SPHERIC_KERNEL(spheric_kernel_2, 2, 2, 2)
+SPHERIC_KERNEL(spheric_kernel_3, 3, 3, 3)
+SPHERIC_KERNEL(spheric_kernel_4, 4, 4, 4)
+SPHERIC_KERNEL(spheric_kernel_5, 5, 5, 5)
+SPHERIC_KERNEL(spheric_kernel_n, order[0], order[1], order[2])
+
 struct dataframe *spheric_cloud_moments(struct cloud *cloud)
 {
-	int m = (SPHERIC_ORDER_X + 1) *
-	        (SPHERIC_ORDER_Y + 1) *
-	        (SPHERIC_ORDER_Z + 1);
+	return spheric_cloud_moments_cfg(cloud, momentcfg_current());
+}
+
+struct dataframe *spheric_cloud_moments_cfg(struct cloud *cloud,
+                                            struct momentcfg *cfg)
+{
+	PROFILE_SCOPE(PROFILE_MOMENT);
+	PROFILE_POINTS(cloud->numpts);
+
+	int *order = cfg->spheric;
+	for (int i = 0; i < 3; i++)
+		if (order[i] < 0 || order[i] > MOMENTCFG_MAXORD)
+			return NULL;
+
+	int m = (order[0] + 1) * (order[1] + 1) * (order[2] + 1);
 	struct dataframe *results = dataframe_new(1, m);
+	if (results == NULL)
+		return NULL;
+
+	struct vector3 *centroid = cloud_get_centroid(cloud);
+	int equal = order[0] == order[1] && order[1] == order[2];
 
-	int p = 0;
-	int q = 0;
-	int r = 0;
-	int col = 0;
-
-	for (p = 0; p <= SPHERIC_ORDER_X; p++) {
-		for (q = 0; q <= SPHERIC_ORDER_Y; q++) {
-			for (r = 0; r <= SPHERIC_ORDER_Z; r++) {
-				dataframe_set(results, 0, col, spheric_moment(p, q, r, cloud));
-				col++;
-			}
-		}
+	switch (equal ? order[0] : -1) {
+	case 1:
+		spheric_kernel_1(cloud, centroid, order, results->data);
+		break;
+	case 2:
+		spheric_kernel_2(cloud, centroid, order, results->data);
+		break;
+	case 3:
+		spheric_kernel_3(cloud, centroid, order, results->data);
+		break;
+	case 4:
+		spheric_kernel_4(cloud, centroid, order, results->data);
+		break;
+	case 5:
+		spheric_kernel_5(cloud, centroid, order, results->data);
+		break;
+	default:
+		spheric_kernel_n(cloud, centroid, order, results->data);
+		break;
 	}
 
+	real volume = cloud_boundingbox_volume(cloud);
+	for (int i = 0; i < m; i++)
+		results->data[i] /= volume;
+
+	vector3_free(&centroid);
+
 	return results;
 }
 
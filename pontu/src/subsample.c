@@ -0,0 +1,207 @@
+#include "../include/subsample.h"
+
+static int subsample_compare(const void *a, const void *b)
+{
+	uint i = *(const uint *)a;
+	uint j = *(const uint *)b;
+
+	return (i > j) - (i < j);
+}
+
+struct cloudview *subsample_random(struct cloud *cloud, uint k, uint64_t seed)
+{
+	uint n = cloud->numpts;
+	k = k > n ? n : k;
+
+	struct cloudview *view = cloudview_new(cloud, k);
+	if (view == NULL)
+		return NULL;
+
+	uint64_t state = seed;
+	uint chosen = 0;
+
+	for (uint i = 0; i < n && chosen < k; i++)
+		if ((n - i) * calc_randu(&state) < k - chosen)
+			view->ids[chosen++] = i;
+
+	return view;
+}
+
+struct cloudview *subsample_reservoir(struct cloud *cloud,
+                                      uint k,
+                                      uint64_t seed)
+{
+	k = k > cloud->numpts ? cloud->numpts : k;
+
+	struct cloudview *view = cloudview_new(cloud, k);
+	if (view == NULL)
+		return NULL;
+
+	uint64_t state = seed;
+	uint i = 0;
+
+	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
+		if (i < k) {
+			view->ids[i] = i;
+		} else {
+			uint64_t j = calc_rand64(&state) % ((uint64_t)i + 1);
+
+			if (j < k)
+				view->ids[j] = i;
+		}
+
+		i++;
+	}
+
+	view->numids = i < k ? i : k;
+	qsort(view->ids, view->numids, sizeof(uint), &subsample_compare);
+
+	return view;
+}
+
+struct cloudview *subsample_stride(struct cloud *cloud, uint stride)
+{
+	if (stride == 0)
+		return NULL;
+
+	uint n = cloud->numpts;
+	struct cloudview *view = cloudview_new(cloud, (n + stride - 1) / stride);
+	if (view == NULL)
+		return NULL;
+
+	for (uint j = 0; j < view->numids; j++)
+		view->ids[j] = j * stride;
+
+	return view;
+}
+
+static int subsample_isolated(struct pointarray *array,
+                              const uint64_t *keys,
+                              const uint *heads,
+                              const uint *next,
+                              uint bits,
+                              const uint64_t *cell,
+                              uint i,
+                              real sqradius)
+{
+	for (int dx = -1; dx <= 1; dx++) {
+		for (int dy = -1; dy <= 1; dy++) {
+			for (int dz = -1; dz <= 1; dz++) {
+				int64_t c[3] = {(int64_t)cell[0] + dx,
+				                (int64_t)cell[1] + dy,
+				                (int64_t)cell[2] + dz};
+
+				if (c[0] < 0 || c[1] < 0 || c[2] < 0 ||
+				    c[0] > (int64_t)GRIDHASH_MAXCELL ||
+				    c[1] > (int64_t)GRIDHASH_MAXCELL ||
+				    c[2] > (int64_t)GRIDHASH_MAXCELL)
+					continue;
+
+				uint64_t key = gridhash_key(c[0], c[1], c[2]);
+				uint64_t h = gridhash_slot(keys, bits, key);
+
+				if (keys[h] == GRIDHASH_EMPTY)
+					continue;
+
+				for (uint j = heads[h]; j != UINT_MAX; j = next[j]) {
+					real d = calc_squared_length3(array->x[i] - array->x[j],
+					                              array->y[i] - array->y[j],
+					                              array->z[i] - array->z[j]);
+					if (d < sqradius)
+						return 0;
+				}
+			}
+		}
+	}
+
+	return 1;
+}
+
+struct cloudview *subsample_poisson(struct cloud *cloud,
+                                    real radius,
+                                    uint64_t seed)
+{
+	struct pointarray *array = cloud_pack(cloud);
+	if (!(radius > 0.0) || array == NULL)
+		return NULL;
+
+	uint n = array->numpts;
+	uint bits = 1;
+	while ((1ULL << bits) < 2ULL * n)
+		bits++;
+
+	uint *order = malloc((n + 1) * sizeof(uint));
+	uint *next = malloc((n + 1) * sizeof(uint));
+	uint *heads = malloc((1ULL << bits) * sizeof(uint));
+	uint64_t *keys = malloc((1ULL << bits) * sizeof(uint64_t));
+	struct cloudview *view = cloudview_new(cloud, n);
+
+	if (order == NULL || next == NULL || heads == NULL || keys == NULL ||
+	    view == NULL) {
+		free(order);
+		free(next);
+		free(heads);
+		free(keys);
+		cloudview_free(&view);
+		return NULL;
+	}
+
+	struct simd_stats stats;
+	simd_reduce(array, &stats);
+
+	uint64_t state = seed;
+
+	for (uint i = 0; i < n; i++)
+		order[i] = i;
+
+	for (uint i = n; i > 1; i--) {
+		uint j = calc_rand64(&state) % i;
+		uint tmp = order[i - 1];
+
+		order[i - 1] = order[j];
+		order[j] = tmp;
+	}
+
+	gridhash_clear(keys, bits);
+
+	view->numids = 0;
+
+	for (uint t = 0; t < n; t++) {
+		uint i = order[t];
+		uint64_t cell[3] = {gridhash_cell(array->x[i], stats.min[0], radius),
+		                    gridhash_cell(array->y[i], stats.min[1], radius),
+		                    gridhash_cell(array->z[i], stats.min[2], radius)};
+
+		if (!subsample_isolated(array,
+		                        keys,
+		                        heads,
+		                        next,
+		                        bits,
+		                        cell,
+		                        i,
+		                        radius * radius))
+			continue;
+
+		uint64_t key = gridhash_key(cell[0], cell[1], cell[2]);
+		uint64_t h = gridhash_slot(keys, bits, key);
+
+		if (keys[h] == GRIDHASH_EMPTY) {
+			keys[h] = key;
+			heads[h] = UINT_MAX;
+		}
+
+		next[i] = heads[h];
+		heads[h] = i;
+		view->ids[view->numids++] = i;
+	}
+
+	qsort(view->ids, view->numids, sizeof(uint), &subsample_compare);
+
+	free(order);
+	free(next);
+	free(heads);
+	free(keys);
+
+	return view;
+}
+
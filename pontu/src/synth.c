@@ -0,0 +1,254 @@
+#include "../include/synth.h"
+
+static const char *synth_names[SYNTH_NUMSHAPES] = {"cube",
+                                                   "sphere",
+                                                   "clusters",
+                                                   "plane",
+                                                   "face",
+                                                   "duplicates"};
+
+static int synth_insert(struct cloud *cloud, real x, real y, real z)
+{
+	return cloud_insert_real(cloud, x, y, z) != NULL;
+}
+
+struct cloud *synth_cube(uint numpts, real side, uint64_t seed)
+{
+	struct cloud *cloud = cloud_new();
+	if (cloud == NULL)
+		return NULL;
+
+	uint64_t state = seed;
+
+	for (uint i = 0; i < numpts; i++) {
+		real x = side * (calc_randu(&state) - 0.5);
+		real y = side * (calc_randu(&state) - 0.5);
+		real z = side * (calc_randu(&state) - 0.5);
+
+		if (!synth_insert(cloud, x, y, z)) {
+			cloud_free(&cloud);
+			return NULL;
+		}
+	}
+
+	return cloud;
+}
+
+struct cloud *synth_sphere(uint numpts, real radius, real noise, uint64_t seed)
+{
+	struct cloud *cloud = cloud_new();
+	if (cloud == NULL)
+		return NULL;
+
+	uint64_t state = seed;
+
+	for (uint i = 0; i < numpts; i++) {
+		real theta = 2.0 * CALC_PI * calc_randu(&state);
+		real phi = acos(2.0 * calc_randu(&state) - 1.0);
+		real r = radius + noise * calc_randn(&state);
+
+		if (!synth_insert(cloud,
+		                  r * sin(phi) * cos(theta),
+		                  r * sin(phi) * sin(theta),
+		                  r * cos(phi))) {
+			cloud_free(&cloud);
+			return NULL;
+		}
+	}
+
+	return cloud;
+}
+
+struct cloud *synth_clusters(uint numpts,
+                             uint numclusters,
+                             real sigma,
+                             uint64_t seed)
+{
+	if (numclusters == 0)
+		return NULL;
+
+	real *centers = malloc(3 * numclusters * sizeof(real));
+	if (centers == NULL)
+		return NULL;
+
+	struct cloud *cloud = cloud_new();
+	if (cloud == NULL) {
+		free(centers);
+		return NULL;
+	}
+
+	uint64_t state = seed;
+
+	for (uint i = 0; i < 3 * numclusters; i++)
+		centers[i] = calc_randu(&state) - 0.5;
+
+	for (uint i = 0; i < numpts; i++) {
+		real *c = &centers[3 * (calc_rand64(&state) % numclusters)];
+		real x = c[0] + sigma * calc_randn(&state);
+		real y = c[1] + sigma * calc_randn(&state);
+		real z = c[2] + sigma * calc_randn(&state);
+
+		if (!synth_insert(cloud, x, y, z)) {
+			cloud_free(&cloud);
+			break;
+		}
+	}
+
+	free(centers);
+
+	return cloud;
+}
+
+struct cloud *synth_plane(uint numpts, real noise, uint64_t seed)
+{
+	struct cloud *cloud = cloud_new();
+	if (cloud == NULL)
+		return NULL;
+
+	uint64_t state = seed;
+	uint rows = (uint)ceil(sqrt(numpts));
+	uint cols = rows > 0 ? (numpts + rows - 1) / rows : 0;
+
+	for (uint i = 0; i < numpts; i++) {
+		uint r = i / cols;
+		uint c = i % cols;
+		real x = -1.0 + 2.0 * (c + calc_randu(&state)) / cols;
+		real y = -1.0 + 2.0 * (r + 0.5) / rows;
+		real z = noise * calc_randn(&state);
+
+		if (!synth_insert(cloud, x, y, z)) {
+			cloud_free(&cloud);
+			return NULL;
+		}
+	}
+
+	return cloud;
+}
+
+static real synth_bump(real x, real y, real cx, real cy, real sx, real sy)
+{
+	real dx = (x - cx) / sx;
+	real dy = (y - cy) / sy;
+
+	return exp(-0.5 * (dx * dx + dy * dy));
+}
+
+static real synth_face_height(real x, real y)
+{
+	real dome = 1.0 - (x / 0.8) * (x / 0.8) - y * y;
+	real z = 0.5 * sqrt(dome > 0.0 ? dome : 0.0);
+
+	z += 0.22 * synth_bump(x, y, 0.0, -0.05, 0.06, 0.15);
+	z -= 0.08 * synth_bump(x, y, -0.3, 0.3, 0.09, 0.09);
+	z -= 0.08 * synth_bump(x, y, 0.3, 0.3, 0.09, 0.09);
+	z -= 0.04 * synth_bump(x, y, 0.0, -0.45, 0.18, 0.04);
+	z += 0.05 * synth_bump(x, y, 0.0, -0.75, 0.15, 0.08);
+
+	return z;
+}
+
+struct cloud *synth_face(uint numpts, real noise, uint64_t seed)
+{
+	struct cloud *cloud = cloud_new();
+	if (cloud == NULL)
+		return NULL;
+
+	uint64_t state = seed;
+	uint i = 0;
+
+	while (i < numpts) {
+		real x = 0.8 * (2.0 * calc_randu(&state) - 1.0);
+		real y = 2.0 * calc_randu(&state) - 1.0;
+
+		if ((x / 0.8) * (x / 0.8) + y * y > 1.0)
+			continue;
+
+		real z = synth_face_height(x, y) + noise * calc_randn(&state);
+
+		if (!synth_insert(cloud, x, y, z)) {
+			cloud_free(&cloud);
+			return NULL;
+		}
+
+		i++;
+	}
+
+	return cloud;
+}
+
+struct cloud *synth_duplicates(uint numpts, uint numunique, uint64_t seed)
+{
+	if (numunique == 0)
+		return NULL;
+
+	real *unique = malloc(3 * numunique * sizeof(real));
+	if (unique == NULL)
+		return NULL;
+
+	struct cloud *cloud = cloud_new();
+	if (cloud == NULL) {
+		free(unique);
+		return NULL;
+	}
+
+	uint64_t state = seed;
+
+	for (uint i = 0; i < 3 * numunique; i++)
+		unique[i] = calc_randu(&state) - 0.5;
+
+	for (uint i = 0; i < numpts; i++) {
+		real *p = &unique[3 * (calc_rand64(&state) % numunique)];
+
+		if (!synth_insert(cloud, p[0], p[1], p[2])) {
+			cloud_free(&cloud);
+			break;
+		}
+	}
+
+	free(unique);
+
+	return cloud;
+}
+
+struct cloud *synth_generate(int shape, uint numpts, uint64_t seed)
+{
+	uint numunique = (uint)(SYNTH_UNIQUE * numpts);
+
+	switch (shape) {
+	case SYNTH_CUBE:
+		return synth_cube(numpts, 1.0, seed);
+	case SYNTH_SPHERE:
+		return synth_sphere(numpts, 1.0, SYNTH_NOISE, seed);
+	case SYNTH_CLUSTERS:
+		return synth_clusters(numpts,
+		                      SYNTH_CLUSTERS_K,
+		                      SYNTH_CLUSTERS_SIGMA,
+		                      seed);
+	case SYNTH_PLANE:
+		return synth_plane(numpts, SYNTH_NOISE, seed);
+	case SYNTH_FACE:
+		return synth_face(numpts, SYNTH_NOISE, seed);
+	case SYNTH_DUPLICATES:
+		return synth_duplicates(numpts, numunique > 0 ? numunique : 1, seed);
+	default:
+		return NULL;
+	}
+}
+
+int synth_shape(const char *name)
+{
+	for (int s = 0; s < SYNTH_NUMSHAPES; s++)
+		if (!strcmp(name, synth_names[s]))
+			return s;
+
+	return -1;
+}
+
+const char *synth_name(int shape)
+{
+	if (shape < 0 || shape >= SYNTH_NUMSHAPES)
+		return NULL;
+
+	return synth_names[shape];
+}
+
@@ -2,7 +2,7 @@
 
 struct vector3 *vector3_new(real x, real y, real z)
 {
-	struct vector3 *v = malloc(sizeof(struct vector3));
+	struct vector3 *v = mem_alloc(MEM_VECTOR3, sizeof(struct vector3));
 	if (v == NULL)
 		return NULL;
 
@@ -35,7 +35,7 @@ void vector3_free(struct vector3 **v)
 	if (v == NULL)
 		return;
 	
-	free(*v);
+	mem_free(MEM_VECTOR3, *v, sizeof(struct vector3));
 	*v = NULL;
 }
 
@@ -11,18 +11,22 @@ struct cloud *voxelgrid_sampling(struct cloud *src, real leafsize) {
 
     real apothem = leafsize / 2;
 
+    struct simd_stats stats;
+    if (!cloud_reduce(src, &stats) || stats.numpts == 0) {
+        return NULL;
+    }
+
     struct vector3 *centroid = cloud_get_centroid(src);
-    struct vector3 *axis_size = cloud_axis_size(src);
     
-    uint num_voxels_x = (uint)ceil(axis_size->x/leafsize) + 1;
-    uint num_voxels_y = (uint)ceil(axis_size->y/leafsize) + 1;
-    uint num_voxels_z = (uint)ceil(axis_size->z/leafsize) + 1;
+    uint num_voxels_x = (uint)ceil((stats.max[0] - stats.min[0])/leafsize) + 1;
+    uint num_voxels_y = (uint)ceil((stats.max[1] - stats.min[1])/leafsize) + 1;
+    uint num_voxels_z = (uint)ceil((stats.max[2] - stats.min[2])/leafsize) + 1;
 
     struct vector3 *voxel_o = vector3_zero();
     
-    voxel_o->x = (cloud_min_x(src)->x + cloud_max_x(src)->x) / 2;
-    voxel_o->y = (cloud_min_y(src)->y + cloud_max_y(src)->y) / 2;
-    voxel_o->z = (cloud_min_z(src)->z + cloud_max_z(src)->z) / 2;
+    voxel_o->x = (stats.min[0] + stats.max[0]) / 2;
+    voxel_o->y = (stats.min[1] + stats.max[1]) / 2;
+    voxel_o->z = (stats.min[2] + stats.max[2]) / 2;
 
     voxel_o->x -= (real) floor(apothem * num_voxels_x);
     voxel_o->y -= (real) floor(apothem * num_voxels_y);
@@ -32,16 +36,22 @@ struct cloud *voxelgrid_sampling(struct cloud *src, real leafsize) {
     real d_x, min_x, max_x, d_y, min_y, max_y, d_z, min_z, max_z;
     uint idx_aux;
 
-    struct cloud *output = cloud_new();
-    
-    uint total_dim = num_voxels_x * num_voxels_y * num_voxels_z;
+    uint64_t total_dim = (uint64_t)num_voxels_x * num_voxels_y * num_voxels_z;
+
+    struct cloud** clouds = NULL;
+    if (total_dim <= UINT_MAX) {
+        clouds = mem_calloc(MEM_VOXELGRID, total_dim, sizeof(struct cloud*));
+    }
 
-    struct cloud** clouds = calloc (sizeof (struct cloud*), total_dim);
     if (clouds == NULL) {
         printf("%s: erro alocando memoria cloud", __FUNCTION__);
+        vector3_free(&centroid);
+        vector3_free(&voxel_o);
         return NULL;
     }
 
+    struct cloud *output = cloud_new();
+
     for (struct pointset *set = src->points; set != NULL; set = set->next) {
         d_x = set->point->x - voxel_o->x;
         if (d_x < 0.0) {
@@ -142,7 +152,9 @@ struct cloud *voxelgrid_sampling(struct cloud *src, real leafsize) {
         }
     }
     
-    free(clouds);
+    mem_free(MEM_VOXELGRID, clouds, total_dim * sizeof(struct cloud*));
+    vector3_free(&centroid);
+    vector3_free(&voxel_o);
 
     return output;
 }
@@ -34,6 +34,92 @@ real zernike_radpoly(int n, int m, real distance)
 	return radpoly;
 }
 
+struct zernike_radial *zernike_radial_new(int ord, int rep)
+{
+	struct zernike_radial *radial = malloc(sizeof(struct zernike_radial));
+	if (radial == NULL)
+		return NULL;
+
+	radial->ord = ord;
+	radial->rep = rep;
+	radial->numpairs = zernike_nummoments(ord, rep);
+	radial->numterms = 0;
+
+	for (int n = 0; n <= ord; n++)
+		for (int m = 0; m <= rep; m++)
+			if (zernike_conditions(n, m))
+				radial->numterms += ((n - m) / 2) + 1;
+
+	radial->pairs = malloc(radial->numpairs * sizeof(struct zernike_pair));
+	radial->terms = malloc(radial->numterms * sizeof(struct zernike_term));
+	if (radial->pairs == NULL || radial->terms == NULL) {
+		zernike_radial_free(&radial);
+		return NULL;
+	}
+
+	int pair = 0;
+	int term = 0;
+
+	for (int n = 0; n <= ord; n++) {
+		for (int m = 0; m <= rep; m++) {
+			if (!zernike_conditions(n, m))
+				continue;
+
+			radial->pairs[pair].n = n;
+			radial->pairs[pair].m = m;
+			radial->pairs[pair].first = term;
+
+			for (int s = 0; s <= (n - m) / 2; s++) {
+				radial->terms[term].power = n - (2 * s);
+				radial->terms[term].num = pow(-1, s) *
+				                          (calc_factorial(n - s));
+				radial->terms[term].den = calc_factorial(s) *
+				                          calc_factorial(((n + m) / 2) - s) *
+				                          calc_factorial(((n - m) / 2) - s);
+				term++;
+			}
+
+			radial->pairs[pair].last = term;
+			pair++;
+		}
+	}
+
+	return radial;
+}
+
+void zernike_radial_free(struct zernike_radial **radial)
+{
+	if (*radial == NULL)
+		return;
+
+	free((*radial)->pairs);
+	free((*radial)->terms);
+	free(*radial);
+	*radial = NULL;
+}
+
+void zernike_radial_eval(struct zernike_radial *radial,
+                         real distance,
+                         real *radpoly)
+{
+	real powers[MOMENTCFG_MAXORD + 1];
+
+	for (int k = 0; k <= radial->ord; k++)
+		powers[k] = pow(distance, k);
+
+	for (int i = 0; i < radial->numpairs; i++) {
+		struct zernike_pair *pair = &radial->pairs[i];
+		real sum = 0.0;
+
+		for (int t = pair->first; t < pair->last; t++) {
+			struct zernike_term *term = &radial->terms[t];
+			sum += (term->num * powers[term->power]) / term->den;
+		}
+
+		radpoly[i] = sum;
+	}
+}
+
 real zernike_azimuth(real y, real x)
 {
 	return atan2(y, x);
@@ -155,89 +241,96 @@ real zernike_moment_full(int n, int m, real r, struct cloud *cloud)
 
 struct dataframe *zernike_cloud_moments_odd(struct cloud *cloud)
 {
-	int s = zernike_nummoments(ZERNIKE_ORD, ZERNIKE_REP);
-	struct dataframe *results = dataframe_new(1, s);
-	real r = cloud_max_distance_from_centroid(cloud);
-	
-	int col = 0;
-	real moment = 0.0;
-
-	for (int n = 0; n <= ZERNIKE_ORD; n++) {
-		for (int m = 0; m <= ZERNIKE_REP; m++) {
-			if (zernike_conditions(n, m)) {
-				moment = zernike_moment_odd(n, m, r, cloud);
-				dataframe_set(results, 0, col, moment);
-				col++;
-			}
-		}
-	}
-
-	return results;
+	return zernike_cloud_moments_cfg(cloud,
+	                                 momentcfg_current(),
+	                                 ZERNIKE_KIND_ODD);
 }
 
 struct dataframe *zernike_cloud_moments_even(struct cloud *cloud)
 {
-	int s = zernike_nummoments(ZERNIKE_ORD, ZERNIKE_REP);
-	struct dataframe *results = dataframe_new(1, s);
-	real r = cloud_max_distance_from_centroid(cloud);
-	
-	int col = 0;
-	real moment = 0.0;
-
-	for (int n = 0; n <= ZERNIKE_ORD; n++) {
-		for (int m = 0; m <= ZERNIKE_REP; m++) {
-			if (zernike_conditions(n, m)) {
-				moment = zernike_moment_even(n, m, r, cloud);
-				dataframe_set(results, 0, col, moment);
-				col++;
-			}
-		}
-	}
-
-	return results;
+	return zernike_cloud_moments_cfg(cloud,
+	                                 momentcfg_current(),
+	                                 ZERNIKE_KIND_EVEN);
 }
 
 struct dataframe *zernike_cloud_moments_mag(struct cloud *cloud)
 {
-	int s = zernike_nummoments(ZERNIKE_ORD, ZERNIKE_REP);
-	struct dataframe *results = dataframe_new(1, s);
-	real r = cloud_max_distance_from_centroid(cloud);
-	
-	int col = 0;
-	real moment = 0.0;
-
-	for (int n = 0; n <= ZERNIKE_ORD; n++) {
-		for (int m = 0; m <= ZERNIKE_REP; m++) {
-			if (zernike_conditions(n, m)) {
-				moment = zernike_moment_mag(n, m, r, cloud);
-				dataframe_set(results, 0, col, moment);
-				col++;
-			}
-		}
-	}
-
-	return results;
+	return zernike_cloud_moments_cfg(cloud,
+	                                 momentcfg_current(),
+	                                 ZERNIKE_KIND_MAG);
 }
 
 struct dataframe *zernike_cloud_moments_full(struct cloud *cloud)
 {
-	int s = zernike_nummoments(ZERNIKE_ORD, ZERNIKE_REP);
-	struct dataframe *results = dataframe_new(1, s);
+	return zernike_cloud_moments_cfg(cloud,
+	                                 momentcfg_current(),
+	                                 ZERNIKE_KIND_FULL);
+}
+
+struct dataframe *zernike_cloud_moments_cfg(struct cloud *cloud,
+                                            struct momentcfg *cfg,
+                                            int kind)
+{
+	PROFILE_SCOPE(PROFILE_MOMENT);
+	PROFILE_POINTS(cloud->numpts);
+
+	int ord = cfg->zernike_ord;
+	int rep = cfg->zernike_rep;
+	if (ord < 0 || ord > MOMENTCFG_MAXORD || rep < 0 || rep > MOMENTCFG_MAXORD)
+		return NULL;
+
+	struct zernike_radial *radial = zernike_radial_new(ord, rep);
+	if (radial == NULL)
+		return NULL;
+
+	struct dataframe *results = dataframe_new(1, radial->numpairs);
+	real *radpoly = malloc(radial->numpairs * sizeof(real));
+	if (results == NULL || radpoly == NULL) {
+		dataframe_free(&results);
+		free(radpoly);
+		zernike_radial_free(&radial);
+		return NULL;
+	}
+
+	struct vector3 *centroid = cloud_get_centroid(cloud);
 	real r = cloud_max_distance_from_centroid(cloud);
-	
-	int col = 0;
-	real moment = 0.0;
+	real angular[MOMENTCFG_MAXORD + 1];
 
-	for (int n = 0; n <= ZERNIKE_ORD; n++) {
-		for (int m = 0; m <= ZERNIKE_REP; m++) {
-			if (zernike_conditions(n, m)) {
-				moment = zernike_moment_full(n, m, r, cloud);
-				dataframe_set(results, 0, col, moment);
-				col++;
-			}
+	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
+		real cx = set->point->x - centroid->x;
+		real cy = set->point->y - centroid->y;
+		real cz = set->point->z - centroid->z;
+		real d = vector3_distance(centroid, set->point);
+		real azimuth = zernike_azimuth(cy, cx);
+		real zenith = 0.0;
+
+		if (kind == ZERNIKE_KIND_FULL)
+			zenith = zernike_zenith(cz, d);
+
+		for (int m = 0; m <= rep; m++) {
+			if (kind == ZERNIKE_KIND_ODD)
+				angular[m] = sin(m * azimuth);
+			else if (kind == ZERNIKE_KIND_EVEN)
+				angular[m] = cos(m * azimuth);
+			else if (kind == ZERNIKE_KIND_FULL)
+				angular[m] = cos(m * azimuth) + sin(m * zenith);
+			else
+				angular[m] = 1.0;
 		}
+
+		zernike_radial_eval(radial, d / r, radpoly);
+
+		for (int i = 0; i < radial->numpairs; i++)
+			results->data[i] += radpoly[i] * angular[radial->pairs[i].m];
 	}
 
+	for (int i = 0; i < radial->numpairs; i++)
+		results->data[i] *= (radial->pairs[i].n + 1.0) / CALC_PI;
+
+	vector3_free(&centroid);
+	free(radpoly);
+	zernike_radial_free(&radial);
+
 	return results;
 }
 
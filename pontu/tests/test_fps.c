@@ -0,0 +1,138 @@
+/**
+ * \file test_fps.c
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Confere o FPS exato contra uma referência ingênua O(nk) em todos os
+ * níveis SIMD e com vários números de threads
+ */
+
+#include <stdint.h>
+#include "../pontu_core.h"
+#include "../pontu_sampling.h"
+
+#define TEST_NUMPTS		(FPS_PARALLEL_MIN + 4099)
+#define TEST_K			96
+#define TEST_SEED		42
+#define TEST_TOL		1e-9
+#define TEST_MAXTHREADS	4
+
+/**
+ * \brief Confere se ids segue a regra do FPS: o primeiro é o ponto mais
+ * distante do centróide e cada seguinte o mais distante dos já escolhidos (a
+ * menos de TEST_TOL, para aceitar empates resolvidos de outro jeito)
+ * \param array Pontos amostrados
+ * \param ids Pontos escolhidos, na ordem de escolha
+ * \param k Número de pontos escolhidos
+ * \return 1 se a sequência é válida, ou 0 se não
+ */
+static int test_reference(struct pointarray *array, const uint *ids, uint k)
+{
+	uint n = array->numpts;
+	real *mind = malloc(n * sizeof(real));
+	real c[3] = {0.0, 0.0, 0.0};
+
+	if (mind == NULL)
+		return 0;
+
+	for (uint i = 0; i < n; i++) {
+		c[0] += array->x[i];
+		c[1] += array->y[i];
+		c[2] += array->z[i];
+	}
+
+	for (uint i = 0; i < n; i++)
+		mind[i] = calc_squared_length3(array->x[i] - c[0] / n,
+		                               array->y[i] - c[1] / n,
+		                               array->z[i] - c[2] / n);
+
+	int ok = 1;
+
+	for (uint s = 0; s < k && ok; s++) {
+		real best = 0.0;
+
+		for (uint i = 0; i < n; i++)
+			best = mind[i] > best ? mind[i] : best;
+
+		if (ids[s] >= n || mind[ids[s]] < best * (1.0 - TEST_TOL)) {
+			fprintf(stderr, "fps: escolha %u nao e a mais distante\n", s);
+			ok = 0;
+			break;
+		}
+
+		uint last = ids[s];
+
+		if (s == 0)
+			for (uint i = 0; i < n; i++)
+				mind[i] = INFINITY;
+
+		for (uint i = 0; i < n; i++) {
+			real d = calc_squared_length3(array->x[i] - array->x[last],
+			                              array->y[i] - array->y[last],
+			                              array->z[i] - array->z[last]);
+			mind[i] = d < mind[i] ? d : mind[i];
+		}
+
+		mind[last] = -1.0;
+	}
+
+	free(mind);
+
+	return ok;
+}
+
+/**
+ * \brief Função principal: roda o FPS em cada nível SIMD e número de
+ * threads, compara com a referência e exige os mesmos ids com qualquer número
+ * de threads
+ * \return 0 se todos os casos passaram, ou 1 se algum falhou
+ */
+int main()
+{
+	struct cloud *cloud = synth_generate(SYNTH_SPHERE, TEST_NUMPTS, TEST_SEED);
+	struct pointarray *array = cloud != NULL ? cloud_pack(cloud) : NULL;
+	uint ids[TEST_K];
+	uint first[TEST_K];
+	int ok = array != NULL;
+
+	for (int level = SIMD_SCALAR; level <= SIMD_AVX512 && ok; level++) {
+		if (simd_set_level(level) != level)
+			continue;
+
+		for (uint t = 1; t <= TEST_MAXTHREADS && ok; t++) {
+			char threads[8];
+			snprintf(threads, sizeof(threads), "%u", t);
+			setenv(PARALLEL_ENV, threads, 1);
+
+			if (fps_select(array, TEST_K, ids) != TEST_K) {
+				fprintf(stderr, "fps: falhou (simd %d, %u threads)\n",
+				        level,
+				        t);
+				ok = 0;
+			} else if (t == 1) {
+				memcpy(first, ids, sizeof(ids));
+				ok = test_reference(array, ids, TEST_K);
+			} else if (memcmp(first, ids, sizeof(ids)) != 0) {
+				fprintf(stderr, "fps: ids mudam com %u threads (simd %d)\n",
+				        t,
+				        level);
+				ok = 0;
+			}
+		}
+	}
+
+	struct cloud *small = synth_generate(SYNTH_CUBE, TEST_K / 2, TEST_SEED);
+	struct pointarray *few = small != NULL ? cloud_pack(small) : NULL;
+
+	if (ok && (few == NULL || fps_select(few, TEST_K, ids) != TEST_K / 2 ||
+	           !test_reference(few, ids, TEST_K / 2))) {
+		fprintf(stderr, "fps: falhou com k maior que a nuvem\n");
+		ok = 0;
+	}
+
+	cloud_free(&small);
+	cloud_free(&cloud);
+	printf("fps: %s\n", ok ? "ok" : "FALHOU");
+
+	return ok ? 0 : 1;
+}
+
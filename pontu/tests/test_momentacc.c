@@ -0,0 +1,272 @@
+/**
+ * \file test_momentacc.c
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Confere os acumuladores de momentos: vista contra a nuvem
+ * materializada e contra o cálculo direto, e atualização incremental (inserção
+ * e remoção) contra o acúmulo em lote
+ */
+
+#include <stdint.h>
+#include "../pontu_core.h"
+#include "../pontu_features.h"
+#include "../pontu_sampling.h"
+
+#define TEST_NUMPTS	20000
+#define TEST_VIEW	5000
+#define TEST_WINDOW	2000
+#define TEST_STEPS	6000
+#define TEST_CHECK	997
+#define TEST_ORDER	3
+#define TEST_SEED	42
+#define TEST_TOL	1e-9
+
+/**
+ * \brief Compara dois vetores de momentos, com erro relativo ao maior deles
+ * \param a Momentos calculados
+ * \param b Momentos de referência
+ * \return 1 se são iguais a menos de TEST_TOL, ou 0 se não
+ */
+static int test_close(struct dataframe *a, struct dataframe *b)
+{
+	if (a == NULL || b == NULL || a->rows != b->rows || a->cols != b->cols)
+		return 0;
+
+	uint size = a->rows * a->cols;
+	real scale = 1.0;
+
+	for (uint i = 0; i < size; i++)
+		scale = fmax(scale, fabs(b->data[i]));
+
+	for (uint i = 0; i < size; i++)
+		if (!(fabs(a->data[i] - b->data[i]) <= TEST_TOL * scale))
+			return 0;
+
+	return 1;
+}
+
+/**
+ * \brief Compara os momentos centrais e os invariantes de Hu de dois
+ * acumuladores
+ * \param a Acumulador testado
+ * \param b Acumulador de referência
+ * \return 1 se são iguais a menos de TEST_TOL, ou 0 se não
+ */
+static int test_same(struct momentacc *a, struct momentacc *b)
+{
+	struct dataframe *ca = momentacc_central_moments(a);
+	struct dataframe *cb = momentacc_central_moments(b);
+	struct dataframe *ha = momentacc_hu1980(a);
+	struct dataframe *hb = momentacc_hu1980(b);
+
+	int ok = a->numpts == b->numpts && test_close(ca, cb) &&
+	         test_close(ha, hb);
+
+	dataframe_free(&ca);
+	dataframe_free(&cb);
+	dataframe_free(&ha);
+	dataframe_free(&hb);
+
+	return ok;
+}
+
+/**
+ * \brief Calcula os momentos centrais direto dos pontos, em duas passadas
+ * \param cloud Nuvem alvo
+ * \param order Ordem máxima de cada dimensão
+ * \return Matriz com os (order + 1)^3 momentos (p-major) ou NULL se falhar
+ */
+static struct dataframe *test_direct(struct cloud *cloud, int order)
+{
+	int n = order + 1;
+	struct dataframe *results = dataframe_new(1, n * n * n);
+	if (results == NULL)
+		return NULL;
+
+	real c[3] = {0.0, 0.0, 0.0};
+	uint numpts = 0;
+
+	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
+		c[0] += set->point->x;
+		c[1] += set->point->y;
+		c[2] += set->point->z;
+		numpts++;
+	}
+
+	for (int a = 0; a < 3; a++)
+		c[a] /= numpts;
+
+	for (int col = 0; col < n * n * n; col++)
+		results->data[col] = 0.0;
+
+	for (struct pointset *set = cloud->points; set != NULL; set = set->next) {
+		real dx = set->point->x - c[0];
+		real dy = set->point->y - c[1];
+		real dz = set->point->z - c[2];
+		int col = 0;
+
+		for (int p = 0; p < n; p++)
+			for (int q = 0; q < n; q++)
+				for (int r = 0; r < n; r++)
+					results->data[col++] += pow(dx, p) * pow(dy, q) *
+					                        pow(dz, r);
+	}
+
+	return results;
+}
+
+/**
+ * \brief Acumula uma vista e a nuvem materializada dela e compara os dois com
+ * o cálculo direto
+ * \param cloud Nuvem amostrada
+ * \return 1 se os momentos batem, ou 0 se não
+ */
+static int test_view(struct cloud *cloud)
+{
+	struct cloudview *view = subsample_random(cloud, TEST_VIEW, TEST_SEED);
+	struct cloud *copy = view != NULL ? cloudview_materialize(view) : NULL;
+	struct momentacc *a = momentacc_new(TEST_ORDER);
+	struct momentacc *b = momentacc_new(TEST_ORDER);
+	int ok = 0;
+
+	if (copy != NULL && a != NULL && b != NULL) {
+		momentacc_add_view(a, view);
+		momentacc_add_cloud(b, copy);
+
+		struct dataframe *direct = test_direct(copy, TEST_ORDER);
+		struct dataframe *central = momentacc_central_moments(a);
+
+		ok = a->numpts == TEST_VIEW && test_same(a, b) &&
+		     test_close(central, direct);
+
+		dataframe_free(&direct);
+		dataframe_free(&central);
+	}
+
+	momentacc_free(&a);
+	momentacc_free(&b);
+	cloud_free(&copy);
+	cloudview_free(&view);
+
+	return ok;
+}
+
+/**
+ * \brief Desliza uma janela de TEST_WINDOW pontos, inserindo e removendo um
+ * ponto por passo, e compara de tempos em tempos com a janela acumulada do
+ * zero. Depois esvazia a janela e confere que as somas zeram
+ * \param points Pontos da nuvem
+ * \return 1 se os momentos batem, ou 0 se não
+ */
+static int test_window(struct vector3 **points)
+{
+	struct momentacc *acc = momentacc_new(TEST_ORDER);
+	struct momentacc *batch = momentacc_new(TEST_ORDER);
+	int ok = acc != NULL && batch != NULL;
+
+	for (uint i = 0; i < TEST_STEPS && ok; i++) {
+		momentacc_add(acc, points[i]);
+
+		if (i >= TEST_WINDOW)
+			momentacc_remove(acc, points[i - TEST_WINDOW]);
+
+		if (i < TEST_WINDOW || i % TEST_CHECK != 0)
+			continue;
+
+		momentacc_reset(batch);
+		for (uint j = i + 1 - TEST_WINDOW; j <= i; j++)
+			momentacc_add(batch, points[j]);
+
+		ok = test_same(acc, batch);
+	}
+
+	for (uint i = TEST_STEPS - TEST_WINDOW; i < TEST_STEPS && ok; i++)
+		momentacc_remove(acc, points[i]);
+
+	for (int p = 0; p <= TEST_ORDER && ok; p++)
+		for (int q = 0; q <= TEST_ORDER; q++)
+			for (int r = 0; r <= TEST_ORDER; r++)
+				ok = ok && momentacc_raw(acc, p, q, r) == 0.0;
+
+	ok = ok && acc->numpts == 0;
+
+	momentacc_free(&acc);
+	momentacc_free(&batch);
+
+	return ok;
+}
+
+/**
+ * \brief Soma duas nuvens, retira a segunda e compara com a primeira sozinha.
+ * As duas ocupam a mesma região: a origem das somas é o primeiro ponto da
+ * segunda, e longe da primeira os momentos de ordem alta perdem dígitos
+ * \param first Nuvem que fica
+ * \param second Nuvem inserida e retirada
+ * \return 1 se os momentos batem, ou 0 se não
+ */
+static int test_remove_cloud(struct cloud *first, struct cloud *second)
+{
+	struct momentacc *acc = momentacc_new(TEST_ORDER);
+	struct momentacc *batch = momentacc_new(TEST_ORDER);
+	int ok = 0;
+
+	if (acc != NULL && batch != NULL) {
+		momentacc_add_cloud(acc, second);
+		momentacc_add_cloud(acc, first);
+		momentacc_remove_cloud(acc, second);
+		momentacc_add_cloud(batch, first);
+
+		ok = test_same(acc, batch);
+	}
+
+	momentacc_free(&acc);
+	momentacc_free(&batch);
+
+	return ok;
+}
+
+/**
+ * \brief Função principal: roda os casos em nuvens longe da origem
+ * \return 0 se todos os casos passaram, ou 1 se algum falhou
+ */
+int main()
+{
+	struct cloud *cloud = synth_generate(SYNTH_FACE, TEST_NUMPTS, TEST_SEED);
+	struct cloud *other = synth_generate(SYNTH_CUBE, TEST_VIEW, TEST_SEED);
+	struct vector3 **points = malloc(TEST_NUMPTS * sizeof(struct vector3 *));
+	struct rigid3 rt = {mat3_identity(), {50.0, -20.0, 10.0}};
+	int ok = 0;
+
+	if (cloud != NULL && other != NULL && points != NULL &&
+	    cloud->numpts == TEST_NUMPTS && cloud_transform_rigid(cloud, &rt) &&
+	    cloud_transform_rigid(other, &rt)) {
+		uint i = 0;
+		for (struct pointset *set = cloud->points; set != NULL; set = set->next)
+			points[i++] = set->point;
+
+		ok = 1;
+
+		if (!test_view(cloud)) {
+			fprintf(stderr, "momentacc: vista difere da nuvem\n");
+			ok = 0;
+		}
+
+		if (!test_window(points)) {
+			fprintf(stderr, "momentacc: janela difere do lote\n");
+			ok = 0;
+		}
+
+		if (!test_remove_cloud(cloud, other)) {
+			fprintf(stderr, "momentacc: remocao difere do lote\n");
+			ok = 0;
+		}
+	}
+
+	free(points);
+	cloud_free(&cloud);
+	cloud_free(&other);
+	printf("momentacc: %s\n", ok ? "ok" : "FALHOU");
+
+	return ok ? 0 : 1;
+}
+
@@ -0,0 +1,135 @@
+/**
+ * \file test_poisson.c
+ * \author Artur Rodrigues Rocha Neto
+ * \date 2020
+ * \brief Confere a amostragem Poisson disk contra uma varredura força bruta
+ */
+
+#include <stdint.h>
+#include "../pontu_core.h"
+#include "../pontu_sampling.h"
+
+#define TEST_NUMPTS	20000
+#define TEST_SEED	42
+
+/**
+ * \brief Caso de teste: forma da nuvem, número de pontos e raio
+ */
+struct test_case {
+	int shape;
+	uint numpts;
+	real radius;
+};
+
+/**
+ * \brief Confere por força bruta que a amostra é válida: ids crescentes, dois
+ * pontos escolhidos nunca estão a menos de radius e todo ponto descartado está
+ * a menos de radius de algum escolhido (a amostra é maximal)
+ * \param array Pontos amostrados
+ * \param view Amostra
+ * \param radius Raio da amostragem
+ * \return 1 se a amostra é válida, ou 0 se não
+ */
+static int test_brute(struct pointarray *array,
+                      struct cloudview *view,
+                      real radius)
+{
+	uint n = array->numpts;
+	char *chosen = calloc(n, sizeof(char));
+
+	if (chosen == NULL)
+		return 0;
+
+	for (uint j = 0; j < view->numids; j++) {
+		if (view->ids[j] >= n || (j > 0 && view->ids[j] <= view->ids[j - 1])) {
+			free(chosen);
+			return 0;
+		}
+
+		chosen[view->ids[j]] = 1;
+	}
+
+	int ok = 1;
+
+	for (uint i = 0; i < n && ok; i++) {
+		int covered = chosen[i];
+
+		for (uint j = 0; j < view->numids; j++) {
+			uint c = view->ids[j];
+
+			if (c == i)
+				continue;
+
+			real d = calc_squared_length3(array->x[i] - array->x[c],
+			                              array->y[i] - array->y[c],
+			                              array->z[i] - array->z[c]);
+
+			if (d < radius * radius) {
+				covered = 1;
+				ok = !chosen[i];
+				break;
+			}
+		}
+
+		ok = ok && covered;
+	}
+
+	free(chosen);
+
+	return ok;
+}
+
+/**
+ * \brief Função principal: amostra cada caso com duas sementes, confere com a
+ * força bruta e exige a mesma amostra com a mesma semente
+ * \return 0 se todos os casos passaram, ou 1 se algum falhou
+ */
+int main()
+{
+	struct test_case cases[] = {
+		{SYNTH_SPHERE, TEST_NUMPTS, 0.05},
+		{SYNTH_CLUSTERS, TEST_NUMPTS, 0.02},
+		{SYNTH_DUPLICATES, TEST_NUMPTS, 0.01},
+		{SYNTH_CUBE, TEST_NUMPTS, 2.0},
+		{SYNTH_CUBE, TEST_NUMPTS / 4, 1e-7},
+	};
+	uint numcases = sizeof(cases) / sizeof(struct test_case);
+	int ok = 1;
+
+	for (uint t = 0; t < numcases && ok; t++) {
+		struct cloud *cloud = synth_generate(cases[t].shape,
+		                                     cases[t].numpts,
+		                                     TEST_SEED);
+		struct pointarray *array = cloud != NULL ? cloud_pack(cloud) : NULL;
+
+		for (uint64_t seed = 1; seed <= 2 && ok; seed++) {
+			struct cloudview *a = NULL;
+			struct cloudview *b = NULL;
+
+			if (array != NULL) {
+				a = subsample_poisson(cloud, cases[t].radius, seed);
+				b = subsample_poisson(cloud, cases[t].radius, seed);
+			}
+
+			ok = a != NULL && b != NULL && a->numids > 0 &&
+			     a->numids == b->numids &&
+			     memcmp(a->ids, b->ids, a->numids * sizeof(uint)) == 0 &&
+			     test_brute(array, a, cases[t].radius);
+
+			if (!ok)
+				fprintf(stderr, "poisson: caso %u (semente %llu) falhou\n",
+				        t,
+				        (unsigned long long)seed);
+
+			cloudview_free(&a);
+			cloudview_free(&b);
+		}
+
+		cloud_free(&cloud);
+	}
+
+	printf("poisson: %s\n", ok ? "ok" : "FALHOU");
+
+	return ok ? 0 : 1;
+}
+
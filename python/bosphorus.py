@@ -20,6 +20,7 @@ import time
 import parse
 import shutil
 import warnings
+import struct
 import operator
 import itertools
 import subprocess
@@ -55,6 +56,9 @@ fmt = "bs{:d}_{:w}_{:w}_{:d}.xyz"
 ### CAMINHO PARA O EXECUTAVEL CALCULADOR DE MOMENTOS
 mcalc = "../pontu/bin/mcalc"
 
+### CACHE DE ATRIBUTOS DO MCALC (None desativa; ex.: "../results/.mcalc")
+mcalc_cache = None
+
 ### IGNORA WARNINGS DE CLASSIFICADORES CHATOS
 warnings.filterwarnings("ignore")
 
@@ -127,12 +131,65 @@ def cloud_extraction(cloud, moment, cut):
 	sample = str(match[3])
 	
 	cmd = [mcalc, "-m", moment, "-i", cloud, "-o", "stdout", "-c", cut]
+	if mcalc_cache is not None:
+		cmd = cmd + ["-C", mcalc_cache]
+	
 	ans = subprocess.run(cmd, stdout=subprocess.PIPE).stdout
 	ans = ans[:-1].decode("utf-8").replace(" ", ",")
 	ans = ans + ",{},{},{},{}\n".format(tp, exp, sample, subject)
 	
 	return ans
 
+class MCalcServer:
+	"""Cliente do modo servidor do mcalc (mcalc -s). Mantém um único processo
+	vivo e reaproveita as nuvens já carregadas por ele entre requisições.
+	"""
+	
+	def __init__(self, capacity=64):
+		cmd = [mcalc, "-s", "-n", str(capacity)]
+		if mcalc_cache is not None:
+			cmd = cmd + ["-C", mcalc_cache]
+		
+		self.proc = subprocess.Popen(cmd,
+		                             stdin=subprocess.PIPE,
+		                             stdout=subprocess.PIPE)
+	
+	def _read(self, size):
+		data = self.proc.stdout.read(size)
+		if len(data) != size:
+			raise IOError("mcalc -s encerrou inesperadamente")
+		return data
+	
+	def extract(self, cloud, moments, cuts):
+		"""Extrai momentos de uma nuvem para cada par (momento, corte).
+		
+		:param cloud: Nuvem alvo
+		:param moments: Lista de momentos
+		:param cuts: Lista de cortes
+		:return: Lista de vetores numpy (ordem momento-major) ou None se erro
+		"""
+		
+		req = "{} {} {}\n".format(cloud, ",".join(moments), ",".join(cuts))
+		self.proc.stdin.write(req.encode("utf-8"))
+		self.proc.stdin.flush()
+		
+		n, = struct.unpack("i", self._read(4))
+		if n < 0:
+			return None
+		
+		blocks = []
+		for i in range(n):
+			rows, cols = struct.unpack("II", self._read(8))
+			data = self._read(8 * rows * cols)
+			blocks.append(np.frombuffer(data, dtype=np.float64))
+		
+		return blocks
+	
+	def close(self):
+		self.proc.stdin.write(b"quit\n")
+		self.proc.stdin.close()
+		self.proc.wait()
+
 def batch_extraction(dataset, moment, cut, output):
 	"""Extração de momentos em uma base completa.
 	